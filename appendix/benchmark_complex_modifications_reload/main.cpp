@@ -0,0 +1,136 @@
+// Measure the latency of complex_modifications reload in CoreService.
+//
+// - full: Build all manipulators into an empty manipulator_manager. (The behavior before incremental reload.)
+// - incremental: Reload the configuration with one rule toggled and update the existing manipulator_manager.
+
+#include "complex_modifications_utility.hpp"
+#include "dispatcher_utility.hpp"
+#include "run_loop_thread_utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+constexpr int rule_count = 300;
+constexpr int manipulators_per_rule = 10;
+constexpr int round_count = 20;
+
+nlohmann::json make_complex_modifications_json(int disabled_rule_index) {
+  auto rules = nlohmann::json::array();
+
+  for (int r = 0; r < rule_count; ++r) {
+    auto manipulators = nlohmann::json::array();
+
+    for (int m = 0; m < manipulators_per_rule; ++m) {
+      manipulators.push_back(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", nlohmann::json::object({
+                       {"key_code", "a"},
+                       {"modifiers", nlohmann::json::object({{"optional", nlohmann::json::array({"any"})}})},
+                   })},
+          {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", "b"}})})},
+          {"conditions", nlohmann::json::array({
+                             nlohmann::json::object({
+                                 {"type", "variable_if"},
+                                 {"name", fmt::format("rule_{0}", r)},
+                                 {"value", m},
+                             }),
+                             nlohmann::json::object({
+                                 {"type", "expression_if"},
+                                 {"expression", fmt::format("rule_{0} + {1} > 2", r, m)},
+                             }),
+                         })},
+      }));
+    }
+
+    auto rule = nlohmann::json::object({
+        {"description", fmt::format("rule {0}", r)},
+        {"manipulators", manipulators},
+    });
+    if (r == disabled_rule_index) {
+      rule["enabled"] = false;
+    }
+
+    rules.push_back(rule);
+  }
+
+  return nlohmann::json::object({{"rules", rules}});
+}
+
+void print_latencies(const std::string& name,
+                     std::vector<double>& latencies) {
+  std::ranges::sort(latencies);
+
+  std::cout << name << std::endl;
+  std::cout << "  p50: " << latencies[latencies.size() / 2] << " ms" << std::endl;
+  std::cout << "  max: " << latencies.back() << " ms" << std::endl;
+}
+} // namespace
+
+int main() {
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+  auto scoped_run_loop_thread_manager = krbn::run_loop_thread_utility::initialize_scoped_run_loop_thread_manager(
+      pqrs::cf::run_loop_thread::failure_policy::abort);
+
+  std::cout << "manipulators: " << rule_count * manipulators_per_rule << std::endl;
+  std::cout << "rounds: " << round_count << std::endl;
+
+  std::vector<std::shared_ptr<krbn::core_configuration::details::complex_modifications>> configurations;
+  for (int i = 0; i < round_count; ++i) {
+    // Toggle a rule on each reload.
+    configurations.push_back(std::make_shared<krbn::core_configuration::details::complex_modifications>(
+        make_complex_modifications_json(i % 2 == 0 ? -1 : i),
+        krbn::core_configuration::error_handling::strict));
+  }
+
+  //
+  // full
+  //
+
+  {
+    std::vector<double> latencies;
+
+    for (const auto& c : configurations) {
+      auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+
+      auto begin = std::chrono::steady_clock::now();
+
+      krbn::complex_modifications_utility::update_manipulators(*manager, *c);
+
+      auto end = std::chrono::steady_clock::now();
+      latencies.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+
+      manager->invalidate_manipulators();
+    }
+
+    print_latencies("full", latencies);
+  }
+
+  //
+  // incremental
+  //
+
+  {
+    std::vector<double> latencies;
+    size_t reused_count = 0;
+
+    auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+    krbn::complex_modifications_utility::update_manipulators(*manager, *(configurations.back()));
+
+    for (const auto& c : configurations) {
+      auto begin = std::chrono::steady_clock::now();
+
+      reused_count = krbn::complex_modifications_utility::update_manipulators(*manager, *c);
+
+      auto end = std::chrono::steady_clock::now();
+      latencies.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+
+    print_latencies("incremental", latencies);
+    std::cout << "  reused (last round): " << reused_count << std::endl;
+
+    manager->invalidate_manipulators();
+  }
+
+  return 0;
+}
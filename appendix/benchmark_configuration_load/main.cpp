@@ -0,0 +1,123 @@
+// Measure the latency of loading a profile which has many `eval_js` rules.
+//
+// - serial: Create rules one by one. (The behavior before parallel `eval_js` evaluation.)
+// - parallel: Create complex_modifications, which evaluates `eval_js` on worker threads.
+
+#include "core_configuration/core_configuration.hpp"
+#include "dispatcher_utility.hpp"
+#include "parallel_utility.hpp"
+#include "run_loop_thread_utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+constexpr int rule_count = 200;
+constexpr int manipulators_per_rule = 20;
+constexpr int round_count = 5;
+
+nlohmann::json make_complex_modifications_json() {
+  auto rules = nlohmann::json::array();
+
+  for (int r = 0; r < rule_count; ++r) {
+    rules.push_back(nlohmann::json::object({
+        {"eval_js", fmt::format(R"(
+function main() {{
+  const keys = "abcdefghijklmnopqrstuvwxyz".split("");
+  const manipulators = [];
+
+  for (let i = 0; i < {1}; ++i) {{
+    manipulators.push({{
+      type: "basic",
+      from: {{ key_code: keys[i % keys.length], modifiers: {{ mandatory: ["left_control"] }} }},
+      to: [{{ key_code: keys[(i + {0}) % keys.length] }}],
+      conditions: [{{ type: "variable_if", name: "rule_{0}", value: i }}],
+    }});
+  }}
+
+  return {{
+    description: "rule {0}",
+    manipulators: manipulators,
+  }};
+}}
+
+main();
+)",
+                                r,
+                                manipulators_per_rule)},
+    }));
+  }
+
+  return nlohmann::json::object({{"rules", rules}});
+}
+
+void print_latencies(const std::string& name,
+                     std::vector<double>& latencies) {
+  std::ranges::sort(latencies);
+
+  std::cout << name << std::endl;
+  std::cout << "  p50: " << latencies[latencies.size() / 2] << " ms" << std::endl;
+  std::cout << "  max: " << latencies.back() << " ms" << std::endl;
+}
+} // namespace
+
+int main() {
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+  auto scoped_run_loop_thread_manager = krbn::run_loop_thread_utility::initialize_scoped_run_loop_thread_manager(
+      pqrs::cf::run_loop_thread::failure_policy::abort);
+
+  auto json = make_complex_modifications_json();
+
+  std::cout << "eval_js rules: " << rule_count << std::endl;
+  std::cout << "rounds: " << round_count << std::endl;
+  std::cout << "workers: " << krbn::parallel_utility::get_worker_count(rule_count) << std::endl;
+
+  //
+  // serial
+  //
+
+  {
+    std::vector<double> latencies;
+
+    for (int i = 0; i < round_count; ++i) {
+      auto begin = std::chrono::steady_clock::now();
+
+      auto parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>();
+      std::vector<std::shared_ptr<krbn::core_configuration::details::complex_modifications_rule>> rules;
+      for (const auto& j : json["rules"]) {
+        rules.push_back(std::make_shared<krbn::core_configuration::details::complex_modifications_rule>(
+            j,
+            parameters,
+            krbn::core_configuration::error_handling::strict));
+      }
+
+      auto end = std::chrono::steady_clock::now();
+      latencies.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+
+    print_latencies("serial", latencies);
+  }
+
+  //
+  // parallel
+  //
+
+  {
+    std::vector<double> latencies;
+
+    for (int i = 0; i < round_count; ++i) {
+      auto begin = std::chrono::steady_clock::now();
+
+      krbn::core_configuration::details::complex_modifications complex_modifications(
+          json,
+          krbn::core_configuration::error_handling::strict);
+
+      auto end = std::chrono::steady_clock::now();
+      latencies.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+
+    print_latencies("parallel", latencies);
+  }
+
+  return 0;
+}
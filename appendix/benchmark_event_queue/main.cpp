@@ -0,0 +1,79 @@
+#include "dispatcher_utility.hpp"
+#include "manipulator/manipulator_managers_connector.hpp"
+#include "run_loop_thread_utility.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+constexpr int stage_count = 4;
+constexpr int entry_count = 10000;
+
+void run() {
+  std::vector<pqrs::not_null_shared_ptr_t<krbn::event_queue::queue>> event_queues;
+  for (int i = 0; i < stage_count + 1; ++i) {
+    event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+  }
+
+  auto parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>();
+
+  krbn::manipulator::manipulator_managers_connector connector;
+  std::vector<pqrs::not_null_shared_ptr_t<krbn::manipulator::manipulator_manager>> manipulator_managers;
+  for (int i = 0; i < stage_count; ++i) {
+    auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+
+    // Manipulators that do not match the input events.
+    for (int j = 0; j < 10; ++j) {
+      manager->push_back_manipulator(nlohmann::json::object({
+                                         {"type", "basic"},
+                                         {"from", nlohmann::json::object({{"key_code", "b"}})},
+                                         {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", "c"}})})},
+                                     }),
+                                     parameters);
+    }
+
+    connector.emplace_back_connection(pqrs::make_weak(manager),
+                                      pqrs::make_weak(event_queues[i]),
+                                      pqrs::make_weak(event_queues[i + 1]));
+    manipulator_managers.push_back(manager);
+  }
+
+  krbn::event_queue::event a_event(krbn::momentary_switch_event(pqrs::hid::usage_page::keyboard_or_keypad,
+                                                                pqrs::hid::usage::keyboard_or_keypad::keyboard_a));
+  for (int i = 0; i < entry_count; ++i) {
+    auto event_type = (i % 2 == 0 ? krbn::event_type::key_down : krbn::event_type::key_up);
+    event_queues.front()->emplace_back_entry(krbn::device_id(1),
+                                             krbn::event_queue::event_time_stamp(krbn::absolute_time_point(i)),
+                                             a_event,
+                                             event_type,
+                                             krbn::event_integer_value::value_t(i % 2 == 0 ? 1 : 0),
+                                             a_event,
+                                             krbn::event_queue::state::original);
+  }
+
+  auto core_configuration = std::make_shared<krbn::core_configuration::core_configuration>();
+
+  auto begin = std::chrono::steady_clock::now();
+
+  connector.manipulate(krbn::absolute_time_point(entry_count), core_configuration);
+
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << "stages: " << stage_count << std::endl;
+  std::cout << "entries: " << entry_count << std::endl;
+  std::cout << "output entries: " << event_queues.back()->get_entries().size() << std::endl;
+  std::cout << "elapsed: " << std::chrono::duration<double, std::milli>(end - begin).count() << " ms" << std::endl;
+  std::cout << "per entry: " << std::chrono::duration<double, std::micro>(end - begin).count() / entry_count << " us" << std::endl;
+
+  connector.invalidate_manipulators();
+}
+} // namespace
+
+int main() {
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+  auto scoped_run_loop_thread_manager = krbn::run_loop_thread_utility::initialize_scoped_run_loop_thread_manager(
+      pqrs::cf::run_loop_thread::failure_policy::abort);
+
+  run();
+
+  return 0;
+}
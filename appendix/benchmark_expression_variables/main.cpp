@@ -0,0 +1,97 @@
+#include "manipulator/conditions/expression.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+constexpr int expression_count = 300;
+constexpr int keystroke_count = 1000;
+
+std::vector<std::shared_ptr<krbn::manipulator::conditions::expression>> make_conditions(int variable_count) {
+  std::vector<std::shared_ptr<krbn::manipulator::conditions::expression>> conditions;
+
+  for (int i = 0; i < expression_count; ++i) {
+    auto json = nlohmann::json::object({
+        {"type", "expression_if"},
+        {"expression", fmt::format("variable{0} == 1 and system.now.milliseconds > 0", i % variable_count)},
+    });
+    conditions.push_back(std::make_shared<krbn::manipulator::conditions::expression>(json));
+  }
+
+  return conditions;
+}
+
+// The previous behavior: every variable is written to every expression by name on each keystroke.
+void apply_all_variables(const krbn::manipulator::manipulator_environment& manipulator_environment,
+                         const std::vector<std::shared_ptr<krbn::manipulator::conditions::expression>>& conditions) {
+  auto names = manipulator_environment.get_variable_names();
+
+  for (const auto& c : conditions) {
+    for (const auto& name : names) {
+      auto value = manipulator_environment.get_variable(name);
+      if (auto v = value.get_if<int64_t>()) {
+        c->get_expression()->set_variable(name, static_cast<double>(*v));
+      }
+    }
+  }
+}
+
+template <typename T>
+double measure(int variable_count, T apply) {
+  krbn::manipulator::conditions::condition_context condition_context{
+      .device_id = krbn::device_id(1),
+      .state = krbn::event_queue::state::original,
+  };
+  krbn::manipulator::manipulator_environment manipulator_environment;
+
+  for (int i = 0; i < variable_count; ++i) {
+    manipulator_environment.set_variable(fmt::format("variable{0}", i),
+                                         krbn::manipulator_environment_variable_value(0));
+  }
+
+  auto conditions = make_conditions(variable_count);
+  int fulfilled_count = 0;
+
+  auto begin = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < keystroke_count; ++k) {
+    // A keystroke changes one variable and system.now.milliseconds.
+    manipulator_environment.set_variable(fmt::format("variable{0}", k % variable_count),
+                                         krbn::manipulator_environment_variable_value(k % 2));
+    manipulator_environment.set_variable_system_now_milliseconds();
+
+    apply(manipulator_environment, conditions);
+
+    for (const auto& c : conditions) {
+      if (c->is_fulfilled(condition_context, manipulator_environment)) {
+        ++fulfilled_count;
+      }
+    }
+  }
+
+  auto end = std::chrono::steady_clock::now();
+
+  if (fulfilled_count < 0) {
+    std::cout << fulfilled_count << std::endl;
+  }
+
+  return std::chrono::duration<double, std::micro>(end - begin).count() / keystroke_count;
+}
+} // namespace
+
+int main() {
+  std::cout << "expressions: " << expression_count << std::endl;
+  std::cout << "keystrokes: " << keystroke_count << std::endl;
+  std::cout << std::endl;
+  std::cout << "variables\tall variables (us/keystroke)\tchanged variables (us/keystroke)" << std::endl;
+
+  for (auto variable_count : {10, 100, 300, 1000}) {
+    auto all = measure(variable_count, apply_all_variables);
+    auto changed = measure(variable_count, [](auto&&, auto&&) {});
+
+    std::cout << variable_count << "\t"
+              << all << "\t"
+              << changed << std::endl;
+  }
+
+  return 0;
+}
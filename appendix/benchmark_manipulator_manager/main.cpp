@@ -0,0 +1,111 @@
+#include "dispatcher_utility.hpp"
+#include "manipulator/manipulator_managers_connector.hpp"
+#include "run_loop_thread_utility.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace {
+constexpr int manipulator_count = 2000;
+constexpr int entry_count = 10000;
+
+void print_latencies(const std::string& name,
+                     std::vector<double>& latencies) {
+  std::ranges::sort(latencies);
+
+  std::cout << name << std::endl;
+  std::cout << "  p50: " << latencies[latencies.size() / 2] << " us" << std::endl;
+  std::cout << "  p99: " << latencies[latencies.size() * 99 / 100] << " us" << std::endl;
+  std::cout << "  max: " << latencies.back() << " us" << std::endl;
+}
+
+void run(bool contention) {
+  auto input_event_queue = std::make_shared<krbn::event_queue::queue>();
+  auto output_event_queue = std::make_shared<krbn::event_queue::queue>();
+
+  auto parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>();
+
+  auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+  for (int i = 0; i < manipulator_count; ++i) {
+    manager->push_back_manipulator(nlohmann::json::object({
+                                       {"type", "basic"},
+                                       {"from", nlohmann::json::object({{"key_code", "b"}})},
+                                       {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", "c"}})})},
+                                   }),
+                                   parameters);
+  }
+
+  krbn::manipulator::manipulator_managers_connector connector;
+  connector.emplace_back_connection(pqrs::make_weak(manager),
+                                    pqrs::make_weak(input_event_queue),
+                                    pqrs::make_weak(output_event_queue));
+
+  auto core_configuration = std::make_shared<krbn::core_configuration::core_configuration>();
+
+  // Other threads access manipulator_manager while events are manipulated.
+  std::atomic<bool> exit(false);
+  std::vector<std::thread> threads;
+  if (contention) {
+    for (int i = 0; i < 2; ++i) {
+      threads.emplace_back([&] {
+        while (!exit) {
+          connector.needs_virtual_hid_pointing();
+          manager->get_manipulators_size();
+        }
+      });
+    }
+  }
+
+  krbn::event_queue::event a_event(krbn::momentary_switch_event(pqrs::hid::usage_page::keyboard_or_keypad,
+                                                                pqrs::hid::usage::keyboard_or_keypad::keyboard_a));
+  std::vector<double> latencies;
+  latencies.reserve(entry_count);
+
+  for (int i = 0; i < entry_count; ++i) {
+    auto event_type = (i % 2 == 0 ? krbn::event_type::key_down : krbn::event_type::key_up);
+    input_event_queue->emplace_back_entry(krbn::device_id(1),
+                                          krbn::event_queue::event_time_stamp(krbn::absolute_time_point(i)),
+                                          a_event,
+                                          event_type,
+                                          krbn::event_integer_value::value_t(i % 2 == 0 ? 1 : 0),
+                                          a_event,
+                                          krbn::event_queue::state::original);
+
+    auto begin = std::chrono::steady_clock::now();
+
+    connector.manipulate(krbn::absolute_time_point(i), core_configuration);
+
+    auto end = std::chrono::steady_clock::now();
+
+    latencies.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+
+    output_event_queue->clear_events();
+  }
+
+  exit = true;
+  for (auto&& t : threads) {
+    t.join();
+  }
+
+  print_latencies(contention ? "with contention" : "without contention",
+                  latencies);
+
+  connector.invalidate_manipulators();
+}
+} // namespace
+
+int main() {
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+  auto scoped_run_loop_thread_manager = krbn::run_loop_thread_utility::initialize_scoped_run_loop_thread_manager(
+      pqrs::cf::run_loop_thread::failure_policy::abort);
+
+  std::cout << "manipulators: " << manipulator_count << std::endl;
+  std::cout << "entries: " << entry_count << std::endl;
+
+  run(false);
+  run(true);
+
+  return 0;
+}
@@ -0,0 +1,306 @@
+// Replay a recorded event trace through the manipulation pipeline at full speed.
+//
+// Usage:
+//   a.out karabiner.json trace.json [repeat]
+//   a.out karabiner.json trace.json --write-binary trace.bin
+//   a.out karabiner.json trace.bin [repeat]
+//
+// The trace is an array of event_queue::entry json (the same format as input_event_queue in tests),
+// or the compact binary format which is written by --write-binary.
+// The binary format contains only momentary_switch_event entries.
+//
+// The dispatcher time source is replaced with pqrs::dispatcher::pseudo_time_source and is not advanced during replay,
+// so time-based actions (e.g., to_if_held_down, to_delayed_action.to_if_invoked) are never invoked and the result is deterministic.
+
+#include "../../src/apps/CoreService/include/core_service/daemon/device_grabber_details/device_key_code_manipulator_manager.hpp"
+#include "../../src/apps/CoreService/include/core_service/daemon/device_grabber_details/fn_function_keys_manipulator_manager.hpp"
+#include "../../src/apps/CoreService/include/core_service/daemon/device_grabber_details/simple_modifications_manipulator_manager.hpp"
+#include "allocation_counter.hpp"
+#include "dispatcher_utility.hpp"
+#include "json_utility.hpp"
+#include "manipulator/condition_factory.hpp"
+#include "manipulator/manipulator_factory.hpp"
+#include "manipulator/manipulators/post_event_to_virtual_devices/post_event_to_virtual_devices.hpp"
+#include "run_loop_thread_utility.hpp"
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+constexpr std::array<char, 8> binary_trace_magic{'K', 'R', 'B', 'N', 'T', 'R', 'C', '1'};
+
+struct binary_trace_record final {
+  uint64_t time_stamp;
+  uint64_t device_id;
+  int32_t usage_page;
+  int32_t usage;
+  uint32_t event_type;
+  uint32_t reserved;
+};
+
+std::vector<krbn::event_queue::entry> read_binary_trace(std::ifstream& ifs) {
+  std::vector<krbn::event_queue::entry> entries;
+
+  binary_trace_record record;
+  while (ifs.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    krbn::event_queue::event e(krbn::momentary_switch_event(pqrs::hid::usage_page::value_t(record.usage_page),
+                                                            pqrs::hid::usage::value_t(record.usage)));
+    auto et = static_cast<krbn::event_type>(record.event_type);
+
+    entries.emplace_back(krbn::device_id(record.device_id),
+                         krbn::event_queue::event_time_stamp(krbn::absolute_time_point(record.time_stamp)),
+                         e,
+                         et,
+                         krbn::event_integer_value::value_t(et == krbn::event_type::key_down ? 1 : 0),
+                         e,
+                         krbn::event_queue::state::original);
+  }
+
+  return entries;
+}
+
+std::vector<krbn::event_queue::entry> read_trace(const std::string& file_path) {
+  std::ifstream ifs(file_path, std::ios::binary);
+  if (!ifs) {
+    throw std::runtime_error(fmt::format("failed to open {0}", file_path));
+  }
+
+  std::array<char, 8> magic{};
+  if (ifs.read(magic.data(), magic.size()) && magic == binary_trace_magic) {
+    return read_binary_trace(ifs);
+  }
+
+  ifs.clear();
+  ifs.seekg(0);
+
+  std::vector<krbn::event_queue::entry> entries;
+  for (const auto& j : krbn::json_utility::parse_jsonc(ifs)) {
+    entries.push_back(krbn::event_queue::entry::make_from_json(j));
+  }
+  return entries;
+}
+
+void write_binary_trace(const std::vector<krbn::event_queue::entry>& entries,
+                        const std::string& file_path) {
+  std::ofstream ofs(file_path, std::ios::binary);
+  if (!ofs) {
+    throw std::runtime_error(fmt::format("failed to open {0}", file_path));
+  }
+
+  ofs.write(binary_trace_magic.data(), binary_trace_magic.size());
+
+  size_t count = 0;
+  for (const auto& e : entries) {
+    if (auto mse = e.get_event().get_if<krbn::momentary_switch_event>()) {
+      binary_trace_record record{
+          .time_stamp = static_cast<uint64_t>(type_safe::get(e.get_event_time_stamp().get_time_stamp())),
+          .device_id = type_safe::get(e.get_device_id()),
+          .usage_page = type_safe::get(mse->get_usage_pair().get_usage_page()),
+          .usage = type_safe::get(mse->get_usage_pair().get_usage()),
+          .event_type = static_cast<uint32_t>(e.get_event_type()),
+          .reserved = 0,
+      };
+      ofs.write(reinterpret_cast<const char*>(&record), sizeof(record));
+      ++count;
+    }
+  }
+
+  std::cout << "wrote " << count << " entries to " << file_path << std::endl;
+}
+
+class pipeline final {
+public:
+  struct stage final {
+    std::string name;
+    std::shared_ptr<krbn::manipulator::manipulator_manager> manipulator_manager;
+    std::chrono::nanoseconds elapsed;
+  };
+
+  explicit pipeline(pqrs::not_null_shared_ptr_t<const krbn::core_configuration::core_configuration> core_configuration)
+      : core_configuration_(core_configuration),
+        device_key_code_manipulator_manager_(std::make_shared<krbn::core_service::daemon::device_grabber_details::device_key_code_manipulator_manager>()),
+        simple_modifications_manipulator_manager_(std::make_shared<krbn::core_service::daemon::device_grabber_details::simple_modifications_manipulator_manager>()),
+        complex_modifications_manipulator_manager_(std::make_shared<krbn::manipulator::manipulator_manager>()),
+        fn_function_keys_manipulator_manager_(std::make_shared<krbn::core_service::daemon::device_grabber_details::fn_function_keys_manipulator_manager>()),
+        post_event_to_virtual_devices_manipulator_manager_(std::make_shared<krbn::manipulator::manipulator_manager>()),
+        post_event_to_virtual_devices_manipulator_(std::make_shared<krbn::manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices>(
+            std::weak_ptr<krbn::console_user_server_peer>(),
+            std::weak_ptr<krbn::notification_message_manager>())) {
+    const auto& profile = core_configuration_->get_selected_profile();
+
+    device_key_code_manipulator_manager_->update(profile);
+    simple_modifications_manipulator_manager_->update(profile);
+    fn_function_keys_manipulator_manager_->update(profile,
+                                                  pqrs::osx::system_preferences::properties());
+
+    for (const auto& rule : profile.get_complex_modifications()->get_rules()) {
+      if (!rule->get_enabled()) {
+        continue;
+      }
+
+      for (const auto& manipulator : rule->get_manipulators()) {
+        auto m = krbn::manipulator::manipulator_factory::make_manipulator(manipulator->to_json(),
+                                                                          manipulator->get_parameters());
+        for (const auto& c : manipulator->get_conditions()) {
+          m->push_back_condition(krbn::manipulator::condition_factory::make_condition(c.get_json()));
+        }
+        complex_modifications_manipulator_manager_->push_back_manipulator(m);
+      }
+    }
+
+    post_event_to_virtual_devices_manipulator_manager_->push_back_manipulator(post_event_to_virtual_devices_manipulator_);
+
+    stages_.push_back({"device_key_code", device_key_code_manipulator_manager_->get_manipulator_manager(), {}});
+    stages_.push_back({"simple_modifications", simple_modifications_manipulator_manager_->get_manipulator_manager(), {}});
+    stages_.push_back({"complex_modifications", complex_modifications_manipulator_manager_, {}});
+    stages_.push_back({"fn_function_keys", fn_function_keys_manipulator_manager_->get_manipulator_manager(), {}});
+    stages_.push_back({"post_event_to_virtual_devices", post_event_to_virtual_devices_manipulator_manager_, {}});
+
+    for (size_t i = 0; i < stages_.size() + 1; ++i) {
+      event_queues_.push_back(std::make_shared<krbn::event_queue::queue>());
+    }
+  }
+
+  ~pipeline() {
+    for (auto&& s : stages_) {
+      s.manipulator_manager->invalidate_manipulators();
+    }
+  }
+
+  const std::vector<stage>& get_stages() const {
+    return stages_;
+  }
+
+  void manipulate(const krbn::event_queue::entry& entry) {
+    auto now = entry.get_event_time_stamp().get_time_stamp();
+
+    event_queues_.front()->push_back_entry(entry);
+
+    for (size_t i = 0; i < stages_.size(); ++i) {
+      auto begin = std::chrono::steady_clock::now();
+
+      while (stages_[i].manipulator_manager->manipulate(event_queues_[i],
+                                                        event_queues_[i + 1],
+                                                        now,
+                                                        core_configuration_)) {
+      }
+
+      stages_[i].elapsed += std::chrono::steady_clock::now() - begin;
+    }
+
+    posted_count_ += post_event_to_virtual_devices_manipulator_->get_queue().get_events().size();
+
+    // Drop posted events as device_grabber does after `async_post_events`.
+    event_queues_.back()->clear_events();
+    post_event_to_virtual_devices_manipulator_->clear_queue();
+  }
+
+  size_t get_posted_count() const {
+    return posted_count_;
+  }
+
+private:
+  pqrs::not_null_shared_ptr_t<const krbn::core_configuration::core_configuration> core_configuration_;
+  std::shared_ptr<krbn::core_service::daemon::device_grabber_details::device_key_code_manipulator_manager> device_key_code_manipulator_manager_;
+  std::shared_ptr<krbn::core_service::daemon::device_grabber_details::simple_modifications_manipulator_manager> simple_modifications_manipulator_manager_;
+  std::shared_ptr<krbn::manipulator::manipulator_manager> complex_modifications_manipulator_manager_;
+  std::shared_ptr<krbn::core_service::daemon::device_grabber_details::fn_function_keys_manipulator_manager> fn_function_keys_manipulator_manager_;
+  std::shared_ptr<krbn::manipulator::manipulator_manager> post_event_to_virtual_devices_manipulator_manager_;
+  std::shared_ptr<krbn::manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices> post_event_to_virtual_devices_manipulator_;
+  std::vector<stage> stages_;
+  std::vector<pqrs::not_null_shared_ptr_t<krbn::event_queue::queue>> event_queues_;
+  size_t posted_count_ = 0;
+};
+
+void run(const std::string& configuration_file_path,
+         const std::string& trace_file_path,
+         int repeat) {
+  auto core_configuration = std::make_shared<krbn::core_configuration::core_configuration>(configuration_file_path,
+                                                                                           geteuid(),
+                                                                                           krbn::core_configuration::error_handling::loose);
+  auto trace = read_trace(trace_file_path);
+  if (trace.empty()) {
+    throw std::runtime_error("trace is empty");
+  }
+
+  // Shift time stamps on each repetition to keep them monotonic.
+  std::vector<krbn::event_queue::entry> entries;
+  entries.reserve(trace.size() * repeat);
+  auto trace_duration = trace.back().get_event_time_stamp().get_time_stamp() -
+                        trace.front().get_event_time_stamp().get_time_stamp() +
+                        pqrs::osx::chrono::make_absolute_time_duration(std::chrono::seconds(1));
+  for (int r = 0; r < repeat; ++r) {
+    for (const auto& e : trace) {
+      auto& entry = entries.emplace_back(e);
+      entry.get_event_time_stamp().set_time_stamp(e.get_event_time_stamp().get_time_stamp() +
+                                                  krbn::absolute_time_duration(type_safe::get(trace_duration) * r));
+    }
+  }
+
+  pipeline p(core_configuration);
+
+  auto allocation_count_begin = krbn::allocation_counter::get_count();
+  auto begin = std::chrono::steady_clock::now();
+
+  for (const auto& e : entries) {
+    p.manipulate(e);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  auto allocations = krbn::allocation_counter::get_count() - allocation_count_begin;
+
+  auto elapsed = std::chrono::duration<double>(end - begin).count();
+
+  std::cout << "events: " << entries.size() << std::endl;
+  std::cout << "posted events: " << p.get_posted_count() << std::endl;
+  std::cout << "elapsed: " << elapsed * 1000 << " ms" << std::endl;
+  std::cout << "events/sec: " << static_cast<double>(entries.size()) / elapsed << std::endl;
+  std::cout << "allocations/event: " << static_cast<double>(allocations) / static_cast<double>(entries.size()) << std::endl;
+  std::cout << "stages:" << std::endl;
+  for (const auto& s : p.get_stages()) {
+    std::cout << "  " << s.name << ": "
+              << std::chrono::duration<double, std::milli>(s.elapsed).count() << " ms ("
+              << std::chrono::duration<double, std::nano>(s.elapsed).count() / static_cast<double>(entries.size()) << " ns/event)"
+              << std::endl;
+  }
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " karabiner.json trace.json [repeat]" << std::endl;
+    std::cerr << "       " << argv[0] << " karabiner.json trace.json --write-binary trace.bin" << std::endl;
+    return 1;
+  }
+
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+  auto scoped_run_loop_thread_manager = krbn::run_loop_thread_utility::initialize_scoped_run_loop_thread_manager(
+      pqrs::cf::run_loop_thread::failure_policy::abort);
+
+  auto pseudo_time_source = std::make_shared<pqrs::dispatcher::pseudo_time_source>();
+  auto dispatcher = pqrs::dispatcher::extra::get_shared_dispatcher();
+  auto original_weak_time_source = dispatcher->lock_weak_time_source();
+  dispatcher->set_weak_time_source(pqrs::make_weak(pseudo_time_source));
+
+  int exit_code = 0;
+
+  try {
+    if (argc >= 5 && std::string_view(argv[3]) == "--write-binary") {
+      write_binary_trace(read_trace(argv[2]), argv[4]);
+    } else {
+      run(argv[1],
+          argv[2],
+          argc >= 4 ? std::max(std::stoi(argv[3]), 1) : 100);
+    }
+  } catch (std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    exit_code = 1;
+  }
+
+  dispatcher->set_weak_time_source(original_weak_time_source);
+
+  return exit_code;
+}
@@ -0,0 +1,139 @@
+// Compare the latency of shell_command with `/bin/sh -c` for each command and with krbn::shell_command_worker.
+//
+// The latency is measured from the request to the completion of the command (including reading the output).
+
+#include "dispatcher_utility.hpp"
+#include "shell_command_worker.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <pqrs/process.hpp>
+#include <pqrs/thread_wait.hpp>
+
+namespace {
+constexpr int iteration_count = 200;
+const std::string command = "echo hello";
+
+class runner final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  runner() : dispatcher_client(),
+             worker_(std::make_unique<krbn::shell_command_worker>(weak_dispatcher_)) {
+    worker_->command_finished.connect([this](auto, auto) {
+      if (wait_) {
+        wait_->notify();
+      }
+    });
+  }
+
+  ~runner() override {
+    detach_from_dispatcher([this] {
+      process_ = nullptr;
+      worker_ = nullptr;
+    });
+  }
+
+  void start_worker() {
+    auto wait = pqrs::make_thread_wait();
+    enqueue_to_dispatcher([this, wait] {
+      if (!worker_->start()) {
+        std::cerr << "failed to start the worker" << std::endl;
+      }
+      wait->notify();
+    });
+    wait->wait_notice();
+  }
+
+  std::chrono::nanoseconds run_process() {
+    auto wait = pqrs::make_thread_wait();
+    auto begin = std::chrono::steady_clock::now();
+
+    enqueue_to_dispatcher([this, wait] {
+      process_ = std::make_unique<pqrs::process::process>(weak_dispatcher_,
+                                                          std::vector<std::string>{
+                                                              "/bin/sh",
+                                                              "-c",
+                                                              command});
+      process_->exited.connect([wait](auto&&) {
+        wait->notify();
+      });
+      process_->run();
+    });
+    wait->wait_notice();
+
+    return std::chrono::steady_clock::now() - begin;
+  }
+
+  std::chrono::nanoseconds run_worker(uint64_t command_id) {
+    auto wait = pqrs::make_thread_wait();
+    auto begin = std::chrono::steady_clock::now();
+
+    enqueue_to_dispatcher([this, wait, command_id] {
+      wait_ = wait;
+      if (!worker_->run(command_id, command)) {
+        std::cerr << "failed to run the command in the worker" << std::endl;
+        wait->notify();
+      }
+    });
+    wait->wait_notice();
+
+    return std::chrono::steady_clock::now() - begin;
+  }
+
+private:
+  std::unique_ptr<pqrs::process::process> process_;
+  std::unique_ptr<krbn::shell_command_worker> worker_;
+  std::shared_ptr<pqrs::thread_wait> wait_;
+};
+
+void print(const std::string& name, std::vector<std::chrono::nanoseconds>& durations) {
+  std::sort(std::begin(durations), std::end(durations));
+
+  std::chrono::nanoseconds total(0);
+  for (const auto& d : durations) {
+    total += d;
+  }
+
+  auto to_us = [](auto d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+
+  std::cout << name << std::endl;
+  std::cout << "  mean: " << to_us(total) / durations.size() << " us" << std::endl;
+  std::cout << "  median: " << to_us(durations[durations.size() / 2]) << " us" << std::endl;
+  std::cout << "  p99: " << to_us(durations[durations.size() * 99 / 100]) << " us" << std::endl;
+  std::cout << "  max: " << to_us(durations.back()) << " us" << std::endl;
+}
+} // namespace
+
+int main() {
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+
+  std::cout << "command: " << command << std::endl;
+  std::cout << "iterations: " << iteration_count << std::endl;
+
+  {
+    runner r;
+
+    std::vector<std::chrono::nanoseconds> durations;
+    for (int i = 0; i < iteration_count; ++i) {
+      durations.push_back(r.run_process());
+    }
+    print("/bin/sh -c for each command", durations);
+  }
+
+  {
+    runner r;
+    r.start_worker();
+
+    // Warm up (wait until the worker is ready).
+    r.run_worker(0);
+
+    std::vector<std::chrono::nanoseconds> durations;
+    for (int i = 0; i < iteration_count; ++i) {
+      durations.push_back(r.run_worker(i + 1));
+    }
+    print("krbn::shell_command_worker", durations);
+  }
+
+  return 0;
+}
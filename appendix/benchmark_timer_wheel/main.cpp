@@ -0,0 +1,111 @@
+// Compare pqrs::dispatcher::extra::debounced_task and krbn::debounced_task (krbn::timer_wheel).
+//
+// Each client cancels and re-arms its task repeatedly like to_if_held_down does on every key_down.
+// The dispatcher time source is replaced with pqrs::dispatcher::pseudo_time_source and is not advanced,
+// so no task is invoked and canceled schedules stay in the dispatcher queue.
+
+#include "allocation_counter.hpp"
+#include "debounced_task.hpp"
+#include "dispatcher_utility.hpp"
+#include <chrono>
+#include <iostream>
+#include <pqrs/thread_wait.hpp>
+
+namespace {
+constexpr int client_count = 1000;
+constexpr int round_count = 20;
+
+template <typename T>
+class client final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  client() : dispatcher_client(),
+             task_(*this),
+             count_(0) {
+  }
+
+  ~client() override {
+    detach_from_dispatcher();
+  }
+
+  void rearm(int delay) {
+    task_.cancel();
+    task_.debounce_after(
+        [this] {
+          ++count_;
+        },
+        std::chrono::milliseconds(delay));
+  }
+
+private:
+  T task_;
+  int count_;
+};
+
+void wait_dispatcher(pqrs::dispatcher::extra::dispatcher_client& dispatcher_client) {
+  auto wait = pqrs::make_thread_wait();
+  dispatcher_client.enqueue_to_dispatcher([wait] {
+    wait->notify();
+  });
+  wait->wait_notice();
+}
+
+template <typename T>
+void run(const std::string& name) {
+  std::vector<std::unique_ptr<client<T>>> clients;
+  for (int i = 0; i < client_count; ++i) {
+    clients.push_back(std::make_unique<client<T>>());
+  }
+
+  pqrs::dispatcher::extra::dispatcher_client waiter;
+
+  auto allocation_count_begin = krbn::allocation_counter::get_count();
+  auto begin = std::chrono::steady_clock::now();
+
+  for (int r = 0; r < round_count; ++r) {
+    for (int i = 0; i < client_count; ++i) {
+      clients[i]->rearm(1000 + (i * 7 + r * 13) % 100);
+    }
+
+    // Wait until asynchronous cancel and debounce are processed.
+    wait_dispatcher(waiter);
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  auto allocations = krbn::allocation_counter::get_count() - allocation_count_begin;
+
+  auto operations = static_cast<double>(client_count) * round_count;
+
+  std::cout << name << std::endl;
+  std::cout << "  elapsed: " << std::chrono::duration<double, std::milli>(end - begin).count() << " ms" << std::endl;
+  std::cout << "  ns/re-arm: " << std::chrono::duration<double, std::nano>(end - begin).count() / operations << std::endl;
+  std::cout << "  allocations/re-arm: " << static_cast<double>(allocations) / operations << std::endl;
+
+  // Release clients (and the canceled schedules in the dispatcher queue).
+
+  begin = std::chrono::steady_clock::now();
+
+  clients.clear();
+  waiter.detach_from_dispatcher();
+
+  end = std::chrono::steady_clock::now();
+
+  std::cout << "  teardown: " << std::chrono::duration<double, std::milli>(end - begin).count() << " ms" << std::endl;
+}
+} // namespace
+
+int main() {
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+
+  auto pseudo_time_source = std::make_shared<pqrs::dispatcher::pseudo_time_source>();
+  if (auto d = pqrs::dispatcher::extra::get_shared_dispatcher()) {
+    d->set_weak_time_source(pseudo_time_source);
+  }
+
+  std::cout << "clients: " << client_count << std::endl;
+  std::cout << "rounds: " << round_count << std::endl;
+
+  run<pqrs::dispatcher::extra::debounced_task>("pqrs::dispatcher::extra::debounced_task");
+  run<krbn::debounced_task>("krbn::debounced_task");
+
+  return 0;
+}
@@ -53,6 +53,11 @@ public:
           services_utility::unregister_multitouch_extension_agent();
         }
 
+        if (receiver_) {
+          receiver_->async_set_shell_command_worker_count(
+              core_configuration->get_global_configuration().get_shell_command_worker_count());
+        }
+
         publish_ui_state(core_configuration.get());
       }
     });
@@ -145,6 +150,10 @@ public:
       settings_window_guidance_manager_->async_start();
       receiver_ = std::make_unique<receiver>(settings_window_guidance_manager_,
                                              software_function_handler_);
+      if (core_configuration_) {
+        receiver_->async_set_shell_command_worker_count(
+            core_configuration_->get_global_configuration().get_shell_command_worker_count());
+      }
     });
   }
 
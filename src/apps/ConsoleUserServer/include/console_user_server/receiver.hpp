@@ -99,6 +99,14 @@ public:
     logger::get_logger()->debug("receiver is terminated");
   }
 
+  void async_set_shell_command_worker_count(size_t value) {
+    enqueue_to_dispatcher([this, value] {
+      if (shell_command_handler_) {
+        shell_command_handler_->set_worker_count(value);
+      }
+    });
+  }
+
   void handle_core_service_daemon_message(operation_type operation_type_value,
                                           const nlohmann::json& json) {
     try {
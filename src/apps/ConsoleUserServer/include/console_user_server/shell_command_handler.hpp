@@ -1,50 +1,209 @@
 #pragma once
 
+#include "logger.hpp"
+#include "shell_command_worker.hpp"
 #include <pqrs/dispatcher.hpp>
 #include <pqrs/process.hpp>
+#include <pqrs/string.hpp>
+#include <unordered_map>
 
 namespace krbn::console_user_server {
+// shell_command_handler runs `shell_command` events.
+//
+// Each command is tracked until it finishes, so a new command does not tear down the output handling of a running command.
+// The output of each command is buffered up to `output_limit` bytes and logged when the command is finished.
+//
+// When the worker count is greater than 0, commands are run in prewarmed `shell_command_worker` instances
+// to avoid the fork, exec and shell startup for each command.
+// If all workers are busy, the command is run with `/bin/sh -c`.
 class shell_command_handler final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
+  static constexpr size_t output_limit = 1024;
+
   shell_command_handler(const shell_command_handler&) = delete;
 
   shell_command_handler()
-      : dispatcher_client() {
+      : dispatcher_client(),
+        worker_count_(0),
+        last_command_id_(0) {
   }
 
   ~shell_command_handler() {
     detach_from_dispatcher([this] {
-      process_ = nullptr;
+      workers_.clear();
+      commands_.clear();
     });
   }
 
+  void set_worker_count(size_t value) {
+    if (worker_count_ == value) {
+      return;
+    }
+
+    worker_count_ = value;
+
+    erase_unneeded_workers();
+    start_workers();
+  }
+
   void run(const std::string& command) {
-    process_ = std::make_unique<pqrs::process::process>(weak_dispatcher_,
-                                                        std::vector<std::string>{
-                                                            "/bin/sh",
-                                                            "-c",
-                                                            command});
-
-    process_->stdout_received.connect([this](auto&& buffer) {
-      std::string s(buffer->begin(), buffer->end());
-      format_message(s);
-      if (s.size() > 0) {
-        logger::get_logger()->info("shell_command stdout:{0}", s);
+    auto command_id = ++last_command_id_;
+    commands_[command_id] = command_entry();
+
+    // Restart the workers which exited.
+    start_workers();
+
+    for (const auto& w : workers_) {
+      if (w->running() &&
+          !w->busy() &&
+          w->run(command_id, command)) {
+        return;
       }
+    }
+
+    auto p = std::make_unique<pqrs::process::process>(weak_dispatcher_,
+                                                      std::vector<std::string>{
+                                                          "/bin/sh",
+                                                          "-c",
+                                                          command});
+
+    p->stdout_received.connect([this, command_id](auto&& buffer) {
+      append_stdout(command_id, *buffer);
     });
 
-    process_->stderr_received.connect([this](auto&& buffer) {
-      std::string s(buffer->begin(), buffer->end());
-      format_message(s);
-      if (s.size() > 0) {
-        logger::get_logger()->error("shell_command stderr:{0}", s);
-      }
+    p->stderr_received.connect([this, command_id](auto&& buffer) {
+      append_stderr(command_id, *buffer);
+    });
+
+    p->exited.connect([this, command_id](auto&&) {
+      finish_command(command_id);
     });
 
-    process_->run();
+    p->run_failed.connect([this, command_id] {
+      logger::get_logger()->error("shell_command: failed to run the command");
+      finish_command(command_id);
+    });
+
+    auto& process = commands_[command_id].process;
+    process = std::move(p);
+    process->run();
   }
 
 private:
+  struct command_entry final {
+    // nullptr if the command is run in a worker.
+    std::unique_ptr<pqrs::process::process> process;
+    std::string stdout_buffer;
+    std::string stderr_buffer;
+  };
+
+  void start_workers() {
+    while (workers_.size() < worker_count_) {
+      auto w = std::make_unique<shell_command_worker>(weak_dispatcher_);
+
+      w->stdout_received.connect([this](auto command_id, auto&& buffer) {
+        append_stdout(command_id, *buffer);
+      });
+
+      w->stderr_received.connect([this](auto command_id, auto&& buffer) {
+        append_stderr(command_id, *buffer);
+      });
+
+      w->command_finished.connect([this](auto command_id, auto) {
+        finish_command(command_id);
+
+        // Remove the worker if the worker count is decreased while the command is running.
+        enqueue_to_dispatcher([this] {
+          erase_unneeded_workers();
+        });
+      });
+
+      w->exited.connect([this](auto&& command_id) {
+        logger::get_logger()->warn("shell_command: worker exited");
+
+        if (command_id) {
+          finish_command(*command_id);
+        }
+
+        // Workers cannot be destroyed in their signal handlers.
+        enqueue_to_dispatcher([this] {
+          erase_unneeded_workers();
+        });
+      });
+
+      if (!w->start()) {
+        logger::get_logger()->error("shell_command: failed to start a worker");
+        return;
+      }
+
+      workers_.push_back(std::move(w));
+    }
+  }
+
+  void erase_unneeded_workers() {
+    std::erase_if(workers_,
+                  [](const auto& w) {
+                    return !w->running();
+                  });
+
+    for (auto it = std::begin(workers_); it != std::end(workers_);) {
+      if (workers_.size() <= worker_count_) {
+        break;
+      }
+
+      if ((*it)->busy()) {
+        ++it;
+      } else {
+        it = workers_.erase(it);
+      }
+    }
+  }
+
+  void append_stdout(uint64_t command_id, const std::vector<uint8_t>& buffer) {
+    auto it = commands_.find(command_id);
+    if (it != std::end(commands_)) {
+      append_output(it->second.stdout_buffer, buffer);
+    }
+  }
+
+  void append_stderr(uint64_t command_id, const std::vector<uint8_t>& buffer) {
+    auto it = commands_.find(command_id);
+    if (it != std::end(commands_)) {
+      append_output(it->second.stderr_buffer, buffer);
+    }
+  }
+
+  static void append_output(std::string& output, const std::vector<uint8_t>& buffer) {
+    if (output.size() < output_limit) {
+      auto size = std::min(buffer.size(), output_limit - output.size());
+      output.append(std::begin(buffer), std::begin(buffer) + size);
+    }
+  }
+
+  void finish_command(uint64_t command_id) {
+    auto it = commands_.find(command_id);
+    if (it == std::end(commands_)) {
+      return;
+    }
+
+    auto& stdout_buffer = it->second.stdout_buffer;
+    format_message(stdout_buffer);
+    if (stdout_buffer.size() > 0) {
+      logger::get_logger()->info("shell_command stdout:{0}", stdout_buffer);
+    }
+
+    auto& stderr_buffer = it->second.stderr_buffer;
+    format_message(stderr_buffer);
+    if (stderr_buffer.size() > 0) {
+      logger::get_logger()->error("shell_command stderr:{0}", stderr_buffer);
+    }
+
+    // The process cannot be destroyed in its signal handlers.
+    enqueue_to_dispatcher([this, command_id] {
+      commands_.erase(command_id);
+    });
+  }
+
   void format_message(std::string& s) {
     std::replace(s.begin(), s.end(), '\n', ' ');
     std::replace(s.begin(), s.end(), '\r', ' ');
@@ -52,6 +211,9 @@ private:
     s = pqrs::string::truncate(s, 256);
   }
 
-  std::unique_ptr<pqrs::process::process> process_;
+  size_t worker_count_;
+  std::vector<std::unique_ptr<shell_command_worker>> workers_;
+  uint64_t last_command_id_;
+  std::unordered_map<uint64_t, command_entry> commands_;
 };
 } // namespace krbn::console_user_server
@@ -5,6 +5,7 @@
 #include "constants.hpp"
 #include "dispatcher_utility.hpp"
 #include "environment_variable_utility.hpp"
+#include "eval_js_cache.hpp"
 #include "filesystem_utility.hpp"
 #include "karabiner_version.h"
 #include "logger.hpp"
@@ -95,6 +96,13 @@ void console_user_server_start(console_user_server_terminated_callback callback)
 
   krbn::filesystem_utility::prepare_user_directories();
 
+  //
+  // Enable eval_js_cache
+  //
+
+  krbn::initialize_shared_eval_js_cache(krbn::constants::get_user_eval_js_cache_directory(),
+                                        karabiner_version);
+
   //
   // Run process_lifecycle_manager
   //
@@ -129,6 +137,7 @@ void console_user_server_finalize(void) {
   //
 
   krbn::process_lifecycle_manager::terminate_shared_instance();
+  krbn::terminate_shared_eval_js_cache();
   ui_bridge_instance = nullptr;
   scoped_run_loop_thread_manager = nullptr;
   scoped_dispatcher_manager = nullptr;
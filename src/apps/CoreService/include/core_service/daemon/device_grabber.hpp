@@ -1,5 +1,6 @@
 #pragma once
 
+#include "complex_modifications_utility.hpp"
 #include "console_user_server_peer.hpp"
 #include "constants.hpp"
 #include "core_service/daemon/core_service_daemon_state_manager.hpp"
@@ -14,6 +15,7 @@
 #include "json_writer.hpp"
 #include "keyboard_suppression.hpp"
 #include "krbn_notification_center.hpp"
+#include "latency_tracer.hpp"
 #include "logger.hpp"
 #include "manipulator/condition_factory.hpp"
 #include "manipulator/manipulator_factory.hpp"
@@ -202,6 +204,8 @@ public:
     post_event_to_virtual_devices_manipulator_->set_cgeventtap_fallback_enabled(cgeventtap_fallback_enabled_);
     post_event_to_virtual_devices_manipulator_->set_sleep_shortcut_delay(
         std::chrono::milliseconds(core_configuration_->get_global_configuration().get_delay_milliseconds_before_sleep_shortcut()));
+    post_event_to_virtual_devices_manipulator_->set_pointing_input_coalescing_enabled(
+        core_configuration_->get_global_configuration().get_coalesce_pointing_motion());
     post_event_to_virtual_devices_manipulator_manager_->push_back_manipulator(std::shared_ptr<manipulator::manipulators::base>(post_event_to_virtual_devices_manipulator_));
 
     // Connect manipulator_managers
@@ -511,6 +515,8 @@ public:
           if (post_event_to_virtual_devices_manipulator_) {
             post_event_to_virtual_devices_manipulator_->set_sleep_shortcut_delay(
                 std::chrono::milliseconds(core_configuration_->get_global_configuration().get_delay_milliseconds_before_sleep_shortcut()));
+            post_event_to_virtual_devices_manipulator_->set_pointing_input_coalescing_enabled(
+                core_configuration_->get_global_configuration().get_coalesce_pointing_motion());
           }
 
           if (hid_manager_) {
@@ -599,6 +605,29 @@ public:
     });
   }
 
+  // Post variables as a single entry.
+  // The variables are applied at once and manipulators handle the entry only once.
+  void async_post_set_variables_event(const std::vector<manipulator_environment_variable_set_variable>& values) {
+    if (values.empty()) {
+      return;
+    }
+
+    enqueue_to_dispatcher([this, values] {
+      auto event = event_queue::event::make_set_variables_event(values);
+      event_queue::entry entry(device_id(0),
+                               event_queue::event_time_stamp(pqrs::osx::chrono::mach_absolute_time_point()),
+                               event,
+                               event_type::single,
+                               std::nullopt,
+                               event,
+                               event_queue::state::virtual_event);
+
+      merged_input_event_queue_->push_back_entry(entry);
+
+      krbn_notification_center::get_instance().enqueue_input_event_arrived(*this);
+    });
+  }
+
   void async_post_frontmost_application_changed_event(const application& application) {
     enqueue_to_dispatcher([this, application] {
       auto event = event_queue::event::make_frontmost_application_changed_event(application);
@@ -674,6 +703,38 @@ public:
     });
   }
 
+  void async_set_latency_trace_enabled(bool value) {
+    enqueue_to_dispatcher([this, value] {
+      if (value) {
+        // Reset the histograms when the tracing is enabled.
+        latency_tracer_ = std::make_shared<latency_tracer>(std::vector<std::string>{
+            "device_key_code",
+            "simple_modifications",
+            "complex_modifications",
+            "fn_function_keys",
+            "post_event_to_virtual_devices",
+        });
+      } else {
+        latency_tracer_ = nullptr;
+      }
+
+      manipulator_managers_connector_.set_latency_tracer(latency_tracer_);
+      post_event_to_virtual_devices_manipulator_->set_latency_tracer(latency_tracer_);
+
+      logger::get_logger()->info("latency trace is {0}", value ? "enabled" : "disabled");
+    });
+  }
+
+  void async_invoke_with_latency_trace(std::function<void(const nlohmann::json&)> function) const {
+    enqueue_to_dispatcher([this, function] {
+      if (latency_tracer_) {
+        function(latency_tracer_->to_json());
+      } else {
+        function(nlohmann::json());
+      }
+    });
+  }
+
   void async_invoke_with_connected_devices(std::function<void(const nlohmann::json&)> function) const {
     enqueue_to_dispatcher([this, function] {
       connected_devices connected_devices;
@@ -734,12 +795,12 @@ private:
 
   // This method is executed in the shared dispatcher thread.
   void hid_values_arrived(device_grabber_details::entry& entry,
-                          event_queue::not_null_entries_ptr_t event_queue_entries) {
+                          std::vector<event_queue::entry>& event_queue_entries) {
     if (entry.get_device_properties()->get_device_identifiers().get_is_virtual_device()) {
       // Handle caps_lock_state_changed event only if the hid is Karabiner-DriverKit-VirtualHIDDevice.
-      for (const auto& e : *event_queue_entries) {
-        if (e->get_event().get_type() == event_queue::event::type::caps_lock_state_changed) {
-          if (auto state = e->get_event().get_integer_value()) {
+      for (const auto& e : event_queue_entries) {
+        if (e.get_event().get_type() == event_queue::event::type::caps_lock_state_changed) {
+          if (auto state = e.get_event().get_integer_value()) {
             last_caps_lock_state_ = *state;
             post_caps_lock_state_changed_event(*state);
             update_caps_lock_led();
@@ -751,23 +812,16 @@ private:
 
       bool notify = false;
 
-      for (const auto& e : *event_queue_entries) {
+      for (auto&& e : event_queue_entries) {
         if (!entry.get_disabled() && entry.seized()) {
-          if (unbalanced_momentary_switch_event(e->get_device_id(),
-                                                e->get_event(),
-                                                e->get_event_type())) {
+          if (unbalanced_momentary_switch_event(e.get_device_id(),
+                                                e.get_event(),
+                                                e.get_event_type())) {
             continue;
           }
 
-          event_queue::entry qe(e->get_device_id(),
-                                e->get_event_time_stamp(),
-                                e->get_event(),
-                                e->get_event_type(),
-                                e->get_event_integer_value(),
-                                e->get_original_event(),
-                                e->get_state());
-
-          merged_input_event_queue_->push_back_entry(qe);
+          // Move entries into the merged queue since event_queue_entries is discarded after this call.
+          merged_input_event_queue_->push_back_entry(std::move(e));
 
           notify = true;
         }
@@ -1026,30 +1080,12 @@ private:
   }
 
   void update_complex_modifications_manipulators() {
-    complex_modifications_manipulator_manager_->invalidate_manipulators();
-
-    for (const auto& rule : core_configuration_->get_selected_profile().get_complex_modifications()->get_rules()) {
-      if (!rule->get_enabled()) {
-        continue;
-      }
-
-      for (const auto& manipulator : rule->get_manipulators()) {
-        try {
-          auto m = manipulator::manipulator_factory::make_manipulator(manipulator->to_json(),
-                                                                      manipulator->get_parameters());
-          for (const auto& c : manipulator->get_conditions()) {
-            m->push_back_condition(manipulator::condition_factory::make_condition(c.get_json()));
-          }
-          complex_modifications_manipulator_manager_->push_back_manipulator(m);
-
-        } catch (const pqrs::json::unmarshal_error& e) {
-          logger::get_logger()->error(fmt::format("karabiner.json error: {0}", e.what()));
+    // Unchanged manipulators are kept in order not to rebuild all manipulators and not to reset their state on each reload.
+    auto reused_count = complex_modifications_utility::update_manipulators(*complex_modifications_manipulator_manager_,
+                                                                           *(core_configuration_->get_selected_profile().get_complex_modifications()));
 
-        } catch (const std::exception& e) {
-          logger::get_logger()->error(e.what());
-        }
-      }
-    }
+    logger::get_logger()->info("complex_modifications manipulators are updated (reused: {0})",
+                               reused_count);
   }
 
   void set_cgeventtap_fallback_enabled(bool value) {
@@ -1232,6 +1268,8 @@ private:
   pqrs::osx::system_preferences::properties system_preferences_properties_;
 
   manipulator::manipulator_managers_connector manipulator_managers_connector_;
+  // latency_tracer_ is nullptr while the latency trace is disabled.
+  std::shared_ptr<latency_tracer> latency_tracer_;
 
   std::shared_ptr<notification_message_manager> notification_message_manager_;
 
@@ -1252,7 +1290,7 @@ private:
   std::shared_ptr<manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices> post_event_to_virtual_devices_manipulator_;
   std::shared_ptr<manipulator::manipulator_manager> post_event_to_virtual_devices_manipulator_manager_;
   std::shared_ptr<event_queue::queue> posted_event_queue_;
-  std::unordered_map<device_id, std::unordered_set<momentary_switch_event>> physical_pressed_momentary_switch_events_;
+  std::unordered_map<device_id, pressed_keys_manager> physical_pressed_momentary_switch_events_;
 
   bool cgeventtap_fallback_enabled_ = false;
 
@@ -11,6 +11,7 @@
 #include "pressed_keys_manager.hpp"
 #include "run_loop_thread_utility.hpp"
 #include "types.hpp"
+#include "unchanged_hid_value_filter.hpp"
 
 namespace krbn::core_service::daemon::device_grabber_details {
 class entry final : public pqrs::dispatcher::extra::dispatcher_client {
@@ -19,8 +20,9 @@ public:
   // Signals (invoked from the shared dispatcher thread)
   //
 
+  // event_queue_entries is a reused buffer; slots may move entries out of it.
   nod::signal<void(entry&,
-                   event_queue::not_null_entries_ptr_t event_queue_entries)>
+                   std::vector<event_queue::entry>& event_queue_entries)>
       hid_values_arrived;
 
   //
@@ -40,6 +42,8 @@ public:
         pressed_keys_manager_(std::make_shared<pressed_keys_manager>()),
         disabled_(false),
         temporarily_ignore_(false) {
+    update_device_settings();
+
     caps_lock_led_state_manager_ = std::make_shared<krbn::hid_keyboard_caps_lock_led_state_manager>(device);
 
     hid_device_events_monitor_ = std::make_shared<hid_device_events_monitor>(
@@ -50,16 +54,18 @@ public:
     hid_device_events_monitor_->started.connect([this] {
       control_caps_lock_led_state_manager();
 
+      unchanged_hid_value_filter_.reset();
+
       if (seized()) {
         if (device_properties_->get_device_identifiers().get_is_game_pad()) {
           game_pad_stick_converter_ = std::make_unique<game_pad_stick_converter>(device_properties_,
                                                                                  core_configuration_);
           game_pad_stick_converter_->pointing_motion_arrived.connect([this](auto&& event_queue_entry) {
-            auto event_queue_entries = std::make_shared<std::vector<event_queue::not_null_const_entry_ptr_t>>();
-            event_queue_entries->push_back(event_queue_entry);
+            event_queue_entries_.clear();
+            event_queue_entries_.push_back(*event_queue_entry);
 
             hid_values_arrived(*this,
-                               event_queue_entries);
+                               event_queue_entries_);
           });
         }
       }
@@ -67,47 +73,48 @@ public:
     hid_device_events_monitor_->stopped.connect([this] {
       control_caps_lock_led_state_manager();
 
+      if (auto dropped_count = unchanged_hid_value_filter_.get_dropped_count()) {
+        logger::get_logger()->info("{0}: {1} of {2} HID values were dropped by the unchanged HID values filter.",
+                                   device_name_,
+                                   dropped_count,
+                                   dropped_count + unchanged_hid_value_filter_.get_passed_count());
+      }
+
       game_pad_stick_converter_ = nullptr;
     });
-    hid_device_events_monitor_->values_arrived.connect([this](auto&& values_ptr) {
-      auto d = core_configuration_->get_selected_profile().get_device(device_properties_->get_device_identifiers());
-
-      auto hid_values = *values_ptr;
+    hid_device_events_monitor_->values_arrived.connect([this](auto&& hid_values) {
+      const auto& settings = device_settings_;
 
       //
       // Eliminated the entries that needed to be removed from hid_values
       //
 
-      std::erase_if(hid_values,
-                    [this, &d](const auto& v) {
-                      //
-                      // Handle ignore_vendor_events
-                      //
-
-                      // For Apple devices, process vendor events regardless of the "ignore_vendor_events" setting.
-                      // Even if karabiner.json is manually edited to set "ignore_vendor_events": true,
-                      // ignore that setting and handle vendor events.
-                      if (d->get_ignore_vendor_events() &&
-                          !device_properties_->get_is_apple()) {
-                        // 0xff
-                        if (v.get_usage_page() == pqrs::hid::usage_page::apple_vendor_top_case) {
-                          return true;
-                        }
+      if (settings.ignore_vendor_events ||
+          settings.filter_useless_events) {
+        std::erase_if(hid_values,
+                      [&settings](const auto& v) {
+                        //
+                        // Handle ignore_vendor_events
+                        //
+
+                        if (settings.ignore_vendor_events) {
+                          // 0xff
+                          if (v.get_usage_page() == pqrs::hid::usage_page::apple_vendor_top_case) {
+                            return true;
+                          }
 
-                        // Vendor-defined (0xff00-0xffff)
-                        if (v.get_usage_page() >= pqrs::hid::usage_page::value_t(0xff00) &&
-                            v.get_usage_page() <= pqrs::hid::usage_page::value_t(0xffff)) {
-                          return true;
+                          // Vendor-defined (0xff00-0xffff)
+                          if (v.get_usage_page() >= pqrs::hid::usage_page::value_t(0xff00) &&
+                              v.get_usage_page() <= pqrs::hid::usage_page::value_t(0xffff)) {
+                            return true;
+                          }
                         }
-                      }
 
-                      //
-                      // Filter useless events
-                      //
+                        //
+                        // Filter useless events
+                        //
 
-                      if (core_configuration_->get_global_configuration().get_filter_useless_events_from_specific_devices()) {
-                        if (device_properties_->get_device_identifiers().is_nintendo_pro_controller_0x057e_0x2009() &&
-                            device_properties_->get_transport() == "USB") {
+                        if (settings.filter_useless_events) {
                           // Nintendo's Pro Controller, when connected via USB, generates a high frequency of events even when no input is made.
                           // As these events contain no meaningful information, they should be ignored.
 
@@ -125,27 +132,46 @@ public:
                             return true;
                           }
                         }
-                      }
 
-                      return false;
-                    });
+                        return false;
+                      });
+      }
+
+      //
+      // Filter unchanged values
+      //
+
+      if (unchanged_hid_value_filter_.filter(hid_values)) {
+        logger::get_logger()->info("{0}: The unchanged HID values filter is enabled automatically due to the high event rate.",
+                                   device_name_);
+      }
+
+      if (auto r = unchanged_hid_value_filter_.take_periodic_report()) {
+        logger::get_logger()->info("{0}: {1} of {2} HID values were dropped by the unchanged HID values filter since the last report.",
+                                   device_name_,
+                                   r->dropped,
+                                   r->dropped + r->passed);
+      }
+
+      if (hid_values.empty()) {
+        return;
+      }
 
       //
       // Make event queue
       //
 
-      auto event_queue_entries = event_queue::utility::make_entries(device_properties_,
-                                                                    hid_values,
-                                                                    {
-                                                                        .pointing_motion_xy_multiplier = d->get_pointing_motion_xy_multiplier(),
-                                                                        .pointing_motion_wheels_multiplier = d->get_pointing_motion_wheels_multiplier(),
-                                                                    });
+      event_queue_entries_.clear();
+      event_queue::utility::make_entries(device_properties_,
+                                         hid_values,
+                                         settings.make_entries_parameters,
+                                         event_queue_entries_);
 
-      event_queue_entries = event_queue::utility::insert_device_keys_and_pointing_buttons_are_released_event(event_queue_entries,
-                                                                                                             device_id_,
-                                                                                                             pressed_keys_manager_);
+      event_queue::utility::insert_device_keys_and_pointing_buttons_are_released_event(event_queue_entries_,
+                                                                                       device_id_,
+                                                                                       pressed_keys_manager_);
       hid_values_arrived(*this,
-                         event_queue_entries);
+                         event_queue_entries_);
 
       //
       // game pad stick to pointing motion
@@ -177,6 +203,8 @@ public:
   void set_core_configuration(pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration) {
     core_configuration_ = core_configuration;
 
+    update_device_settings();
+
     control_caps_lock_led_state_manager();
 
     if (game_pad_stick_converter_) {
@@ -239,8 +267,7 @@ public:
       return false;
     }
 
-    auto d = core_configuration_->get_selected_profile().get_device(device_properties_->get_device_identifiers());
-    return d->get_disable_built_in_keyboard_if_exists();
+    return device_settings_.disable_built_in_keyboard_if_exists;
   }
 
   [[nodiscard]] bool determine_is_built_in_keyboard() const {
@@ -308,19 +335,64 @@ public:
       return true;
     }
 
-    auto d = core_configuration_->get_selected_profile().get_device(device_properties_->get_device_identifiers());
-    return !(d->get_ignore());
+    return !device_settings_.ignore;
   }
 
 private:
+  // The device settings resolved from core_configuration.
+  // They are resolved when core_configuration is set, so that handling HID values does not look up the device in the profile.
+  struct device_settings final {
+    bool ignore;
+    bool ignore_vendor_events;
+    bool filter_useless_events;
+    bool manipulate_caps_lock_led;
+    bool disable_built_in_keyboard_if_exists;
+    event_queue::utility::make_entries_parameters make_entries_parameters;
+    unchanged_hid_value_filter::parameters unchanged_hid_value_filter_parameters;
+  };
+
+  void update_device_settings() {
+    const auto& identifiers = device_properties_->get_device_identifiers();
+    auto d = core_configuration_->get_selected_profile().find_device_or_default(identifiers);
+
+    device_settings_ = device_settings{
+        .ignore = d->get_ignore(),
+        // For Apple devices, process vendor events regardless of the "ignore_vendor_events" setting.
+        // Even if karabiner.json is manually edited to set "ignore_vendor_events": true,
+        // ignore that setting and handle vendor events.
+        .ignore_vendor_events = d->get_ignore_vendor_events() &&
+                                !device_properties_->get_is_apple(),
+        .filter_useless_events = core_configuration_->get_global_configuration().get_filter_useless_events_from_specific_devices() &&
+                                 identifiers.is_nintendo_pro_controller_0x057e_0x2009() &&
+                                 device_properties_->get_transport() == "USB",
+        .manipulate_caps_lock_led = d->get_manipulate_caps_lock_led(),
+        .disable_built_in_keyboard_if_exists = d->get_disable_built_in_keyboard_if_exists(),
+        .make_entries_parameters = {
+            .pointing_motion_xy_multiplier = d->get_pointing_motion_xy_multiplier(),
+            .pointing_motion_wheels_multiplier = d->get_pointing_motion_wheels_multiplier(),
+        },
+        .unchanged_hid_value_filter_parameters = {
+            .enabled = d->get_filter_unchanged_hid_values(),
+            .dead_band = d->get_filter_unchanged_hid_values_dead_band(),
+            .auto_enable_values_per_second = core_configuration_->get_global_configuration().get_filter_unchanged_hid_values_auto_enable_values_per_second(),
+        },
+    };
+
+    if (identifiers.get_is_virtual_device()) {
+      // Karabiner-DriverKit-VirtualHIDDevice is only observed.
+      device_settings_.unchanged_hid_value_filter_parameters = {};
+    }
+
+    unchanged_hid_value_filter_.set_parameters(device_settings_.unchanged_hid_value_filter_parameters);
+  }
+
   void control_caps_lock_led_state_manager() {
     if (device_properties_->get_device_identifiers().get_is_virtual_device()) {
       return;
     }
 
     if (caps_lock_led_state_manager_) {
-      auto d = core_configuration_->get_selected_profile().get_device(device_properties_->get_device_identifiers());
-      if (d->get_manipulate_caps_lock_led()) {
+      if (device_settings_.manipulate_caps_lock_led) {
         if (seized()) {
           caps_lock_led_state_manager_->async_start();
           return;
@@ -338,6 +410,9 @@ private:
   std::shared_ptr<hid_keyboard_caps_lock_led_state_manager> caps_lock_led_state_manager_;
   std::shared_ptr<hid_device_events_monitor> hid_device_events_monitor_;
   std::unique_ptr<game_pad_stick_converter> game_pad_stick_converter_;
+  device_settings device_settings_;
+  unchanged_hid_value_filter unchanged_hid_value_filter_;
+  std::vector<event_queue::entry> event_queue_entries_;
   std::string device_name_;
   std::string device_short_name_;
 
@@ -257,6 +257,7 @@ public:
         continued_movement_timer_(*this),
         continued_movement_timer_count_(0),
         continued_movement_mode_(continued_movement_mode::none),
+        swap_sticks_(false),
         x_formula_(exprtk_utility::compile("")),
         y_formula_(exprtk_utility::compile("")),
         vertical_wheel_formula_(exprtk_utility::compile("")),
@@ -323,7 +324,7 @@ public:
     // Propagate the changes
     //
 
-    auto d = core_configuration_->get_selected_profile().get_device(device_properties_->get_device_identifiers());
+    auto d = core_configuration_->get_selected_profile().find_device_or_default(device_properties_->get_device_identifiers());
 
     xy_.set_deadzone(d->get_game_pad_xy_stick_deadzone());
     xy_.set_delta_magnitude_detection_threshold(d->get_game_pad_xy_stick_delta_magnitude_detection_threshold());
@@ -335,6 +336,8 @@ public:
     wheels_.set_continued_movement_absolute_magnitude_threshold(d->get_game_pad_wheels_stick_continued_movement_absolute_magnitude_threshold());
     wheels_.set_continued_movement_interval_milliseconds(d->get_game_pad_wheels_stick_continued_movement_interval_milliseconds());
 
+    swap_sticks_ = d->get_game_pad_swap_sticks();
+
     x_formula_string_ = d->get_game_pad_stick_x_formula();
     y_formula_string_ = d->get_game_pad_stick_y_formula();
     vertical_wheel_formula_string_ = d->get_game_pad_stick_vertical_wheel_formula();
@@ -355,9 +358,6 @@ public:
       }
     }
 
-    auto device = core_configuration_->get_selected_profile().get_device(device_properties_->get_device_identifiers());
-    bool swap_sticks = device->get_game_pad_swap_sticks();
-
     for (const auto& v : hid_values) {
       if (auto usage_page = v.get_usage_page()) {
         if (auto usage = v.get_usage()) {
@@ -366,7 +366,7 @@ public:
               if (*logical_max != *logical_min) {
                 if (v.conforms_to(pqrs::hid::usage_page::generic_desktop,
                                   pqrs::hid::usage::generic_desktop::x)) {
-                  if (swap_sticks) {
+                  if (swap_sticks_) {
                     update_horizontal_wheel_stick_sensor_value(*logical_max,
                                                                *logical_min,
                                                                v.get_integer_value());
@@ -377,7 +377,7 @@ public:
                   }
                 } else if (v.conforms_to(pqrs::hid::usage_page::generic_desktop,
                                          pqrs::hid::usage::generic_desktop::y)) {
-                  if (swap_sticks) {
+                  if (swap_sticks_) {
                     update_vertical_wheel_stick_sensor_value(*logical_max,
                                                              *logical_min,
                                                              v.get_integer_value());
@@ -388,7 +388,7 @@ public:
                   }
                 } else if (v.conforms_to(pqrs::hid::usage_page::generic_desktop,
                                          pqrs::hid::usage::generic_desktop::rz)) {
-                  if (swap_sticks) {
+                  if (swap_sticks_) {
                     update_y_stick_sensor_value(*logical_max,
                                                 *logical_min,
                                                 v.get_integer_value());
@@ -399,7 +399,7 @@ public:
                   }
                 } else if (v.conforms_to(pqrs::hid::usage_page::generic_desktop,
                                          pqrs::hid::usage::generic_desktop::z)) {
-                  if (swap_sticks) {
+                  if (swap_sticks_) {
                     update_x_stick_sensor_value(*logical_max,
                                                 *logical_min,
                                                 v.get_integer_value());
@@ -418,15 +418,34 @@ public:
   }
 
 private:
-  std::pair<double, double> xy_hid_values() const {
-    auto x = x_formula_->value();
+  struct formula_variables final {
+    double radian;
+    double delta_magnitude;
+    double absolute_magnitude;
+    double continued_movement;
+  };
+
+  // Compiled formulas are shared among the same formula strings (e.g., x_formula and vertical_wheel_formula).
+  // So we have to set variables and evaluate each formula under one lock with `evaluate`.
+  static double evaluate_formula(exprtk_utility::expression_wrapper& formula,
+                                 const formula_variables& variables) {
+    return formula.evaluate({
+        {"radian", variables.radian},
+        {"delta_magnitude", variables.delta_magnitude},
+        {"absolute_magnitude", variables.absolute_magnitude},
+        {"continued_movement", variables.continued_movement},
+    });
+  }
+
+  std::pair<double, double> xy_hid_values(const formula_variables& variables) const {
+    auto x = evaluate_formula(*x_formula_, variables);
     if (std::isnan(x)) {
       logger::get_logger()->error("game_pad_stick_converter x_formula returns nan: {0}",
                                   x_formula_string_);
       x = 0.0;
     }
 
-    auto y = y_formula_->value();
+    auto y = evaluate_formula(*y_formula_, variables);
     if (std::isnan(y)) {
       logger::get_logger()->error("game_pad_stick_converter y_formula returns nan: {0}",
                                   y_formula_string_);
@@ -436,15 +455,15 @@ private:
     return std::make_pair(x, y);
   }
 
-  std::pair<double, double> wheels_hid_values() const {
-    auto h = horizontal_wheel_formula_->value();
+  std::pair<double, double> wheels_hid_values(const formula_variables& variables) const {
+    auto h = evaluate_formula(*horizontal_wheel_formula_, variables);
     if (std::isnan(h)) {
       logger::get_logger()->error("game_pad_stick_converter horizontal_wheel_formula returns nan: {0}",
                                   horizontal_wheel_formula_string_);
       h = 0.0;
     }
 
-    auto v = vertical_wheel_formula_->value();
+    auto v = evaluate_formula(*vertical_wheel_formula_, variables);
     if (std::isnan(v)) {
       logger::get_logger()->error("game_pad_stick_converter vertical_wheel_formula returns nan: {0}",
                                   vertical_wheel_formula_string_);
@@ -495,6 +514,9 @@ private:
   }
 
   void post_event(continued_movement_mode mode) {
+    formula_variables xy_variables;
+    formula_variables wheels_variables;
+
     //
     // Update xy variables
     //
@@ -512,12 +534,12 @@ private:
         absolute_magnitude += m;
       }
 
-      for (auto&& f : {x_formula_, y_formula_}) {
-        f->set_variable("radian", radian);
-        f->set_variable("delta_magnitude", delta_magnitude);
-        f->set_variable("absolute_magnitude", absolute_magnitude);
-        f->set_variable("continued_movement", continued_movement);
-      }
+      xy_variables = formula_variables{
+          .radian = radian,
+          .delta_magnitude = delta_magnitude,
+          .absolute_magnitude = absolute_magnitude,
+          .continued_movement = continued_movement,
+      };
     }
 
     //
@@ -537,19 +559,19 @@ private:
         absolute_magnitude += m;
       }
 
-      for (auto&& f : {vertical_wheel_formula_, horizontal_wheel_formula_}) {
-        f->set_variable("radian", radian);
-        f->set_variable("delta_magnitude", delta_magnitude);
-        f->set_variable("absolute_magnitude", absolute_magnitude);
-        f->set_variable("continued_movement", continued_movement);
-      }
+      wheels_variables = formula_variables{
+          .radian = radian,
+          .delta_magnitude = delta_magnitude,
+          .absolute_magnitude = absolute_magnitude,
+          .continued_movement = continued_movement,
+      };
     }
 
-    auto [x, y] = xy_hid_values();
+    auto [x, y] = xy_hid_values(xy_variables);
     x_value_.set_value(x);
     y_value_.set_value(y);
 
-    auto [h, v] = wheels_hid_values();
+    auto [h, v] = wheels_hid_values(wheels_variables);
     horizontal_wheel_value_.set_value(h);
     vertical_wheel_value_.set_value(v);
 
@@ -633,6 +655,7 @@ private:
   int continued_movement_timer_count_;
   continued_movement_mode continued_movement_mode_;
 
+  bool swap_sticks_;
   std::string x_formula_string_;
   std::string y_formula_string_;
   std::string vertical_wheel_formula_string_;
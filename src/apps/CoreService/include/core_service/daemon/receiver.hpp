@@ -12,7 +12,6 @@
 #include "process_lifecycle_manager.hpp"
 #include "types.hpp"
 #include "types/core_service_daemon_state.hpp"
-#include <array>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -183,6 +182,7 @@ private:
     temporarily_ignore_all_devices_peer_ids_.erase(peer_id);
     connected_devices_observer_peer_ids_.erase(peer_id);
     notification_message_observer_peer_ids_.erase(peer_id);
+    multitouch_extension_variables_observer_peer_ids_.erase(peer_id);
 
     // Restore the flags when all clients have closed.
     if (temporarily_ignore_all_devices_peer_ids_.empty()) {
@@ -219,6 +219,13 @@ private:
       return;
     }
 
+    if (multitouch_extension_variables::is_message(*buffer)) {
+      handle_multitouch_extension_variables_message(peer_id,
+                                                    request_id,
+                                                    *buffer);
+      return;
+    }
+
     try {
       nlohmann::json json = nlohmann::json::from_msgpack(*buffer);
       switch (json.at("operation_type").get<operation_type>()) {
@@ -401,15 +408,15 @@ private:
 
         case operation_type::set_variables:
           if (device_grabber_) {
+            std::vector<manipulator_environment_variable_set_variable> values;
             for (const auto& [k, v] : json.at("variables").items()) {
-              device_grabber_->async_post_set_variable_event(
-                  manipulator_environment_variable_set_variable(
-                      k,
-                      v.get<manipulator_environment_variable_value>(),
-                      nullptr,
-                      std::nullopt,
-                      nullptr));
+              values.emplace_back(k,
+                                  v.get<manipulator_environment_variable_value>(),
+                                  nullptr,
+                                  std::nullopt,
+                                  nullptr);
             }
+            device_grabber_->async_post_set_variables_event(values);
           }
           async_respond_none(peer_id,
                              request_id);
@@ -419,21 +426,21 @@ private:
           if (device_grabber_) {
             device_grabber_->async_invoke_with_manipulator_environment(
                 [this, peer_id, request_id](auto&& manipulator_environment) {
+                  std::vector<manipulator_environment_variable_set_variable> values;
                   for (const auto& name : manipulator_environment.get_variable_names()) {
                     if (name.starts_with("system.") ||
                         name.starts_with("accessibility.")) {
                       continue;
                     }
 
-                    device_grabber_->async_post_set_variable_event(
-                        manipulator_environment_variable_set_variable(
-                            name,
-                            std::nullopt,
-                            nullptr,
-                            std::nullopt,
-                            nullptr,
-                            manipulator_environment_variable_set_variable::type::unset));
+                    values.emplace_back(name,
+                                        std::nullopt,
+                                        nullptr,
+                                        std::nullopt,
+                                        nullptr,
+                                        manipulator_environment_variable_set_variable::type::unset);
                   }
+                  device_grabber_->async_post_set_variables_event(values);
 
                   async_respond_none(peer_id,
                                      request_id);
@@ -503,7 +510,7 @@ private:
             device_grabber_->async_invoke_with_manipulator_environment(
                 [this, peer_id, request_id](auto&& manipulator_environment) {
                   std::unordered_map<std::string, manipulator_environment_variable_value> variables;
-                  for (const auto& name : multitouch_extension_environment_variable_names) {
+                  for (const auto& name : multitouch_extension_variables::names) {
                     variables[name] = manipulator_environment.get_variable(name);
                   }
 
@@ -519,6 +526,42 @@ private:
           }
           break;
 
+        case operation_type::observe_multitouch_extension_variables:
+          multitouch_extension_variables_observer_peer_ids_.insert(peer_id);
+          async_respond(peer_id,
+                        request_id,
+                        make_multitouch_extension_variables_message());
+          break;
+
+        case operation_type::set_latency_trace_enabled: {
+          auto value = json.at("value").get<bool>();
+
+          if (device_grabber_) {
+            device_grabber_->async_set_latency_trace_enabled(value);
+          }
+
+          async_respond_none(peer_id,
+                             request_id);
+          break;
+        }
+
+        case operation_type::get_latency_trace:
+          if (device_grabber_) {
+            device_grabber_->async_invoke_with_latency_trace(
+                [this, peer_id, request_id](auto&& latency_trace) {
+                  async_respond(peer_id,
+                                request_id,
+                                nlohmann::json{
+                                    {"operation_type", operation_type::latency_trace},
+                                    {"latency_trace", latency_trace},
+                                });
+                });
+          } else {
+            async_respond_none(peer_id,
+                               request_id);
+          }
+          break;
+
         default:
           server_->async_close_peer(peer_id);
           break;
@@ -529,6 +572,28 @@ private:
     }
   }
 
+  void handle_multitouch_extension_variables_message(pqrs::unix_domain_stream::peer_id peer_id,
+                                                     pqrs::unix_domain_stream::request_id request_id,
+                                                     const std::vector<uint8_t>& buffer) {
+    auto previous_variables = multitouch_extension_variables_;
+
+    auto changed_mask = multitouch_extension_variables_.apply_message(buffer);
+    if (!changed_mask) {
+      logger::get_logger()->error("received data is corrupted");
+      server_->async_close_peer(peer_id);
+      return;
+    }
+
+    post_multitouch_extension_variables(*changed_mask);
+
+    if (previous_variables != multitouch_extension_variables_) {
+      send_multitouch_extension_variables_to_observers();
+    }
+
+    async_respond_none(peer_id,
+                       request_id);
+  }
+
   std::filesystem::path karabiner_core_service_daemon_socket_file_path() const {
     return constants::get_karabiner_core_service_daemon_socket_file_path();
   }
@@ -579,6 +644,9 @@ private:
     device_grabber_->async_post_frontmost_application_changed_event(frontmost_application_);
     set_focused_ui_element_variables();
     device_grabber_->async_post_input_source_changed_event(input_source_properties_);
+    if (multitouch_extension_peer_id_) {
+      post_multitouch_extension_variables(multitouch_extension_variables::all_mask);
+    }
 
     device_grabber_->async_start(user_core_configuration_file_path,
                                  current_console_user_id_);
@@ -686,65 +754,71 @@ private:
 
   void set_focused_ui_element_variables() {
     if (device_grabber_) {
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.role_string",
-              manipulator_environment_variable_value(focused_ui_element_.get_role().value_or("")),
-              nullptr,
-              std::nullopt,
-              nullptr));
-
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.subrole_string",
-              manipulator_environment_variable_value(focused_ui_element_.get_subrole().value_or("")),
-              nullptr,
-              std::nullopt,
-              nullptr));
-
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.title_string",
-              manipulator_environment_variable_value(focused_ui_element_.get_title().value_or("")),
-              nullptr,
-              std::nullopt,
-              nullptr));
-
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.window_position_x",
-              manipulator_environment_variable_value(
-                  static_cast<int64_t>(focused_ui_element_.get_window_position_x().value_or(0))),
-              nullptr,
-              std::nullopt,
-              nullptr));
-
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.window_position_y",
-              manipulator_environment_variable_value(
-                  static_cast<int64_t>(focused_ui_element_.get_window_position_y().value_or(0))),
-              nullptr,
-              std::nullopt,
-              nullptr));
-
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.window_size_width",
-              manipulator_environment_variable_value(
-                  static_cast<int64_t>(focused_ui_element_.get_window_size_width().value_or(0))),
-              nullptr,
-              std::nullopt,
-              nullptr));
-
-      device_grabber_->async_post_set_variable_event(
-          manipulator_environment_variable_set_variable(
-              "accessibility.focused_ui_element.window_size_height",
-              manipulator_environment_variable_value(
-                  static_cast<int64_t>(focused_ui_element_.get_window_size_height().value_or(0))),
-              nullptr,
-              std::nullopt,
-              nullptr));
+      auto make = [](const std::string& name, const manipulator_environment_variable_value& value) {
+        return manipulator_environment_variable_set_variable(name,
+                                                             value,
+                                                             nullptr,
+                                                             std::nullopt,
+                                                             nullptr);
+      };
+
+      device_grabber_->async_post_set_variables_event({
+          make("accessibility.focused_ui_element.role_string",
+               manipulator_environment_variable_value(focused_ui_element_.get_role().value_or(""))),
+          make("accessibility.focused_ui_element.subrole_string",
+               manipulator_environment_variable_value(focused_ui_element_.get_subrole().value_or(""))),
+          make("accessibility.focused_ui_element.title_string",
+               manipulator_environment_variable_value(focused_ui_element_.get_title().value_or(""))),
+          make("accessibility.focused_ui_element.window_position_x",
+               manipulator_environment_variable_value(
+                   static_cast<int64_t>(focused_ui_element_.get_window_position_x().value_or(0)))),
+          make("accessibility.focused_ui_element.window_position_y",
+               manipulator_environment_variable_value(
+                   static_cast<int64_t>(focused_ui_element_.get_window_position_y().value_or(0)))),
+          make("accessibility.focused_ui_element.window_size_width",
+               manipulator_environment_variable_value(
+                   static_cast<int64_t>(focused_ui_element_.get_window_size_width().value_or(0)))),
+          make("accessibility.focused_ui_element.window_size_height",
+               manipulator_environment_variable_value(
+                   static_cast<int64_t>(focused_ui_element_.get_window_size_height().value_or(0)))),
+      });
+    }
+  }
+
+  [[nodiscard]] nlohmann::json make_multitouch_extension_variables_message() const {
+    return nlohmann::json{
+        {"operation_type", operation_type::multitouch_extension_variables},
+        {"multitouch_extension_variables", multitouch_extension_variables_},
+    };
+  }
+
+  void send_multitouch_extension_variables_to_observers() {
+    if (multitouch_extension_variables_observer_peer_ids_.empty()) {
+      return;
+    }
+
+    auto message = make_multitouch_extension_variables_message();
+    for (const auto& peer_id : multitouch_extension_variables_observer_peer_ids_) {
+      async_request(peer_id,
+                    message);
+    }
+  }
+
+  void post_multitouch_extension_variables(multitouch_extension_variables::changed_mask_t changed_mask) {
+    if (device_grabber_) {
+      const auto& values = multitouch_extension_variables_.get_values();
+
+      std::vector<manipulator_environment_variable_set_variable> set_variables;
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (changed_mask & (1 << i)) {
+          set_variables.emplace_back(multitouch_extension_variables::names[i],
+                                     manipulator_environment_variable_value(static_cast<int64_t>(values[i])),
+                                     nullptr,
+                                     std::nullopt,
+                                     nullptr);
+        }
+      }
+      device_grabber_->async_post_set_variables_event(set_variables);
     }
   }
 
@@ -767,37 +841,25 @@ private:
   }
 
   void clear_multitouch_extension_environment_variables() {
+    if (multitouch_extension_variables_ != multitouch_extension_variables()) {
+      multitouch_extension_variables_ = multitouch_extension_variables();
+      send_multitouch_extension_variables_to_observers();
+    }
+
     if (device_grabber_) {
-      for (const auto& name : multitouch_extension_environment_variable_names) {
-        device_grabber_->async_post_set_variable_event(
-            manipulator_environment_variable_set_variable(
-                name,
-                std::nullopt,
-                nullptr,
-                std::nullopt,
-                nullptr,
-                manipulator_environment_variable_set_variable::type::unset));
+      std::vector<manipulator_environment_variable_set_variable> values;
+      for (const auto& name : multitouch_extension_variables::names) {
+        values.emplace_back(name,
+                            std::nullopt,
+                            nullptr,
+                            std::nullopt,
+                            nullptr,
+                            manipulator_environment_variable_set_variable::type::unset);
       }
+      device_grabber_->async_post_set_variables_event(values);
     }
   }
 
-  static constexpr std::array multitouch_extension_environment_variable_names{
-      "multitouch_extension_finger_count_upper_quarter_area",
-      "multitouch_extension_finger_count_lower_quarter_area",
-      "multitouch_extension_finger_count_left_quarter_area",
-      "multitouch_extension_finger_count_right_quarter_area",
-      "multitouch_extension_finger_count_upper_half_area",
-      "multitouch_extension_finger_count_lower_half_area",
-      "multitouch_extension_finger_count_left_half_area",
-      "multitouch_extension_finger_count_right_half_area",
-      "multitouch_extension_finger_count_total",
-      "multitouch_extension_palm_count_upper_half_area",
-      "multitouch_extension_palm_count_lower_half_area",
-      "multitouch_extension_palm_count_left_half_area",
-      "multitouch_extension_palm_count_right_half_area",
-      "multitouch_extension_palm_count_total",
-  };
-
   std::optional<uid_t> current_console_user_id_;
   std::weak_ptr<core_service_daemon_state_manager> weak_core_service_daemon_state_manager_;
   nod::scoped_connection core_service_daemon_state_manager_connection_;
@@ -813,10 +875,12 @@ private:
   std::unordered_set<pqrs::unix_domain_stream::peer_id> temporarily_ignore_all_devices_peer_ids_;
   std::unordered_set<pqrs::unix_domain_stream::peer_id> connected_devices_observer_peer_ids_;
   std::unordered_set<pqrs::unix_domain_stream::peer_id> notification_message_observer_peer_ids_;
+  std::unordered_set<pqrs::unix_domain_stream::peer_id> multitouch_extension_variables_observer_peer_ids_;
 
   pqrs::osx::system_preferences::properties system_preferences_properties_;
   application frontmost_application_;
   focused_ui_element focused_ui_element_;
   pqrs::osx::input_source::properties input_source_properties_;
+  multitouch_extension_variables multitouch_extension_variables_;
 };
 } // namespace krbn::core_service::daemon
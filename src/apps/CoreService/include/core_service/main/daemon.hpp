@@ -6,6 +6,7 @@
 #include "core_service/core_service_utility.hpp"
 #include "core_service/daemon/components_manager.hpp"
 #include "core_service/daemon/core_service_daemon_state_manager.hpp"
+#include "eval_js_cache.hpp"
 #include "filesystem_utility.hpp"
 #include "karabiner_version.h"
 #include "logger.hpp"
@@ -90,6 +91,13 @@ int daemon() {
 
   filesystem_utility::prepare_system_directories(std::nullopt);
 
+  //
+  // Enable eval_js_cache
+  //
+
+  initialize_shared_eval_js_cache(constants::get_rootonly_eval_js_cache_directory(),
+                                  karabiner_version);
+
   //
   // Run process_lifecycle_manager
   //
@@ -122,6 +130,8 @@ int daemon() {
 
   process_lifecycle_manager::terminate_shared_instance();
 
+  terminate_shared_eval_js_cache();
+
   //
   // Cleanup
   //
@@ -87,7 +87,7 @@ public:
 
       monitor->values_arrived.connect([this, device_id](auto&& values) {
         handle_hid_values(device_id,
-                          *values);
+                          values);
       });
 
       monitor->async_start(kIOHIDOptionsTypeNone,
@@ -6,11 +6,23 @@
 #include "run_loop_thread_utility.hpp"
 #include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace {
 std::atomic<krbn_core_service_connected_changed_callback> connected_changed_callback;
 std::shared_ptr<krbn::core_service_daemon_client> core_service_daemon_client;
 
+// The variables sent last time.
+// Only the changed variables are sent to core_service (daemon).
+std::mutex last_sent_variables_mutex;
+std::optional<krbn::multitouch_extension_variables> last_sent_variables;
+
+void reset_last_sent_variables() {
+  // Send all variables in the next message since the daemon clears them when the connection is closed.
+  std::lock_guard<std::mutex> lock(last_sent_variables_mutex);
+  last_sent_variables = std::nullopt;
+}
+
 void notify_connected_changed(bool value) {
   if (auto callback = connected_changed_callback.load()) {
     callback(value);
@@ -27,6 +39,7 @@ public:
     std::atomic_store(&core_service_daemon_client, client_);
 
     client_->connected.connect([this] {
+      reset_last_sent_variables();
       client_->async_connect_multitouch_extension();
       notify_connected_changed(true);
     });
@@ -36,6 +49,7 @@ public:
     });
 
     client_->closed.connect([] {
+      reset_last_sent_variables();
       notify_connected_changed(false);
     });
   }
@@ -96,22 +110,35 @@ void krbn_finalize(void) {
 
 bool krbn_core_service_async_set_variables(krbn_multitouch_extension_variables variables) {
   if (auto client = std::atomic_load(&core_service_daemon_client)) {
-    client->async_set_variables(nlohmann::json::object({
-        {"multitouch_extension_finger_count_upper_quarter_area", variables.finger_count_upper_quarter_area},
-        {"multitouch_extension_finger_count_lower_quarter_area", variables.finger_count_lower_quarter_area},
-        {"multitouch_extension_finger_count_left_quarter_area", variables.finger_count_left_quarter_area},
-        {"multitouch_extension_finger_count_right_quarter_area", variables.finger_count_right_quarter_area},
-        {"multitouch_extension_finger_count_upper_half_area", variables.finger_count_upper_half_area},
-        {"multitouch_extension_finger_count_lower_half_area", variables.finger_count_lower_half_area},
-        {"multitouch_extension_finger_count_left_half_area", variables.finger_count_left_half_area},
-        {"multitouch_extension_finger_count_right_half_area", variables.finger_count_right_half_area},
-        {"multitouch_extension_finger_count_total", variables.finger_count_total},
-        {"multitouch_extension_palm_count_upper_half_area", variables.palm_count_upper_half_area},
-        {"multitouch_extension_palm_count_lower_half_area", variables.palm_count_lower_half_area},
-        {"multitouch_extension_palm_count_left_half_area", variables.palm_count_left_half_area},
-        {"multitouch_extension_palm_count_right_half_area", variables.palm_count_right_half_area},
-        {"multitouch_extension_palm_count_total", variables.palm_count_total},
-    }));
+    krbn::multitouch_extension_variables v({
+        variables.finger_count_upper_quarter_area,
+        variables.finger_count_lower_quarter_area,
+        variables.finger_count_left_quarter_area,
+        variables.finger_count_right_quarter_area,
+        variables.finger_count_upper_half_area,
+        variables.finger_count_lower_half_area,
+        variables.finger_count_left_half_area,
+        variables.finger_count_right_half_area,
+        variables.finger_count_total,
+        variables.palm_count_upper_half_area,
+        variables.palm_count_lower_half_area,
+        variables.palm_count_left_half_area,
+        variables.palm_count_right_half_area,
+        variables.palm_count_total,
+    });
+
+    krbn::multitouch_extension_variables::changed_mask_t changed_mask;
+    {
+      std::lock_guard<std::mutex> lock(last_sent_variables_mutex);
+
+      changed_mask = last_sent_variables ? last_sent_variables->make_changed_mask(v)
+                                         : krbn::multitouch_extension_variables::all_mask;
+      last_sent_variables = v;
+    }
+
+    if (changed_mask != 0) {
+      client->async_set_multitouch_extension_variables(v.make_message(changed_mask));
+    }
 
     return true;
   }
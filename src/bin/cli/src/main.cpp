@@ -10,6 +10,7 @@
 #include "dispatcher_utility.hpp"
 #include "duktape_utility.hpp"
 #include "environment_variable_utility.hpp"
+#include "eval_js_cache.hpp"
 #include "filesystem_utility.hpp"
 #include "json_utility.hpp"
 #include "karabiner_version.h"
@@ -230,6 +231,80 @@ void set_variables(const std::string& variables) {
   }
 }
 
+void set_latency_trace_enabled(bool value) {
+  try {
+    auto wait = pqrs::make_thread_wait();
+
+    krbn::core_service_daemon_client client;
+    client.connect_failed.connect([wait](auto&& error_code) {
+      std::cerr << "set-latency-trace-enabled error:" << error_code << std::endl;
+      wait->notify();
+    });
+    client.connected.connect([&client, value, wait] {
+      client.async_set_latency_trace_enabled_with_completion_handler(
+          value,
+          [wait](auto&&) {
+            wait->notify();
+          });
+    });
+
+    client.async_start();
+
+    wait->wait_notice();
+  } catch (std::exception& e) {
+    std::cerr << "set-latency-trace-enabled error:" << std::endl
+              << e.what() << std::endl;
+  }
+}
+
+void show_latency_trace() {
+  try {
+    auto wait = pqrs::make_thread_wait();
+
+    krbn::core_service_daemon_client client;
+
+    client.connect_failed.connect([&wait](auto&& error_code) {
+      std::cerr << "show-latency-trace error:" << error_code << std::endl;
+      wait->notify();
+    });
+
+    client.connected.connect([&client] {
+      client.async_get_latency_trace();
+    });
+
+    client.received.connect([&wait](auto&& operation_type,
+                                    auto&& json) {
+      try {
+        switch (operation_type) {
+          case krbn::operation_type::latency_trace: {
+            auto& latency_trace = json.at("latency_trace");
+            if (latency_trace.is_null()) {
+              std::cerr << "latency trace is disabled. (Enable it by --set-latency-trace-enabled true)" << std::endl;
+            } else {
+              std::cout << krbn::json_utility::dump(latency_trace) << std::endl;
+            }
+            wait->notify();
+            break;
+          }
+
+          default:
+            break;
+        }
+      } catch (std::exception& e) {
+        std::cerr << "show-latency-trace error:" << std::endl
+                  << e.what() << std::endl;
+      }
+    });
+
+    client.async_start();
+
+    wait->wait_notice();
+  } catch (std::exception& e) {
+    std::cerr << "show-latency-trace error:" << std::endl
+              << e.what() << std::endl;
+  }
+}
+
 int copy_current_profile_to_system_default_profile() {
   if (!krbn::filesystem_utility::create_directories(krbn::constants::get_system_configuration_directory())) {
     return 1;
@@ -270,6 +345,24 @@ int remove_system_default_profile() {
   return 0;
 }
 
+void clear_eval_js_cache() {
+  std::vector<std::filesystem::path> directories{
+      krbn::constants::get_user_eval_js_cache_directory(),
+  };
+  // The cache of Karabiner-Core-Service is in the root-only directory.
+  if (geteuid() == 0) {
+    directories.push_back(krbn::constants::get_rootonly_eval_js_cache_directory());
+  }
+
+  for (const auto& d : directories) {
+    if (!d.empty()) {
+      krbn::eval_js_cache cache(d, karabiner_version);
+      auto count = cache.clear();
+      std::cout << fmt::format("{0}: {1} files are removed.", d.string(), count) << std::endl;
+    }
+  }
+}
+
 void show_settings_window_guidance() {
   try {
     auto wait = pqrs::make_thread_wait();
@@ -336,6 +429,16 @@ int main(int argc, char** argv) {
   krbn::logger::set_stdout_color_logger("karabiner_cli",
                                         "[%l] %v");
 
+  //
+  // Enable eval_js_cache
+  //
+
+  // Do not create files owned by root in the user directory.
+  if (geteuid() != 0) {
+    krbn::initialize_shared_eval_js_cache(krbn::constants::get_user_eval_js_cache_directory(),
+                                          karabiner_version);
+  }
+
   //
   // Setup options
   //
@@ -363,8 +466,8 @@ int main(int argc, char** argv) {
 
   options.add_options()("watch-multitouch-extension-variables",
                         "Watch multitouch extension variables and print all of them in one line whenever any variable changes",
-                        cxxopts::value<int>()->implicit_value("500"),
-                        "polling-interval-in-milliseconds");
+                        cxxopts::value<int>()->implicit_value("0"),
+                        "unused (accepted for compatibility with the former polling interval)");
 
   options.add_options()("set-variables",
                         "Json string: {[key: string]: number|boolean|string}",
@@ -373,6 +476,14 @@ int main(int argc, char** argv) {
   options.add_options()("set-variables-from-stdin",
                         "Read one variables JSON object per line from stdin");
 
+  options.add_options()("set-latency-trace-enabled",
+                        "Enable or disable the per-keystroke latency trace in the manipulation pipeline",
+                        cxxopts::value<bool>(),
+                        "true|false");
+
+  options.add_options()("show-latency-trace",
+                        "Show p50/p99/max latency of each manipulation stage");
+
   options.add_options()("copy-current-profile-to-system-default-profile",
                         "Copy the current profile to system default profile");
 
@@ -402,6 +513,9 @@ int main(int argc, char** argv) {
                         cxxopts::value<std::string>(),
                         "file");
 
+  options.add_options()("clear-eval-js-cache",
+                        "Remove cached results of eval_js rules (The cache of Karabiner-Core-Service is also removed when run as root)");
+
   options.add_options()("version",
                         "Displays version");
 
@@ -487,7 +601,7 @@ int main(int argc, char** argv) {
     {
       std::string key = "watch-multitouch-extension-variables";
       if (parse_result.count(key)) {
-        exit_code = krbn::cli::watch_multitouch_extension_variables::run(parse_result[key].as<int>());
+        exit_code = krbn::cli::watch_multitouch_extension_variables::run();
         goto finish;
       }
     }
@@ -510,6 +624,22 @@ int main(int argc, char** argv) {
       }
     }
 
+    {
+      std::string key = "set-latency-trace-enabled";
+      if (parse_result.count(key)) {
+        set_latency_trace_enabled(parse_result[key].as<bool>());
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "show-latency-trace";
+      if (parse_result.count(key)) {
+        show_latency_trace();
+        goto finish;
+      }
+    }
+
     {
       std::string key = "copy-current-profile-to-system-default-profile";
       if (parse_result.count(key)) {
@@ -666,6 +796,14 @@ int main(int argc, char** argv) {
       }
     }
 
+    {
+      std::string key = "clear-eval-js-cache";
+      if (parse_result.count(key)) {
+        clear_eval_js_cache();
+        goto finish;
+      }
+    }
+
     {
       std::string key = "version";
       if (parse_result.count(key)) {
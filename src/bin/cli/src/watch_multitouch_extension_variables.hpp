@@ -13,25 +13,12 @@ class components_manager final : public pqrs::dispatcher::extra::dispatcher_clie
 public:
   components_manager(const components_manager&) = delete;
 
-  explicit components_manager(int interval)
+  components_manager()
       : dispatcher_client(),
-        interval_(interval),
-        client_(std::make_unique<core_service_daemon_client>()),
-        timer_(*this) {
+        client_(std::make_unique<core_service_daemon_client>()) {
     client_->connected.connect([this] {
-      timer_.start(
-          [this] {
-            client_->async_get_multitouch_extension_variables();
-          },
-          std::chrono::milliseconds(interval_));
-    });
-
-    client_->connect_failed.connect([this](auto&&) {
-      timer_.stop();
-    });
-
-    client_->closed.connect([this] {
-      timer_.stop();
+      // core_service (daemon) sends the variables whenever they are changed.
+      client_->async_observe_multitouch_extension_variables();
     });
 
     client_->received.connect([this](auto&& operation_type,
@@ -59,7 +46,6 @@ public:
 
   ~components_manager() override {
     detach_from_dispatcher([this] {
-      timer_.stop();
       client_ = nullptr;
     });
   }
@@ -69,20 +55,19 @@ public:
   }
 
 private:
-  int interval_;
   std::string output_json_string_;
   std::unique_ptr<core_service_daemon_client> client_;
-  pqrs::dispatcher::extra::timer timer_;
 };
-inline int run(int interval) {
+
+inline int run() {
   auto termination_wait = pqrs::make_thread_wait();
   std::atomic_int termination_signal{0};
 
   process_lifecycle_manager::initialize_shared_instance(
       process_lifecycle_manager::configuration{
           .components_manager_maker =
-              [interval] {
-                return std::make_unique<components_manager>(interval);
+              [] {
+                return std::make_unique<components_manager>();
               },
           .termination_completion_handler = [termination_wait] { termination_wait->notify(); },
       });
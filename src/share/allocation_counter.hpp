@@ -0,0 +1,36 @@
+#pragma once
+
+// Replace the global operator new and operator delete to count heap allocations.
+// This header is for benchmarks and tests (e.g., appendix/benchmark_replay, tests/src/event_queue_allocation).
+// Do not include it from the apps.
+// Include this header from only one translation unit of a program since the replacement functions cannot be inline.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace krbn::allocation_counter {
+inline std::atomic<uint64_t> count(0);
+
+// The number of calls of operator new since the program started.
+inline uint64_t get_count() {
+  return count.load(std::memory_order_relaxed);
+}
+} // namespace krbn::allocation_counter
+
+void* operator new(std::size_t size) {
+  krbn::allocation_counter::count.fetch_add(1, std::memory_order_relaxed);
+  if (auto p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
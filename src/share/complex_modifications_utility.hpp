@@ -5,8 +5,10 @@
 #include "filesystem_utility.hpp"
 #include "json_utility.hpp"
 #include "json_writer.hpp"
+#include "logger.hpp"
 #include "manipulator/condition_factory.hpp"
 #include "manipulator/manipulator_factory.hpp"
+#include "manipulator/manipulator_manager.hpp"
 
 namespace krbn::complex_modifications_utility {
 inline std::vector<std::string> lint_rule(const core_configuration::details::complex_modifications_rule& rule) {
@@ -30,6 +32,53 @@ inline std::vector<std::string> lint_rule(const core_configuration::details::com
   return error_messages;
 }
 
+// Update `manipulator_manager` with the manipulators of the enabled rules.
+// Manipulators whose content is not changed since the last update are reused with their state,
+// and only added or changed manipulators are built.
+//
+// Returns the number of reused manipulators.
+inline size_t update_manipulators(manipulator::manipulator_manager& manipulator_manager,
+                                  const core_configuration::details::complex_modifications& complex_modifications) {
+  std::vector<const core_configuration::details::complex_modifications_rule::manipulator*> manipulators;
+  std::vector<manipulator::manipulator_manager::manipulator_content> contents;
+
+  for (const auto& rule : complex_modifications.get_rules()) {
+    if (!rule->get_enabled()) {
+      continue;
+    }
+
+    for (const auto& m : rule->get_manipulators()) {
+      manipulators.push_back(m.get().get());
+      // The parameters can be changed after the manipulator is created, so they are resolved here.
+      contents.emplace_back(m->to_json(),
+                            m->get_parameters()->to_json());
+    }
+  }
+
+  return manipulator_manager.update_manipulators(
+      std::move(contents),
+      [&](size_t index) -> std::shared_ptr<manipulator::manipulators::base> {
+        const auto& m = *(manipulators[index]);
+
+        try {
+          auto result = manipulator::manipulator_factory::make_manipulator(m.to_json(),
+                                                                           m.get_parameters());
+          for (const auto& c : m.get_conditions()) {
+            result->push_back_condition(manipulator::condition_factory::make_condition(c.get_json()));
+          }
+          return result;
+
+        } catch (const pqrs::json::unmarshal_error& e) {
+          logger::get_logger()->error(fmt::format("karabiner.json error: {0}", e.what()));
+
+        } catch (const std::exception& e) {
+          logger::get_logger()->error(e.what());
+        }
+
+        return nullptr;
+      });
+}
+
 [[nodiscard]] inline std::string get_new_rule_json_string() {
   nlohmann::json json({{"description", "New Rule"},
                        {"description_notes", nlohmann::json::array({
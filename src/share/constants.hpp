@@ -56,6 +56,11 @@ public:
     return path;
   }
 
+  [[nodiscard]] static const std::filesystem::path& get_rootonly_eval_js_cache_directory() {
+    static auto path = get_rootonly_directory() / "eval_js_cache";
+    return path;
+  }
+
   [[nodiscard]] static const std::filesystem::path& get_system_user_directory() {
     static auto path = get_tmp_directory() / "user";
     return path;
@@ -258,6 +263,24 @@ public:
     return directory;
   }
 
+  [[nodiscard]] static const std::filesystem::path& get_user_eval_js_cache_directory() {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> guard(mutex);
+
+    static bool once = false;
+    static std::filesystem::path directory;
+
+    if (!once) {
+      once = true;
+      auto d = get_user_data_directory();
+      if (!d.empty()) {
+        directory = d / "eval_js_cache";
+      }
+    }
+
+    return directory;
+  }
+
   [[nodiscard]] static const karabiner_machine_identifier& get_karabiner_machine_identifier() {
     static std::mutex mutex;
     std::lock_guard<std::mutex> guard(mutex);
@@ -9,6 +9,7 @@
 #include "details/profile/device.hpp"
 #include "details/profile/simple_modifications.hpp"
 #include "details/profile/virtual_hid_keyboard.hpp"
+#include "eval_js_cache.hpp"
 #include "filesystem_utility.hpp"
 #include "json_utility.hpp"
 #include "json_writer.hpp"
@@ -54,6 +55,14 @@ public:
     other_error,
   };
 
+  // The size and the hash of the file body which the configuration is loaded from.
+  struct file_digest final {
+    size_t size;
+    size_t hash;
+
+    bool operator==(const file_digest&) const = default;
+  };
+
   core_configuration(const core_configuration&) = delete;
 
   core_configuration()
@@ -69,6 +78,7 @@ public:
         error_handling_(error_handling),
         load_state_(load_state::loaded),
         source_(source::default_configuration),
+        json_hash_(0),
         global_configuration_(std::make_shared<details::global_configuration>(nlohmann::json::object(),
                                                                               error_handling)),
         machine_specific_(std::make_shared<details::machine_specific>(nlohmann::json::object(),
@@ -119,11 +129,33 @@ public:
         std::ifstream input(file_path);
         if (input) {
           try {
-            json_ = json_utility::parse_jsonc(input);
+            std::string body(std::istreambuf_iterator<char>(input), {});
+            file_digest_ = file_digest{
+                .size = body.size(),
+                .hash = std::hash<std::string>{}(body),
+            };
+
+            json_ = json_utility::parse_jsonc(body);
+
+            auto eval_js_cache = get_shared_eval_js_cache();
+            auto eval_js_cache_hit_count = eval_js_cache ? eval_js_cache->get_hit_count() : 0;
+            auto eval_js_cache_miss_count = eval_js_cache ? eval_js_cache->get_miss_count() : 0;
 
             helper_values_.update_value(json_,
                                         error_handling);
 
+            if (eval_js_cache) {
+              auto hit_count = eval_js_cache->get_hit_count() - eval_js_cache_hit_count;
+              auto miss_count = eval_js_cache->get_miss_count() - eval_js_cache_miss_count;
+              if (hit_count > 0 || miss_count > 0) {
+                logger::get_logger()->info("eval_js cache: {0} hits, {1} misses (total: {2} hits, {3} misses)",
+                                           hit_count,
+                                           miss_count,
+                                           eval_js_cache->get_hit_count(),
+                                           eval_js_cache->get_miss_count());
+              }
+            }
+
             load_state_ = load_state::loaded;
             source_ = file_path == constants::get_system_core_configuration_file_path().string()
                           ? source::system_file
@@ -154,6 +186,8 @@ public:
                                                              }),
                                                              error_handling_));
     }
+
+    json_hash_ = std::hash<nlohmann::json>{}(json_);
   }
 
   nlohmann::json to_json() const {
@@ -176,6 +210,23 @@ public:
     return parse_error_message_;
   }
 
+  // The digest of the loaded file. (std::nullopt if the configuration is not loaded from a file.)
+  [[nodiscard]] const std::optional<file_digest>& get_file_digest() const {
+    return file_digest_;
+  }
+
+  // The hash of the json which the configuration is loaded from or saved to.
+  [[nodiscard]] size_t get_json_hash() const {
+    return json_hash_;
+  }
+
+  // Return true if both configurations are loaded from or saved to the same json.
+  // The hashes are compared first and the json is compared only when the hashes match.
+  [[nodiscard]] bool has_same_json(const core_configuration& other) const {
+    return json_hash_ == other.json_hash_ &&
+           json_ == other.json_;
+  }
+
   [[nodiscard]] const details::global_configuration& get_global_configuration() const {
     return *global_configuration_;
   }
@@ -267,10 +318,15 @@ public:
     remove_old_backup_files();
 
     auto file_path = constants::get_user_core_configuration_file_path();
-    json_writer::save_to_file(to_json(),
+    auto json = to_json();
+    json_writer::save_to_file(json,
                               file_path,
                               user_core_configuration_file_mode);
 
+    // The saved file will be loaded with the same json.
+    json_ = std::move(json);
+    json_hash_ = std::hash<nlohmann::json>{}(json_);
+
     load_state_ = load_state::loaded;
     source_ = source::user_file;
   }
@@ -354,6 +410,8 @@ private:
   load_state load_state_;
   source source_;
   std::string parse_error_message_;
+  std::optional<file_digest> file_digest_;
+  size_t json_hash_;
 
   pqrs::not_null_shared_ptr_t<details::global_configuration> global_configuration_;
   pqrs::not_null_shared_ptr_t<details::machine_specific> machine_specific_;
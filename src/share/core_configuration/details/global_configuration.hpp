@@ -63,6 +63,11 @@ public:
                                          filter_useless_events_from_specific_devices_,
                                          true);
 
+    // 0 disables the automatic activation of the unchanged HID values filter.
+    helper_values_.push_back_value<int>("filter_unchanged_hid_values_auto_enable_values_per_second",
+                                        filter_unchanged_hid_values_auto_enable_values_per_second_,
+                                        0);
+
     helper_values_.push_back_value<bool>("reorder_same_timestamp_input_events_to_prioritize_modifiers",
                                          reorder_same_timestamp_input_events_to_prioritize_modifiers_,
                                          true);
@@ -75,6 +80,15 @@ public:
                                         delay_milliseconds_before_sleep_shortcut_,
                                         500);
 
+    helper_values_.push_back_value<bool>("coalesce_pointing_motion",
+                                         coalesce_pointing_motion_,
+                                         false);
+
+    // The number of prewarmed shells for `shell_command`. 0 runs `/bin/sh -c` for each command.
+    helper_values_.push_back_value<int>("shell_command_worker_count",
+                                        shell_command_worker_count_,
+                                        0);
+
     pqrs::json::requires_object(json, "json");
 
     if (!json_.contains("check_for_updates") &&
@@ -89,6 +103,8 @@ public:
     set_notification_window_position(notification_window_position_);
     set_notification_window_font_size(notification_window_font_size_);
     set_delay_milliseconds_before_sleep_shortcut(delay_milliseconds_before_sleep_shortcut_);
+    set_filter_unchanged_hid_values_auto_enable_values_per_second(filter_unchanged_hid_values_auto_enable_values_per_second_);
+    set_shell_command_worker_count(shell_command_worker_count_);
   }
 
   nlohmann::json to_json() const {
@@ -187,6 +203,13 @@ public:
     filter_useless_events_from_specific_devices_ = value;
   }
 
+  [[nodiscard]] const int& get_filter_unchanged_hid_values_auto_enable_values_per_second() const {
+    return filter_unchanged_hid_values_auto_enable_values_per_second_;
+  }
+  void set_filter_unchanged_hid_values_auto_enable_values_per_second(int value) {
+    filter_unchanged_hid_values_auto_enable_values_per_second_ = std::max(0, value);
+  }
+
   [[nodiscard]] const bool& get_reorder_same_timestamp_input_events_to_prioritize_modifiers() const {
     return reorder_same_timestamp_input_events_to_prioritize_modifiers_;
   }
@@ -208,6 +231,20 @@ public:
     delay_milliseconds_before_sleep_shortcut_ = std::clamp(value, 0, 10000);
   }
 
+  [[nodiscard]] const bool& get_coalesce_pointing_motion() const {
+    return coalesce_pointing_motion_;
+  }
+  void set_coalesce_pointing_motion(bool value) {
+    coalesce_pointing_motion_ = value;
+  }
+
+  [[nodiscard]] const int& get_shell_command_worker_count() const {
+    return shell_command_worker_count_;
+  }
+  void set_shell_command_worker_count(int value) {
+    shell_command_worker_count_ = std::clamp(value, 0, 8);
+  }
+
 private:
   nlohmann::json json_;
   bool check_for_updates_;
@@ -222,9 +259,12 @@ private:
   pqrs::not_null_shared_ptr_t<notification_window_colors> notification_window_colors_;
   bool unsafe_ui_;
   bool filter_useless_events_from_specific_devices_;
+  int filter_unchanged_hid_values_auto_enable_values_per_second_;
   bool reorder_same_timestamp_input_events_to_prioritize_modifiers_;
   bool enable_cgeventtap_fallback_;
   int delay_milliseconds_before_sleep_shortcut_;
+  bool coalesce_pointing_motion_;
+  int shell_command_worker_count_;
   configuration_json_helper::helper_values helper_values_;
 };
 
@@ -8,6 +8,7 @@
 #include "profile/simple_modifications.hpp"
 #include "profile/virtual_hid_keyboard.hpp"
 #include <pqrs/json.hpp>
+#include <unordered_map>
 
 namespace krbn::core_configuration::details {
 class profile final {
@@ -65,6 +66,8 @@ public:
 
     helper_values_.update_value(json, error_handling);
 
+    update_devices_index();
+
     for (const auto& [key, value] : json.items()) {
       if (key == "simple_modifications") {
         try {
@@ -233,18 +236,16 @@ public:
     return devices_;
   }
 
+  // Return the device for `identifiers`.
+  // A new device entry is added into `devices_` if `identifiers` is not found.
+  // Use `find_device` or `find_device_or_default` in the event path to avoid modifying the configuration.
   [[nodiscard]] pqrs::not_null_shared_ptr_t<details::device> get_device(const device_identifiers& identifiers) const {
     //
     // Find device
     //
 
-    auto it = std::find_if(std::begin(devices_),
-                           std::end(devices_),
-                           [&](auto&& d) {
-                             return d->get_identifiers() == identifiers;
-                           });
-    if (it != std::end(devices_)) {
-      return *it;
+    if (auto it = devices_index_.find(identifiers); it != std::end(devices_index_)) {
+      return it->second;
     }
 
     //
@@ -259,9 +260,34 @@ public:
                                                       return make_device_default_values(identifiers);
                                                     });
     devices_.push_back(device);
+    devices_index_.emplace(identifiers, device);
     return devices_.back();
   }
 
+  // Return the device for `identifiers` or nullptr if the device is not configured.
+  [[nodiscard]] std::shared_ptr<const details::device> find_device(const device_identifiers& identifiers) const {
+    if (auto it = devices_index_.find(identifiers); it != std::end(devices_index_)) {
+      return it->second.get();
+    }
+    return nullptr;
+  }
+
+  // Return the device for `identifiers`.
+  // If the device is not configured, a new device which has the default values is returned without adding it into `devices_`.
+  [[nodiscard]] pqrs::not_null_shared_ptr_t<const details::device> find_device_or_default(const device_identifiers& identifiers) const {
+    if (auto it = devices_index_.find(identifiers); it != std::end(devices_index_)) {
+      return it->second;
+    }
+
+    return std::make_shared<const details::device>(nlohmann::json({
+                                                       {"identifiers", identifiers},
+                                                   }),
+                                                   error_handling_,
+                                                   [this](const auto& identifiers) {
+                                                     return make_device_default_values(identifiers);
+                                                   });
+  }
+
   [[nodiscard]] size_t not_connected_configured_devices_count(const connected_devices& connected_devices) const {
     return std::count_if(std::begin(devices_),
                          std::end(devices_),
@@ -279,6 +305,8 @@ public:
                                            !d->to_json().empty();
                                   }),
                    std::end(devices_));
+
+    update_devices_index();
   }
 
 private:
@@ -293,8 +321,20 @@ private:
   pqrs::not_null_shared_ptr_t<details::complex_modifications> complex_modifications_;
   pqrs::not_null_shared_ptr_t<details::virtual_hid_keyboard> virtual_hid_keyboard_;
   mutable std::vector<pqrs::not_null_shared_ptr_t<details::device>> devices_;
+  // The index of `devices_` for lookups by device_identifiers.
+  mutable std::unordered_map<device_identifiers, pqrs::not_null_shared_ptr_t<details::device>> devices_index_;
   configuration_json_helper::helper_values helper_values_;
 
+  void update_devices_index() {
+    devices_index_.clear();
+    devices_index_.reserve(devices_.size());
+
+    for (const auto& d : devices_) {
+      // Keep the first entry if `devices_` contains duplicated identifiers.
+      devices_index_.emplace(d->get_identifiers(), d);
+    }
+  }
+
   void update_devices_default_values() const {
     for (const auto& device : devices_) {
       update_device_default_values(*device);
@@ -29,10 +29,16 @@ public:
     // Load rules_
 
     if (auto v = pqrs::json::find_array(json, "rules")) {
-      for (const auto& j : v->value()) {
-        rules_.push_back(std::make_shared<complex_modifications_rule>(j,
+      // `eval_js` is evaluated in parallel, then rules are created in order
+      // so that the reported error is the same as the serial loading.
+      auto eval_js_results = complex_modifications_rule::evaluate_eval_js(v->value());
+
+      for (size_t i = 0; i < v->value().size(); ++i) {
+        const auto& r = eval_js_results[i];
+        rules_.push_back(std::make_shared<complex_modifications_rule>(v->value()[i],
                                                                       parameters_,
-                                                                      error_handling));
+                                                                      error_handling,
+                                                                      r ? &(*r) : nullptr));
       }
     }
   }
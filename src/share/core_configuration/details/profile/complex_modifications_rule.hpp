@@ -2,7 +2,10 @@
 
 #include "complex_modifications_parameters.hpp"
 #include "duktape_utility.hpp"
+#include "eval_js_cache.hpp"
 #include "json_utility.hpp"
+#include "parallel_utility.hpp"
+#include <optional>
 #include <pqrs/json.hpp>
 
 namespace krbn::core_configuration::details {
@@ -13,6 +16,13 @@ public:
     javascript,
   };
 
+  // The result of `eval_js` evaluated before the rule is created.
+  struct eval_js_result final {
+    // The evaluated json. (std::nullopt if the evaluation failed.)
+    std::optional<nlohmann::json> json;
+    std::string error_message;
+  };
+
   class manipulator {
   public:
     class condition {
@@ -87,10 +97,11 @@ public:
 
   complex_modifications_rule(const nlohmann::json& json,
                              pqrs::not_null_shared_ptr_t<const core_configuration::details::complex_modifications_parameters> parameters,
-                             error_handling error_handling)
+                             error_handling error_handling,
+                             const eval_js_result* evaluated_eval_js = nullptr)
       : json_(json),
         code_type_(code_type::json) {
-    auto resolved_json = resolve_code(json, error_handling);
+    auto resolved_json = resolve_code(json, evaluated_eval_js);
 
     helper_values_.push_back_value<bool>("enabled",
                                          enabled_,
@@ -172,6 +183,47 @@ public:
         error_handling);
   }
 
+  // Evaluate `eval_js` of the rules on worker threads.
+  // Each Duktape heap is independent, so the rules can be evaluated concurrently.
+  // The results are stored in the same order as `rules_json`, and std::nullopt is stored for rules without `eval_js`.
+  static std::vector<std::optional<eval_js_result>> evaluate_eval_js(const nlohmann::json& rules_json) {
+    std::vector<std::optional<eval_js_result>> results;
+    std::vector<std::pair<size_t, const std::string*>> codes;
+
+    if (rules_json.is_array()) {
+      results.resize(rules_json.size());
+
+      for (size_t i = 0; i < rules_json.size(); ++i) {
+        const auto& j = rules_json[i];
+        if (j.is_object()) {
+          if (auto it = j.find("eval_js"); it != std::end(j) && it->is_string()) {
+            codes.emplace_back(i, it->get_ptr<const std::string*>());
+          }
+        }
+      }
+    }
+
+    // Evaluation of a single rule is not worth a worker thread.
+    if (codes.size() < 2) {
+      return results;
+    }
+
+    parallel_utility::for_each_index(codes.size(), [&](size_t i) {
+      auto& [index, code] = codes[i];
+      eval_js_result r;
+
+      try {
+        r.json = eval_js(*code);
+      } catch (const std::exception& e) {
+        r.error_message = e.what();
+      }
+
+      results[index] = std::move(r);
+    });
+
+    return results;
+  }
+
   nlohmann::json to_json() const {
     auto j = json_;
 
@@ -223,8 +275,27 @@ private:
     }
   }
 
+  // Evaluate `eval_js` code, or return the cached result if the shared eval_js_cache is enabled.
+  static nlohmann::json eval_js(const std::string& code) {
+    auto cache = get_shared_eval_js_cache();
+    if (cache) {
+      if (auto json = cache->find(code)) {
+        return *json;
+      }
+    }
+
+    auto result = krbn::duktape_utility::eval_string_to_json(code);
+    result.json.erase("enabled");
+
+    if (cache) {
+      cache->save(code, result.json);
+    }
+
+    return result.json;
+  }
+
   nlohmann::json resolve_code(const nlohmann::json& json,
-                              error_handling error_handling) {
+                              const eval_js_result* evaluated_eval_js) {
     if (json.is_object() && json.contains("eval_js")) {
       const auto& value = json.at("eval_js");
       pqrs::json::requires_string(value, "`eval_js`");
@@ -233,10 +304,14 @@ private:
         code_type_ = code_type::javascript;
         code_string_ = value.get<std::string>();
 
-        auto result = krbn::duktape_utility::eval_string_to_json(code_string_);
-        result.json.erase("enabled");
+        if (evaluated_eval_js) {
+          if (evaluated_eval_js->json) {
+            return *(evaluated_eval_js->json);
+          }
+          throw duktape_eval_error(evaluated_eval_js->error_message);
+        }
 
-        return result.json;
+        return eval_js(code_string_);
       } catch (const std::exception& e) {
         throw pqrs::json::unmarshal_error(fmt::format("`eval_js` error: {0}", e.what()));
       }
@@ -3,6 +3,7 @@
 #include "../../configuration_json_helper.hpp"
 #include "exprtk_utility.hpp"
 #include "simple_modifications.hpp"
+#include <algorithm>
 #include <functional>
 #include <pqrs/string.hpp>
 #include <ranges>
@@ -122,6 +123,14 @@ public:
                                          mouse_discard_horizontal_wheel_,
                                          false);
 
+    helper_values_.push_back_value<bool>("filter_unchanged_hid_values",
+                                         filter_unchanged_hid_values_,
+                                         false);
+
+    helper_values_.push_back_value<int>("filter_unchanged_hid_values_dead_band",
+                                        filter_unchanged_hid_values_dead_band_,
+                                        0);
+
     helper_values_.push_back_value<bool>("game_pad_swap_sticks",
                                          game_pad_swap_sticks_,
                                          false);
@@ -252,6 +261,8 @@ cos(radian) * m;
 
     helper_values_.update_value(json, error_handling);
 
+    set_filter_unchanged_hid_values_dead_band(filter_unchanged_hid_values_dead_band_);
+
     if (auto it = json.find("ignore");
         it != std::end(json)) {
       try {
@@ -524,6 +535,24 @@ cos(radian) * m;
     coordinate_between_properties();
   }
 
+  [[nodiscard]] const bool& get_filter_unchanged_hid_values() const {
+    return filter_unchanged_hid_values_;
+  }
+  void set_filter_unchanged_hid_values(bool value) {
+    filter_unchanged_hid_values_ = value;
+
+    coordinate_between_properties();
+  }
+
+  [[nodiscard]] const int& get_filter_unchanged_hid_values_dead_band() const {
+    return filter_unchanged_hid_values_dead_band_;
+  }
+  void set_filter_unchanged_hid_values_dead_band(int value) {
+    filter_unchanged_hid_values_dead_band_ = std::max(0, value);
+
+    coordinate_between_properties();
+  }
+
   [[nodiscard]] const bool& get_game_pad_swap_sticks() const {
     return game_pad_swap_sticks_;
   }
@@ -741,6 +770,8 @@ private:
   bool mouse_discard_y_;
   bool mouse_discard_vertical_wheel_;
   bool mouse_discard_horizontal_wheel_;
+  bool filter_unchanged_hid_values_;
+  int filter_unchanged_hid_values_dead_band_;
   bool game_pad_swap_sticks_;
 
   double game_pad_xy_stick_deadzone_;
@@ -271,6 +271,45 @@ public:
     });
   }
 
+  void async_observe_multitouch_extension_variables() const {
+    enqueue_to_dispatcher([this] {
+      nlohmann::json json{
+          {"operation_type", operation_type::observe_multitouch_extension_variables},
+      };
+
+      async_request(std::move(json));
+    });
+  }
+
+  void async_set_latency_trace_enabled(bool value) const {
+    async_set_latency_trace_enabled_with_completion_handler(value,
+                                                            nullptr);
+  }
+
+  void async_set_latency_trace_enabled_with_completion_handler(
+      bool value,
+      std::function<void(const asio::error_code&)> completion_handler) const {
+    enqueue_to_dispatcher([this, value, completion_handler = std::move(completion_handler)] {
+      nlohmann::json json{
+          {"operation_type", operation_type::set_latency_trace_enabled},
+          {"value", value},
+      };
+
+      async_request(std::move(json),
+                    std::move(completion_handler));
+    });
+  }
+
+  void async_get_latency_trace() const {
+    enqueue_to_dispatcher([this] {
+      nlohmann::json json{
+          {"operation_type", operation_type::get_latency_trace},
+      };
+
+      async_request(std::move(json));
+    });
+  }
+
   void async_connect_multitouch_extension() const {
     enqueue_to_dispatcher([this] {
       nlohmann::json json{
@@ -311,6 +350,13 @@ public:
     });
   }
 
+  // `message` is made by `multitouch_extension_variables::make_message`.
+  void async_set_multitouch_extension_variables(std::vector<uint8_t>&& message) const {
+    enqueue_to_dispatcher([this, message = std::move(message)] {
+      async_request_buffer(message);
+    });
+  }
+
   void async_clear_user_variables() const {
     enqueue_to_dispatcher([this] {
       nlohmann::json json{
@@ -326,6 +372,12 @@ private:
 
   void async_request(nlohmann::json&& json,
                      request_completion_handler completion_handler = nullptr) const {
+    async_request_buffer(nlohmann::json::to_msgpack(json),
+                         std::move(completion_handler));
+  }
+
+  void async_request_buffer(const std::vector<uint8_t>& data,
+                            request_completion_handler completion_handler = nullptr) const {
     if (!client_) {
       if (completion_handler) {
         completion_handler(asio::error::not_connected);
@@ -336,7 +388,7 @@ private:
     // unix_domain_stream::client delivers this callback on the shared
     // dispatcher thread, so it does not need to be enqueued again here.
     client_->async_request(
-        nlohmann::json::to_msgpack(json),
+        data,
         [this, completion_handler = std::move(completion_handler)](auto&& error_code, auto&& buffer) {
           if (error_code) {
             logger::get_logger()->debug("core_service_daemon_client request failed: {0}", error_code.message());
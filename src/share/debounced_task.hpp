@@ -0,0 +1,91 @@
+#pragma once
+
+// `krbn::debounced_task` can be used safely in a multi-threaded environment.
+
+#include "timer_wheel.hpp"
+#include <cstdlib>
+#include <functional>
+#include <pqrs/dispatcher.hpp>
+
+namespace krbn {
+// A replacement of `pqrs::dispatcher::extra::debounced_task` which schedules functions with `krbn::timer_wheel`.
+//
+// `debounce_at` and `cancel` update the wheel directly instead of enqueueing functions to the dispatcher,
+// so re-arming a task does not allocate as long as `function` fits in std::function small buffer (e.g., `[this] {...}`).
+// If the shared timer_wheel is not initialized, the task falls back to the dispatcher like pqrs::dispatcher::extra::debounced_task.
+//
+// Usage Note:
+//
+// We must not destroy a debounced_task before dispatcher_client is detached.
+// (It causes that dispatcher might access the released debounced_task.)
+// debounced_task calls `abort` if you destroy debounced_task while
+// dispatcher_client is attached in order to avoid the above case.
+class debounced_task final {
+public:
+  debounced_task(const debounced_task&) = delete;
+
+  explicit debounced_task(pqrs::dispatcher::extra::dispatcher_client& dispatcher_client,
+                          std::weak_ptr<timer_wheel> weak_timer_wheel = get_shared_timer_wheel())
+      : dispatcher_client_(dispatcher_client),
+        weak_timer_wheel_(weak_timer_wheel),
+        entry_(dispatcher_client) {
+  }
+
+  ~debounced_task() {
+    if (dispatcher_client_.attached()) {
+      // Do not release debounced_task before `dispatcher_client_` is detached.
+      abort();
+    }
+
+    if (auto w = weak_timer_wheel_.lock()) {
+      w->cancel(entry_);
+    }
+  }
+
+  bool debounce_at(std::function<void()> function,
+                   pqrs::dispatcher::time_point when) {
+    if (auto w = weak_timer_wheel_.lock()) {
+      if (w->schedule(entry_, std::move(function), when)) {
+        return true;
+      }
+    }
+
+    // Fallback
+
+    auto generation = entry_.increment_generation();
+
+    if (!dispatcher_client_.enqueue_to_dispatcher(
+            [this, function = std::move(function), generation] {
+              if (entry_.get_generation() != generation) {
+                return;
+              }
+
+              function();
+            },
+            when)) {
+      entry_.increment_generation();
+      return false;
+    }
+
+    return true;
+  }
+
+  bool debounce_after(std::function<void()> function,
+                      pqrs::dispatcher::duration delay) {
+    return debounce_at(std::move(function), dispatcher_client_.when_now() + delay);
+  }
+
+  void cancel() {
+    if (auto w = weak_timer_wheel_.lock()) {
+      w->cancel(entry_);
+    } else {
+      entry_.increment_generation();
+    }
+  }
+
+private:
+  pqrs::dispatcher::extra::dispatcher_client& dispatcher_client_;
+  std::weak_ptr<timer_wheel> weak_timer_wheel_;
+  timer_wheel::entry entry_;
+};
+} // namespace krbn
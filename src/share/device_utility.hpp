@@ -10,7 +10,7 @@ inline bool determine_is_built_in_keyboard(const core_configuration::core_config
     return true;
   }
 
-  auto d = core_configuration.get_selected_profile().get_device(
+  auto d = core_configuration.get_selected_profile().find_device_or_default(
       device_properties.get_device_identifiers());
 
   return d->get_treat_as_built_in_keyboard();
@@ -2,6 +2,7 @@
 
 // `krbn::dispatcher_utility` can be used safely in a multi-threaded environment.
 
+#include "timer_wheel.hpp"
 #include <pqrs/dispatcher.hpp>
 #include <pqrs/gsl.hpp>
 
@@ -12,9 +13,11 @@ public:
   public:
     scoped_dispatcher_manager() {
       pqrs::dispatcher::extra::initialize_shared_dispatcher();
+      initialize_shared_timer_wheel();
     }
 
     ~scoped_dispatcher_manager() {
+      terminate_shared_timer_wheel();
       pqrs::dispatcher::extra::terminate_shared_dispatcher();
     }
   };
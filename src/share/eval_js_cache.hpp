@@ -0,0 +1,206 @@
+#pragma once
+
+#include "filesystem_utility.hpp"
+#include "json_utility.hpp"
+#include "json_writer.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <duktape.h>
+#include <filesystem>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <pqrs/hash.hpp>
+#include <string>
+#include <vector>
+
+namespace krbn {
+// eval_js_cache stores the results of `eval_js` rules in files in order to skip the JavaScript evaluation
+// when karabiner.json is reloaded with the same code.
+//
+// The cache key is the hash of the code, the Duktape version and the Karabiner-Elements version.
+// Each file also contains the code and the versions, and they are compared when the file is read,
+// so a hash collision or an outdated file is treated as a miss.
+class eval_js_cache final {
+public:
+  eval_js_cache(const eval_js_cache&) = delete;
+
+  eval_js_cache(const std::filesystem::path& directory,
+                const std::string& karabiner_version,
+                size_t max_entries = 1024)
+      : directory_(directory),
+        karabiner_version_(karabiner_version),
+        max_entries_(std::max(max_entries, static_cast<size_t>(1))),
+        hit_count_(0),
+        miss_count_(0),
+        entry_count_(std::nullopt) {
+  }
+
+  [[nodiscard]] const std::filesystem::path& get_directory() const {
+    return directory_;
+  }
+
+  [[nodiscard]] std::optional<nlohmann::json> find(const std::string& code) {
+    auto file_path = make_file_path(code);
+
+    if (auto body = filesystem_utility::read_file(file_path)) {
+      try {
+        auto json = json_utility::parse_jsonc(*body);
+        if (json.is_object() &&
+            json.value("code", "") == code &&
+            json.value("duktape_version", 0L) == DUK_VERSION &&
+            json.value("karabiner_version", "") == karabiner_version_ &&
+            json.contains("json")) {
+          ++hit_count_;
+          return std::move(json["json"]);
+        }
+      } catch (std::exception& e) {
+        logger::get_logger()->warn("eval_js_cache: broken file {0}: {1}", file_path.string(), e.what());
+      }
+    }
+
+    ++miss_count_;
+    return std::nullopt;
+  }
+
+  void save(const std::string& code,
+            const nlohmann::json& json) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!entry_count_) {
+      entry_count_ = get_entry_file_paths().size();
+    }
+    if (*entry_count_ >= max_entries_) {
+      prune();
+    }
+
+    auto file_path = make_file_path(code);
+    if (!filesystem_utility::exists(file_path)) {
+      ++(*entry_count_);
+    }
+
+    json_writer::save_to_file(nlohmann::json::object({
+                                  {"code", code},
+                                  {"duktape_version", DUK_VERSION},
+                                  {"karabiner_version", karabiner_version_},
+                                  {"json", json},
+                              }),
+                              file_path,
+                              filesystem_utility::permissions_0600);
+  }
+
+  // Remove all cache files.
+  // Returns the number of removed files.
+  size_t clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t count = 0;
+    for (const auto& p : get_entry_file_paths()) {
+      if (filesystem_utility::remove(p)) {
+        ++count;
+      }
+    }
+
+    entry_count_ = 0;
+
+    return count;
+  }
+
+  [[nodiscard]] uint64_t get_hit_count() const {
+    return hit_count_;
+  }
+
+  [[nodiscard]] uint64_t get_miss_count() const {
+    return miss_count_;
+  }
+
+private:
+  std::filesystem::path make_file_path(const std::string& code) const {
+    size_t h = 0;
+    pqrs::hash::combine(h, code);
+    pqrs::hash::combine(h, static_cast<long>(DUK_VERSION));
+    pqrs::hash::combine(h, karabiner_version_);
+
+    return directory_ / fmt::format("{0:016x}.json", h);
+  }
+
+  std::vector<std::filesystem::path> get_entry_file_paths() const {
+    std::vector<std::filesystem::path> file_paths;
+
+    std::error_code error_code;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error_code)) {
+      if (entry.is_regular_file(error_code) &&
+          entry.path().extension() == ".json") {
+        file_paths.push_back(entry.path());
+      }
+    }
+
+    return file_paths;
+  }
+
+  // Remove older half of the files.
+  // (Call with mutex_ locked.)
+  void prune() {
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+    for (const auto& p : get_entry_file_paths()) {
+      if (auto t = filesystem_utility::last_write_time(p)) {
+        entries.emplace_back(*t, p);
+      }
+    }
+
+    std::ranges::sort(entries);
+
+    auto remove_count = entries.size() - std::min(entries.size(), max_entries_ / 2);
+    for (size_t i = 0; i < remove_count; ++i) {
+      filesystem_utility::remove(entries[i].second);
+    }
+
+    entry_count_ = entries.size() - remove_count;
+
+    logger::get_logger()->info("eval_js_cache: {0} files are pruned", remove_count);
+  }
+
+  std::filesystem::path directory_;
+  std::string karabiner_version_;
+  size_t max_entries_;
+  std::atomic<uint64_t> hit_count_;
+  std::atomic<uint64_t> miss_count_;
+  std::optional<size_t> entry_count_;
+  std::mutex mutex_;
+};
+
+[[nodiscard]] inline std::shared_ptr<eval_js_cache>& get_shared_eval_js_cache_storage() {
+  static std::shared_ptr<eval_js_cache> p;
+  return p;
+}
+
+[[nodiscard]] inline std::mutex& get_shared_eval_js_cache_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// The cache is disabled until initialize_shared_eval_js_cache is called.
+inline void initialize_shared_eval_js_cache(const std::filesystem::path& directory,
+                                            const std::string& karabiner_version) {
+  std::lock_guard<std::mutex> lock(get_shared_eval_js_cache_mutex());
+
+  if (directory.empty()) {
+    get_shared_eval_js_cache_storage() = nullptr;
+  } else {
+    get_shared_eval_js_cache_storage() = std::make_shared<eval_js_cache>(directory, karabiner_version);
+  }
+}
+
+inline void terminate_shared_eval_js_cache() {
+  std::lock_guard<std::mutex> lock(get_shared_eval_js_cache_mutex());
+
+  get_shared_eval_js_cache_storage() = nullptr;
+}
+
+[[nodiscard]] inline std::shared_ptr<eval_js_cache> get_shared_eval_js_cache() {
+  std::lock_guard<std::mutex> lock(get_shared_eval_js_cache_mutex());
+
+  return get_shared_eval_js_cache_storage();
+}
+} // namespace krbn
@@ -52,6 +52,25 @@ public:
     *this = other;
   }
 
+  entry& operator=(entry&& other) noexcept {
+    device_id_ = other.device_id_;
+    event_time_stamp_ = other.event_time_stamp_;
+    validity_ = other.validity_;
+    state_ = other.state_;
+    lazy_ = other.lazy_;
+    event_ = std::move(other.event_);
+    event_type_ = other.event_type_;
+    event_integer_value_ = other.event_integer_value_;
+    original_event_ = std::move(other.original_event_);
+    return *this;
+  }
+
+  // Moving avoids copying heap-allocated event values (e.g., shell_command strings)
+  // when entries are handed over to `event_queue::queue`.
+  entry(entry&& other) noexcept {
+    *this = std::move(other);
+  }
+
   static entry make_from_json(const nlohmann::json& json) {
     entry result(device_id(0),
                  event_time_stamp(absolute_time_point(0)),
@@ -252,7 +271,4 @@ inline void to_json(nlohmann::json& json, const entry& value) {
   json = value.to_json();
 }
 
-typedef pqrs::not_null_shared_ptr_t<const entry> not_null_const_entry_ptr_t;
-typedef pqrs::not_null_shared_ptr_t<std::vector<not_null_const_entry_ptr_t>> not_null_entries_ptr_t;
-
 } // namespace krbn::event_queue
@@ -6,6 +6,7 @@
 #include "device_properties.hpp"
 #include "hash.hpp"
 #include "manipulator/manipulator_environment.hpp"
+#include "shared_payload.hpp"
 #include "types.hpp"
 #include <gsl/gsl>
 #include <optional>
@@ -26,6 +27,7 @@ public:
     send_user_command,
     select_input_source,
     set_variable,
+    set_variables,
     set_notification_message,
     mouse_key,
     sticky_modifier,
@@ -43,23 +45,30 @@ public:
     virtual_hid_devices_state_changed,
   };
 
-  using value_t = std::variant<momentary_switch_event,                                   // For type::momentary_switch_event
-                               pointing_motion,                                          // For type::pointing_motion
-                               int64_t,                                                  // For type::caps_lock_state_changed
-                               std::string,                                              // For shell_command
-                               nlohmann::json,                                           // For send_user_command
-                               std::vector<pqrs::osx::input_source_selector::specifier>, // For select_input_source
-                               manipulator_environment_variable_set_variable,            // For set_variable
-                               notification_message,                                     // For set_notification_message
-                               mouse_key,                                                // For mouse_key
-                               std::pair<modifier_flag, sticky_modifier_type>,           // For sticky_modifier
-                               software_function,                                        // For software_function
-                               application,                                              // For frontmost_application_changed
-                               pqrs::osx::input_source::properties,                      // For input_source_changed
-                               pqrs::not_null_shared_ptr_t<device_properties>,           // For device_grabbed
-                               pqrs::osx::system_preferences::properties,                // For system_preferences_properties_changed
-                               virtual_hid_devices_state,                                // For virtual_hid_devices_state_changed
-                               std::monostate>;                                          // For virtual events
+  // Heavy values are stored in shared_payload so that the common momentary_switch_event and pointing_motion events
+  // are small and trivially copied when entries are copied, swapped and compared in event_queue::queue.
+  // Use `get_if<T>` to access values regardless of whether they are stored in shared_payload.
+  using value_t = std::variant<momentary_switch_event,                                                     // For type::momentary_switch_event
+                               pointing_motion,                                                            // For type::pointing_motion
+                               int64_t,                                                                    // For type::caps_lock_state_changed
+                               shared_payload<std::string>,                                                // For shell_command
+                               shared_payload<nlohmann::json>,                                             // For send_user_command
+                               shared_payload<std::vector<pqrs::osx::input_source_selector::specifier>>,   // For select_input_source
+                               shared_payload<manipulator_environment_variable_set_variable>,              // For set_variable
+                               shared_payload<std::vector<manipulator_environment_variable_set_variable>>, // For set_variables
+                               shared_payload<notification_message>,                                       // For set_notification_message
+                               mouse_key,                                                                  // For mouse_key
+                               std::pair<modifier_flag, sticky_modifier_type>,                             // For sticky_modifier
+                               shared_payload<software_function>,                                          // For software_function
+                               shared_payload<application>,                                                // For frontmost_application_changed
+                               shared_payload<pqrs::osx::input_source::properties>,                        // For input_source_changed
+                               pqrs::not_null_shared_ptr_t<device_properties>,                             // For device_grabbed
+                               pqrs::osx::system_preferences::properties,                                  // For system_preferences_properties_changed
+                               virtual_hid_devices_state,                                                  // For virtual_hid_devices_state_changed
+                               std::monostate>;                                                            // For virtual events
+
+  static_assert(std::is_trivially_copyable_v<momentary_switch_event>);
+  static_assert(std::is_trivially_copyable_v<pointing_motion>);
 
   event() : type_(type::none),
             value_(std::monostate()) {
@@ -80,25 +89,27 @@ public:
           } else if (key == "caps_lock_state_changed") {
             result.value_ = value.get<int64_t>();
           } else if (key == "shell_command") {
-            result.value_ = value.get<std::string>();
+            result.value_ = shared_payload<std::string>(value.get<std::string>());
           } else if (key == "user_command") {
-            result.value_ = value.get<nlohmann::json>();
+            result.value_ = shared_payload<nlohmann::json>(value.get<nlohmann::json>());
           } else if (key == "input_source_specifiers") {
-            result.value_ = value.get<std::vector<pqrs::osx::input_source_selector::specifier>>();
+            result.value_ = shared_payload<std::vector<pqrs::osx::input_source_selector::specifier>>(value.get<std::vector<pqrs::osx::input_source_selector::specifier>>());
           } else if (key == "set_variable") {
-            result.value_ = value.get<manipulator_environment_variable_set_variable>();
+            result.value_ = shared_payload<manipulator_environment_variable_set_variable>(value.get<manipulator_environment_variable_set_variable>());
+          } else if (key == "set_variables") {
+            result.value_ = shared_payload<std::vector<manipulator_environment_variable_set_variable>>(value.get<std::vector<manipulator_environment_variable_set_variable>>());
           } else if (key == "set_notification_message") {
-            result.value_ = value.get<notification_message>();
+            result.value_ = shared_payload<notification_message>(value.get<notification_message>());
           } else if (key == "mouse_key") {
             result.value_ = value.get<mouse_key>();
           } else if (key == "sticky_modifier") {
             result.value_ = value.get<std::pair<modifier_flag, sticky_modifier_type>>();
           } else if (key == "software_function") {
-            result.value_ = value.get<software_function>();
+            result.value_ = shared_payload<software_function>(value.get<software_function>());
           } else if (key == "frontmost_application") {
-            result.value_ = value.get<application>();
+            result.value_ = shared_payload<application>(value.get<application>());
           } else if (key == "input_source_properties") {
-            result.value_ = value.get<pqrs::osx::input_source::properties>();
+            result.value_ = shared_payload<pqrs::osx::input_source::properties>(value.get<pqrs::osx::input_source::properties>());
           } else if (key == "system_preferences_properties") {
             result.value_ = value.get<pqrs::osx::system_preferences::properties>();
           } else if (key == "virtual_hid_devices_state") {
@@ -162,6 +173,12 @@ public:
         }
         break;
 
+      case type::set_variables:
+        if (auto v = get_set_variables()) {
+          json["set_variables"] = *v;
+        }
+        break;
+
       case type::set_notification_message:
         if (auto v = get_if<notification_message>()) {
           json["set_notification_message"] = *v;
@@ -232,35 +249,44 @@ public:
   static event make_shell_command_event(const std::string& shell_command) {
     event e;
     e.type_ = type::shell_command;
-    e.value_ = shell_command;
+    e.value_ = shared_payload<std::string>(shell_command);
     return e;
   }
 
   static event make_send_user_command_event(const nlohmann::json& user_command) {
     event e;
     e.type_ = type::send_user_command;
-    e.value_ = user_command;
+    e.value_ = shared_payload<nlohmann::json>(user_command);
     return e;
   }
 
   static event make_select_input_source_event(const std::vector<pqrs::osx::input_source_selector::specifier>& input_source_specifiers) {
     event e;
     e.type_ = type::select_input_source;
-    e.value_ = input_source_specifiers;
+    e.value_ = shared_payload<std::vector<pqrs::osx::input_source_selector::specifier>>(input_source_specifiers);
     return e;
   }
 
   static event make_set_variable_event(const manipulator_environment_variable_set_variable& value) {
     event e;
     e.type_ = type::set_variable;
-    e.value_ = value;
+    e.value_ = shared_payload<manipulator_environment_variable_set_variable>(value);
+    return e;
+  }
+
+  // Variables are applied together in event_queue::queue::emplace_back_entry,
+  // so manipulators handle the whole update as a single entry.
+  static event make_set_variables_event(const std::vector<manipulator_environment_variable_set_variable>& values) {
+    event e;
+    e.type_ = type::set_variables;
+    e.value_ = shared_payload<std::vector<manipulator_environment_variable_set_variable>>(values);
     return e;
   }
 
   static event make_set_notification_message_event(const notification_message& value) {
     event e;
     e.type_ = type::set_notification_message;
-    e.value_ = value;
+    e.value_ = shared_payload<notification_message>(value);
     return e;
   }
 
@@ -285,7 +311,7 @@ public:
   static event make_software_function_event(const software_function& value) {
     event e;
     e.type_ = type::software_function;
-    e.value_ = value;
+    e.value_ = shared_payload<software_function>(value);
     return e;
   }
 
@@ -322,14 +348,14 @@ public:
   static event make_frontmost_application_changed_event(const application& application) {
     event e;
     e.type_ = type::frontmost_application_changed;
-    e.value_ = application;
+    e.value_ = shared_payload<application>(application);
     return e;
   }
 
   static event make_input_source_changed_event(const pqrs::osx::input_source::properties& properties) {
     event e;
     e.type_ = type::input_source_changed;
-    e.value_ = properties;
+    e.value_ = shared_payload<pqrs::osx::input_source::properties>(properties);
     return e;
   }
 
@@ -357,7 +383,14 @@ public:
 
   template <typename T>
   [[nodiscard]] const T* get_if() const {
-    return std::get_if<T>(&value_);
+    if constexpr (holds_shared_payload<T, value_t>::value) {
+      if (auto p = std::get_if<shared_payload<T>>(&value_)) {
+        return &(p->get());
+      }
+      return nullptr;
+    } else {
+      return std::get_if<T>(&value_);
+    }
   }
 
   [[nodiscard]] std::optional<pointing_motion> get_pointing_motion() const {
@@ -383,7 +416,7 @@ public:
   [[nodiscard]] std::optional<std::string> get_shell_command() const {
     try {
       if (type_ == type::shell_command) {
-        return std::get<std::string>(value_);
+        return std::get<shared_payload<std::string>>(value_).get();
       }
     } catch (std::bad_variant_access&) {
     }
@@ -393,7 +426,7 @@ public:
   [[nodiscard]] std::optional<nlohmann::json> get_user_command() const {
     try {
       if (type_ == type::send_user_command) {
-        return std::get<nlohmann::json>(value_);
+        return std::get<shared_payload<nlohmann::json>>(value_).get();
       }
     } catch (std::bad_variant_access&) {
     }
@@ -403,7 +436,7 @@ public:
   [[nodiscard]] std::optional<std::vector<pqrs::osx::input_source_selector::specifier>> get_input_source_specifiers() const {
     try {
       if (type_ == type::select_input_source) {
-        return std::get<std::vector<pqrs::osx::input_source_selector::specifier>>(value_);
+        return std::get<shared_payload<std::vector<pqrs::osx::input_source_selector::specifier>>>(value_).get();
       }
     } catch (std::bad_variant_access&) {
     }
@@ -413,13 +446,20 @@ public:
   [[nodiscard]] std::optional<manipulator_environment_variable_set_variable> get_set_variable() const {
     try {
       if (type_ == type::set_variable) {
-        return std::get<manipulator_environment_variable_set_variable>(value_);
+        return std::get<shared_payload<manipulator_environment_variable_set_variable>>(value_).get();
       }
     } catch (std::bad_variant_access&) {
     }
     return std::nullopt;
   }
 
+  [[nodiscard]] const std::vector<manipulator_environment_variable_set_variable>* get_set_variables() const {
+    if (type_ == type::set_variables) {
+      return get_if<std::vector<manipulator_environment_variable_set_variable>>();
+    }
+    return nullptr;
+  }
+
   [[nodiscard]] std::optional<mouse_key> get_mouse_key() const {
     try {
       if (type_ == type::mouse_key) {
@@ -443,7 +483,7 @@ public:
   [[nodiscard]] std::optional<application> get_frontmost_application() const {
     try {
       if (type_ == type::frontmost_application_changed) {
-        return std::get<application>(value_);
+        return std::get<shared_payload<application>>(value_).get();
       }
     } catch (std::bad_variant_access&) {
     }
@@ -453,7 +493,7 @@ public:
   [[nodiscard]] std::optional<pqrs::osx::input_source::properties> get_input_source_properties() const {
     try {
       if (type_ == type::input_source_changed) {
-        return std::get<pqrs::osx::input_source::properties>(value_);
+        return std::get<shared_payload<pqrs::osx::input_source::properties>>(value_).get();
       }
     } catch (std::bad_variant_access&) {
     }
@@ -486,6 +526,7 @@ private:
       TO_C_STRING(send_user_command);
       TO_C_STRING(select_input_source);
       TO_C_STRING(set_variable);
+      TO_C_STRING(set_variables);
       TO_C_STRING(set_notification_message);
       TO_C_STRING(mouse_key);
       TO_C_STRING(sticky_modifier);
@@ -521,6 +562,7 @@ private:
     TO_TYPE(send_user_command);
     TO_TYPE(select_input_source);
     TO_TYPE(set_variable);
+    TO_TYPE(set_variables);
     TO_TYPE(set_notification_message);
     TO_TYPE(mouse_key);
     TO_TYPE(sticky_modifier);
@@ -3,9 +3,10 @@
 #include "event_queue/entry.hpp"
 #include "event_queue/event.hpp"
 #include "event_queue/event_time_stamp.hpp"
-#include "manipulator/condition_expression_manager.hpp"
+#include "manipulator/manipulator_environment.hpp"
 #include "modifier_flag_manager.hpp"
 #include "pointing_button_manager.hpp"
+#include <deque>
 #include <string_view>
 
 namespace krbn::event_queue {
@@ -13,7 +14,8 @@ class queue {
 public:
   queue(const queue&) = delete;
 
-  queue() : time_stamp_delay_(0) {
+  queue() : time_stamp_delay_(0),
+            sorted_size_(0) {
   }
 
   void emplace_back_entry(device_id device_id,
@@ -38,146 +40,10 @@ public:
                          lazy,
                          validity);
 
-    //
-    // Update modifier_flag_manager, pointing_button_manager
-    //
-
-    if (auto e = event.get_if<momentary_switch_event>()) {
-      if (auto modifier_flag = e->make_modifier_flag()) {
-        auto type = (event_type == event_type::key_down ? modifier_flag_manager::active_modifier_flag::type::increase
-                                                        : modifier_flag_manager::active_modifier_flag::type::decrease);
-        modifier_flag_manager::active_modifier_flag active_modifier_flag(type,
-                                                                         *modifier_flag,
-                                                                         device_id);
-        modifier_flag_manager_.push_back_active_modifier_flag(active_modifier_flag);
-      }
-
-      if (e->pointing_button()) {
-        auto type = (event_type == event_type::key_down ? pointing_button_manager::active_pointing_button::type::increase
-                                                        : pointing_button_manager::active_pointing_button::type::decrease);
-        pointing_button_manager::active_pointing_button active_pointing_button(type,
-                                                                               e->get_usage_pair(),
-                                                                               device_id);
-        pointing_button_manager_.push_back_active_pointing_button(active_pointing_button);
-      }
-
-      // Erase sticky modifiers
-      if (event_type == event_type::key_down &&
-          validity == validity::valid &&
-          !e->modifier_flag()) {
-        modifier_flag_manager_.erase_all_sticky_modifier_flags();
-      }
-
-    } else if (event.get_type() == event::type::sticky_modifier) {
-      if (event_type == event_type::key_down || event_type == event_type::single) {
-        if (auto sticky_modifier = event.get_sticky_modifier()) {
-          auto type = modifier_flag_manager::active_modifier_flag::type::increase_sticky;
-
-          if (sticky_modifier->second == sticky_modifier_type::toggle) {
-            if (modifier_flag_manager_.sticky_size(sticky_modifier->first) > 0) {
-              type = modifier_flag_manager::active_modifier_flag::type::decrease_sticky;
-            }
-          } else {
-            if (sticky_modifier->second != sticky_modifier_type::on) {
-              type = modifier_flag_manager::active_modifier_flag::type::decrease_sticky;
-            }
-          }
-
-          modifier_flag_manager::active_modifier_flag active_modifier_flag(type,
-                                                                           sticky_modifier->first,
-                                                                           device_id);
-          modifier_flag_manager_.push_back_active_modifier_flag(active_modifier_flag);
-        }
-      }
-
-    } else if (event.get_type() == event::type::caps_lock_state_changed) {
-      if (auto integer_value = event.get_integer_value()) {
-        auto type = (*integer_value ? modifier_flag_manager::active_modifier_flag::type::increase_led_lock
-                                    : modifier_flag_manager::active_modifier_flag::type::decrease_led_lock);
-        modifier_flag_manager::active_modifier_flag active_modifier_flag(type,
-                                                                         modifier_flag::caps_lock,
-                                                                         device_id);
-        modifier_flag_manager_.push_back_active_modifier_flag(active_modifier_flag);
-      }
-    }
-
-    //
-    // Update manipulator_environment
-    //
-
-    if (event.get_type() == event::type::device_grabbed) {
-      if (auto v = event.get_if<pqrs::not_null_shared_ptr_t<device_properties>>()) {
-        manipulator_environment_.insert_device_properties(device_id, *v);
-      }
-    }
-    if (event.get_type() == event::type::device_ungrabbed) {
-      manipulator_environment_.erase_device_properties(device_id);
-    }
-    if (auto frontmost_application = event.get_frontmost_application()) {
-      manipulator_environment_.set_frontmost_application(*frontmost_application);
-    }
-    if (auto properties = event.get_input_source_properties()) {
-      manipulator_environment_.set_input_source_properties(*properties);
-    }
-    if (auto set_variable = event.get_set_variable()) {
-      switch (event_type) {
-        case event_type::key_down:
-          if (auto n = set_variable->get_name()) {
-            switch (set_variable->get_type()) {
-              case manipulator_environment_variable_set_variable::type::set:
-                if (auto v = set_variable->get_value()) {
-                  manipulator_environment_.set_variable(*n, *v);
-                }
-                if (auto v = set_variable->get_expression()) {
-                  manipulator_environment_.set_variable_system_now_milliseconds();
-                  manipulator_environment_.apply_to_expression_variable(v);
-
-                  manipulator_environment_.set_variable(*n,
-                                                        manipulator_environment_variable_value(v->value<int64_t>()));
-                }
-                break;
-
-              case manipulator_environment_variable_set_variable::type::unset:
-                manipulator_environment_.unset_variable(*n);
-                break;
-            }
-          }
-          break;
-        case event_type::key_up:
-          if (auto n = set_variable->get_name()) {
-            switch (set_variable->get_type()) {
-              case manipulator_environment_variable_set_variable::type::set:
-                if (auto v = set_variable->get_key_up_value()) {
-                  manipulator_environment_.set_variable(*n, *v);
-                }
-                if (auto v = set_variable->get_key_up_expression()) {
-                  manipulator_environment_.set_variable_system_now_milliseconds();
-                  manipulator_environment_.apply_to_expression_variable(v);
-
-                  manipulator_environment_.set_variable(*n,
-                                                        manipulator_environment_variable_value(v->value<int64_t>()));
-                }
-                break;
-              case manipulator_environment_variable_set_variable::type::unset:
-                // Do nothing
-                break;
-            }
-          }
-          break;
-        case event_type::single:
-          // Do nothing
-          break;
-      }
-    }
-    if (auto properties = event.get_if<pqrs::osx::system_preferences::properties>()) {
-      manipulator_environment_.set_variable("system.scroll_direction_is_natural",
-                                            manipulator_environment_variable_value(properties->get_scroll_direction_is_natural()));
-      manipulator_environment_.set_variable("system.use_fkeys_as_standard_function_keys",
-                                            manipulator_environment_variable_value(properties->get_use_fkeys_as_standard_function_keys()));
-    }
-    if (auto state = event.get_if<virtual_hid_devices_state>()) {
-      manipulator_environment_.set_virtual_hid_devices_state(*state);
-    }
+    update_states(device_id,
+                  event,
+                  event_type,
+                  validity);
   }
 
   void push_back_entry(const entry& entry) {
@@ -192,9 +58,23 @@ public:
                        entry.get_validity());
   }
 
+  // Move the entry into the queue without copying its events.
+  void push_back_entry(entry&& entry) {
+    auto& t = entry.get_event_time_stamp();
+    t.set_time_stamp(t.get_time_stamp() + time_stamp_delay_);
+
+    const auto& e = events_.emplace_back(std::move(entry));
+
+    update_states(e.get_device_id(),
+                  e.get_event(),
+                  e.get_event_type(),
+                  e.get_validity());
+  }
+
   void clear_events() {
     events_.clear();
     time_stamp_delay_ = absolute_time_duration(0);
+    sorted_size_ = 0;
   }
 
   [[nodiscard]] entry& get_front_event() {
@@ -202,7 +82,10 @@ public:
   }
 
   void erase_front_event() {
-    events_.erase(std::begin(events_));
+    events_.pop_front();
+    if (sorted_size_ > 0) {
+      --sorted_size_;
+    }
     if (events_.empty()) {
       time_stamp_delay_ = absolute_time_duration(0);
     }
@@ -212,7 +95,7 @@ public:
     return events_.empty();
   }
 
-  [[nodiscard]] const std::vector<entry>& get_entries() const {
+  [[nodiscard]] const std::deque<entry>& get_entries() const {
     return events_;
   }
 
@@ -265,7 +148,11 @@ public:
       return;
     }
 
-    for (int i = 0; i < events_.size() - 1;) {
+    // The first sorted_size_ entries are already sorted by the previous call.
+    // Start from the last sorted entry since scanning the sorted entries does not swap anything.
+    size_t i = sorted_size_ > 0 ? sorted_size_ - 1 : 0;
+
+    while (i < events_.size() - 1) {
       if (needs_swap(events_[i], events_[i + 1])) {
         std::swap(events_[i], events_[i + 1]);
         if (i > 0) {
@@ -275,6 +162,8 @@ public:
       }
       ++i;
     }
+
+    sorted_size_ = events_.size();
   }
 
   [[nodiscard]] static bool needs_swap(const entry& v1, const entry& v2) {
@@ -357,10 +246,171 @@ public:
   }
 
 private:
-  std::vector<entry> events_;
+  void update_states(device_id device_id,
+                     const class event& event,
+                     event_type event_type,
+                     validity validity) {
+    //
+    // Update modifier_flag_manager, pointing_button_manager
+    //
+
+    if (auto e = event.get_if<momentary_switch_event>()) {
+      if (auto modifier_flag = e->make_modifier_flag()) {
+        auto type = (event_type == event_type::key_down ? modifier_flag_manager::active_modifier_flag::type::increase
+                                                        : modifier_flag_manager::active_modifier_flag::type::decrease);
+        modifier_flag_manager::active_modifier_flag active_modifier_flag(type,
+                                                                         *modifier_flag,
+                                                                         device_id);
+        modifier_flag_manager_.push_back_active_modifier_flag(active_modifier_flag);
+      }
+
+      if (e->pointing_button()) {
+        auto type = (event_type == event_type::key_down ? pointing_button_manager::active_pointing_button::type::increase
+                                                        : pointing_button_manager::active_pointing_button::type::decrease);
+        pointing_button_manager::active_pointing_button active_pointing_button(type,
+                                                                               e->get_usage_pair(),
+                                                                               device_id);
+        pointing_button_manager_.push_back_active_pointing_button(active_pointing_button);
+      }
+
+      // Erase sticky modifiers
+      if (event_type == event_type::key_down &&
+          validity == validity::valid &&
+          !e->modifier_flag()) {
+        modifier_flag_manager_.erase_all_sticky_modifier_flags();
+      }
+
+    } else if (event.get_type() == event::type::sticky_modifier) {
+      if (event_type == event_type::key_down || event_type == event_type::single) {
+        if (auto sticky_modifier = event.get_sticky_modifier()) {
+          auto type = modifier_flag_manager::active_modifier_flag::type::increase_sticky;
+
+          if (sticky_modifier->second == sticky_modifier_type::toggle) {
+            if (modifier_flag_manager_.sticky_size(sticky_modifier->first) > 0) {
+              type = modifier_flag_manager::active_modifier_flag::type::decrease_sticky;
+            }
+          } else {
+            if (sticky_modifier->second != sticky_modifier_type::on) {
+              type = modifier_flag_manager::active_modifier_flag::type::decrease_sticky;
+            }
+          }
+
+          modifier_flag_manager::active_modifier_flag active_modifier_flag(type,
+                                                                           sticky_modifier->first,
+                                                                           device_id);
+          modifier_flag_manager_.push_back_active_modifier_flag(active_modifier_flag);
+        }
+      }
+
+    } else if (event.get_type() == event::type::caps_lock_state_changed) {
+      if (auto integer_value = event.get_integer_value()) {
+        auto type = (*integer_value ? modifier_flag_manager::active_modifier_flag::type::increase_led_lock
+                                    : modifier_flag_manager::active_modifier_flag::type::decrease_led_lock);
+        modifier_flag_manager::active_modifier_flag active_modifier_flag(type,
+                                                                         modifier_flag::caps_lock,
+                                                                         device_id);
+        modifier_flag_manager_.push_back_active_modifier_flag(active_modifier_flag);
+      }
+    }
+
+    //
+    // Update manipulator_environment
+    //
+
+    if (event.get_type() == event::type::device_grabbed) {
+      if (auto v = event.get_if<pqrs::not_null_shared_ptr_t<device_properties>>()) {
+        manipulator_environment_.insert_device_properties(device_id, *v);
+      }
+    }
+    if (event.get_type() == event::type::device_ungrabbed) {
+      manipulator_environment_.erase_device_properties(device_id);
+    }
+    if (auto frontmost_application = event.get_frontmost_application()) {
+      manipulator_environment_.set_frontmost_application(*frontmost_application);
+    }
+    if (auto properties = event.get_input_source_properties()) {
+      manipulator_environment_.set_input_source_properties(*properties);
+    }
+    if (auto set_variable = event.get_set_variable()) {
+      apply_set_variable(*set_variable, event_type);
+    }
+    if (auto set_variables = event.get_set_variables()) {
+      // All variables are updated before manipulators handle this entry,
+      // so conditions never observe a partially applied update.
+      for (const auto& set_variable : *set_variables) {
+        apply_set_variable(set_variable, event_type::key_down);
+      }
+    }
+    if (auto properties = event.get_if<pqrs::osx::system_preferences::properties>()) {
+      manipulator_environment_.set_variable("system.scroll_direction_is_natural",
+                                            manipulator_environment_variable_value(properties->get_scroll_direction_is_natural()));
+      manipulator_environment_.set_variable("system.use_fkeys_as_standard_function_keys",
+                                            manipulator_environment_variable_value(properties->get_use_fkeys_as_standard_function_keys()));
+    }
+    if (auto state = event.get_if<virtual_hid_devices_state>()) {
+      manipulator_environment_.set_virtual_hid_devices_state(*state);
+    }
+  }
+
+  void apply_set_variable(const manipulator_environment_variable_set_variable& set_variable,
+                          event_type event_type) {
+    switch (event_type) {
+      case event_type::key_down:
+        if (auto n = set_variable.get_slot_id()) {
+          switch (set_variable.get_type()) {
+            case manipulator_environment_variable_set_variable::type::set:
+              if (auto v = set_variable.get_value()) {
+                manipulator_environment_.set_variable(*n, *v);
+              }
+              if (auto v = set_variable.get_expression()) {
+                manipulator_environment_.set_variable_system_now_milliseconds();
+                manipulator_environment_.apply_to_expression_variable(v);
+
+                manipulator_environment_.set_variable(*n,
+                                                      manipulator_environment_variable_value(v->value<int64_t>()));
+              }
+              break;
+
+            case manipulator_environment_variable_set_variable::type::unset:
+              manipulator_environment_.unset_variable(*n);
+              break;
+          }
+        }
+        break;
+      case event_type::key_up:
+        if (auto n = set_variable.get_slot_id()) {
+          switch (set_variable.get_type()) {
+            case manipulator_environment_variable_set_variable::type::set:
+              if (auto v = set_variable.get_key_up_value()) {
+                manipulator_environment_.set_variable(*n, *v);
+              }
+              if (auto v = set_variable.get_key_up_expression()) {
+                manipulator_environment_.set_variable_system_now_milliseconds();
+                manipulator_environment_.apply_to_expression_variable(v);
+
+                manipulator_environment_.set_variable(*n,
+                                                      manipulator_environment_variable_value(v->value<int64_t>()));
+              }
+              break;
+            case manipulator_environment_variable_set_variable::type::unset:
+              // Do nothing
+              break;
+          }
+        }
+        break;
+      case event_type::single:
+        // Do nothing
+        break;
+    }
+  }
+
+  // manipulator_manager removes the front entry for each event.
+  // Use std::deque instead of std::vector to avoid moving all remaining entries on every removal.
+  std::deque<entry> events_;
   modifier_flag_manager modifier_flag_manager_;
   pointing_button_manager pointing_button_manager_;
   manipulator::manipulator_environment manipulator_environment_;
   absolute_time_duration time_stamp_delay_;
+  size_t sorted_size_;
 };
 } // namespace krbn::event_queue
@@ -0,0 +1,51 @@
+#pragma once
+
+// `krbn::event_queue::shared_payload` can be used safely in a multi-threaded environment.
+
+#include <memory>
+#include <type_traits>
+#include <variant>
+
+namespace krbn::event_queue {
+// Holds a heavy event value (strings, json, vectors) out-of-line.
+// The value is immutable and shared between copies, so copying an event never copies the payload
+// and `event::value_t` stays as small as momentary_switch_event and pointing_motion.
+template <typename T>
+class shared_payload final {
+public:
+  explicit shared_payload(const T& value)
+      : value_(std::make_shared<const T>(value)) {
+  }
+
+  explicit shared_payload(T&& value)
+      : value_(std::make_shared<const T>(std::move(value))) {
+  }
+
+  [[nodiscard]] const T& get() const {
+    return *value_;
+  }
+
+  bool operator==(const shared_payload& other) const {
+    return value_ == other.value_ ||
+           *value_ == *other.value_;
+  }
+
+private:
+  std::shared_ptr<const T> value_;
+};
+
+template <typename T, typename Variant>
+struct holds_shared_payload : std::false_type {};
+
+template <typename T, typename... Ts>
+struct holds_shared_payload<T, std::variant<Ts...>> : std::disjunction<std::is_same<shared_payload<T>, Ts>...> {};
+} // namespace krbn::event_queue
+
+namespace std {
+template <typename T>
+struct hash<krbn::event_queue::shared_payload<T>> final {
+  std::size_t operator()(const krbn::event_queue::shared_payload<T>& value) const {
+    return std::hash<T>{}(value.get());
+  }
+};
+} // namespace std
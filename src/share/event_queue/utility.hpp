@@ -31,11 +31,12 @@ struct make_entries_parameters final {
   double pointing_motion_wheels_multiplier = 1.0;
 };
 
-static inline not_null_entries_ptr_t make_entries(pqrs::not_null_shared_ptr_t<device_properties> device_properties,
-                                                  const std::vector<pqrs::osx::iokit_hid_value>& hid_values,
-                                                  const make_entries_parameters& parameters) {
-  auto result = std::make_shared<std::vector<not_null_const_entry_ptr_t>>();
-
+// Append entries to `result`.
+// Callers on the HID path reuse `result` across reports so that no allocation happens once its capacity is reserved.
+static inline void make_entries(pqrs::not_null_shared_ptr_t<device_properties> device_properties,
+                                const std::vector<pqrs::osx::iokit_hid_value>& hid_values,
+                                const make_entries_parameters& parameters,
+                                std::vector<entry>& result) {
   // The pointing motion usage (hid_usage::gd_x, hid_usage::gd_y, etc.) are splitted from one HID report.
   // We have to join them into one pointing_motion event to avoid VMware Remote Console problem that VMRC ignores frequently events.
 
@@ -54,14 +55,13 @@ static inline not_null_entries_ptr_t make_entries(pqrs::not_null_shared_ptr_t<de
           pointing_motion_horizontal_wheel ? *pointing_motion_horizontal_wheel : 0);
 
       event_queue::event event(pointing_motion);
-      auto e = std::make_shared<entry>(device_properties->get_device_id(),
-                                       event_time_stamp(*pointing_motion_time_stamp),
-                                       event,
-                                       event_type::single,
-                                       std::nullopt,
-                                       event,
-                                       state::original);
-      result->push_back(e);
+      result.emplace_back(device_properties->get_device_id(),
+                          event_time_stamp(*pointing_motion_time_stamp),
+                          event,
+                          event_type::single,
+                          std::nullopt,
+                          event,
+                          state::original);
 
       pointing_motion_time_stamp = std::nullopt;
       pointing_motion_x = std::nullopt;
@@ -86,14 +86,13 @@ static inline not_null_entries_ptr_t make_entries(pqrs::not_null_shared_ptr_t<de
       if (auto usage = v.get_usage()) {
         if (momentary_switch_event::target(*usage_page, *usage)) {
           event_queue::event event(momentary_switch_event(*usage_page, *usage));
-          auto e = std::make_shared<entry>(device_properties->get_device_id(),
-                                           event_time_stamp(v.get_time_stamp()),
-                                           event,
-                                           v.get_integer_value() ? event_type::key_down : event_type::key_up,
-                                           event_integer_value::value_t(v.get_integer_value()),
-                                           event,
-                                           state::original);
-          result->push_back(e);
+          result.emplace_back(device_properties->get_device_id(),
+                              event_time_stamp(v.get_time_stamp()),
+                              event,
+                              v.get_integer_value() ? event_type::key_down : event_type::key_up,
+                              event_integer_value::value_t(v.get_integer_value()),
+                              event,
+                              state::original);
 
         } else if (v.conforms_to(pqrs::hid::usage_page::generic_desktop,
                                  pqrs::hid::usage::generic_desktop::x) &&
@@ -136,14 +135,13 @@ static inline not_null_entries_ptr_t make_entries(pqrs::not_null_shared_ptr_t<de
         } else if (v.conforms_to(pqrs::hid::usage_page::leds,
                                  pqrs::hid::usage::led::caps_lock)) {
           auto event = event_queue::event::make_caps_lock_state_changed_event(v.get_integer_value());
-          auto e = std::make_shared<entry>(device_properties->get_device_id(),
-                                           event_time_stamp(v.get_time_stamp()),
-                                           event,
-                                           event_type::single,
-                                           std::nullopt,
-                                           event,
-                                           state::virtual_event);
-          result->push_back(e);
+          result.emplace_back(device_properties->get_device_id(),
+                              event_time_stamp(v.get_time_stamp()),
+                              event,
+                              event_type::single,
+                              std::nullopt,
+                              event,
+                              state::virtual_event);
 
         } else if (is_game_pad) {
           if (v.conforms_to(pqrs::hid::usage_page::generic_desktop,
@@ -153,14 +151,13 @@ static inline not_null_entries_ptr_t make_entries(pqrs::not_null_shared_ptr_t<de
                                                                                                  v.get_integer_value());
             for (const auto& pair : pairs) {
               event_queue::event event(pair.first);
-              auto e = std::make_shared<entry>(device_properties->get_device_id(),
-                                               event_time_stamp(v.get_time_stamp()),
-                                               event,
-                                               pair.second,
-                                               std::nullopt,
-                                               event,
-                                               state::original);
-              result->push_back(e);
+              result.emplace_back(device_properties->get_device_id(),
+                                  event_time_stamp(v.get_time_stamp()),
+                                  event,
+                                  pair.second,
+                                  std::nullopt,
+                                  event,
+                                  state::original);
             }
           }
         }
@@ -169,46 +166,55 @@ static inline not_null_entries_ptr_t make_entries(pqrs::not_null_shared_ptr_t<de
   }
 
   emplace_back_pointing_motion_event();
+}
 
+static inline std::vector<entry> make_entries(pqrs::not_null_shared_ptr_t<device_properties> device_properties,
+                                              const std::vector<pqrs::osx::iokit_hid_value>& hid_values,
+                                              const make_entries_parameters& parameters) {
+  std::vector<entry> result;
+  make_entries(device_properties,
+               hid_values,
+               parameters,
+               result);
   return result;
 }
 
-static inline not_null_entries_ptr_t insert_device_keys_and_pointing_buttons_are_released_event(not_null_entries_ptr_t entries,
-                                                                                                device_id device_id,
-                                                                                                pqrs::not_null_shared_ptr_t<pressed_keys_manager> pressed_keys_manager) {
-  auto result = std::make_shared<std::vector<not_null_const_entry_ptr_t>>();
-
-  for (const auto& entry : *entries) {
-    result->push_back(entry);
+// Insert device_keys_and_pointing_buttons_are_released events into `entries` in place.
+static inline void insert_device_keys_and_pointing_buttons_are_released_event(std::vector<entry>& entries,
+                                                                              device_id device_id,
+                                                                              pqrs::not_null_shared_ptr_t<pressed_keys_manager> pressed_keys_manager) {
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto& entry = entries[i];
 
-    if (entry->get_device_id() == device_id) {
-      if (entry->get_event_type() == event_type::key_down) {
-        if (auto e = entry->get_event().get_if<momentary_switch_event>()) {
+    if (entry.get_device_id() == device_id) {
+      if (entry.get_event_type() == event_type::key_down) {
+        if (auto e = entry.get_event().get_if<momentary_switch_event>()) {
           pressed_keys_manager->insert(*e);
         }
-      } else if (entry->get_event_type() == event_type::key_up) {
+      } else if (entry.get_event_type() == event_type::key_up) {
         if (!pressed_keys_manager->empty()) {
-          if (auto e = entry->get_event().get_if<momentary_switch_event>()) {
+          if (auto e = entry.get_event().get_if<momentary_switch_event>()) {
             pressed_keys_manager->erase(*e);
           }
 
           if (pressed_keys_manager->empty()) {
             auto event = event::make_device_keys_and_pointing_buttons_are_released_event();
-            auto e = std::make_shared<event_queue::entry>(device_id,
-                                                          entry->get_event_time_stamp(),
-                                                          event,
-                                                          event_type::single,
-                                                          std::nullopt,
-                                                          event,
-                                                          state::virtual_event);
-            result->push_back(e);
+            // Copy the time stamp before `insert` since it may invalidate `entry`.
+            auto t = entry.get_event_time_stamp();
+            entries.insert(std::begin(entries) + i + 1,
+                           event_queue::entry(device_id,
+                                              t,
+                                              event,
+                                              event_type::single,
+                                              std::nullopt,
+                                              event,
+                                              state::virtual_event));
+            ++i;
           }
         }
       }
     }
   }
-
-  return result;
 }
 
 } // namespace krbn::event_queue::utility
@@ -10,9 +10,12 @@
 #define exprtk_disable_rtl_vecops
 
 #include "logger.hpp"
+#include "variable_slot_registry.hpp"
 #include <exprtk/exprtk.hpp>
+#include <initializer_list>
 #include <iostream>
 #include <pqrs/gsl.hpp>
+#include <unordered_map>
 
 namespace krbn::exprtk_utility {
 
@@ -55,8 +58,26 @@ struct zeroing_unknown_symbol_resolver : public unknown_symbol_resolver_t {
         return false;
       }
     }
+
+    variable_names_.push_back(name);
+
     return true;
   }
+
+  // The names of variables referenced in the expression.
+  [[nodiscard]] const std::vector<std::string>& get_variable_names() const {
+    return variable_names_;
+  }
+
+private:
+  std::vector<std::string> variable_names_;
+};
+
+// The variable store state that was applied to an expression_wrapper.
+// `store_id` identifies the store (e.g., manipulator_environment) and `version` is the store version at the time.
+struct applied_variables_version final {
+  uint64_t store_id;
+  uint64_t version;
 };
 
 class expression_wrapper final {
@@ -77,6 +98,33 @@ public:
     if (!parser_.compile(expression_string_, expression_)) {
       compile_error_ = parser_.error();
     }
+
+    //
+    // Bind variables to slots
+    //
+
+    auto registry = get_shared_variable_slot_registry();
+    for (const auto& name : zeroing_unknown_symbol_resolver_.get_variable_names()) {
+      variable_binding binding{
+          .slot_id = registry->intern(name),
+          .value = nullptr,
+          .string_value = nullptr,
+      };
+
+      if (is_string_variable_name(name)) {
+        if (auto p = symbol_table_.get_stringvar(name)) {
+          binding.string_value = &(p->ref());
+        }
+      } else {
+        if (auto p = symbol_table_.get_variable(name)) {
+          binding.value = &(p->ref());
+        }
+      }
+
+      if (binding.value || binding.string_value) {
+        variable_bindings_.push_back(binding);
+      }
+    }
   }
 
   [[nodiscard]] const std::string& get_expression_string() const {
@@ -96,6 +144,7 @@ public:
     }
 
     set_variable_(name, value);
+    applied_variables_version_ = std::nullopt;
     return true;
   }
 
@@ -108,9 +157,71 @@ public:
     }
 
     set_string_variable_(name, value);
+    applied_variables_version_ = std::nullopt;
     return true;
   }
 
+  // The setters and `unset_variable` with variable_slot_id also reset the applied variables version.
+  // (manipulator_environment::apply_to_expression_variable sets the version after applying variables.)
+  bool set_variable(variable_slot_id slot_id,
+                    double value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (auto b = find_variable_binding(slot_id)) {
+      if (b->value) {
+        *(b->value) = value;
+        applied_variables_version_ = std::nullopt;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool set_variable(variable_slot_id slot_id,
+                    const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (auto b = find_variable_binding(slot_id)) {
+      if (b->string_value) {
+        *(b->string_value) = value;
+        applied_variables_version_ = std::nullopt;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool unset_variable(variable_slot_id slot_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (auto b = find_variable_binding(slot_id)) {
+      if (b->value) {
+        *(b->value) = 0.0;
+      }
+      if (b->string_value) {
+        b->string_value->clear();
+      }
+      applied_variables_version_ = std::nullopt;
+      return true;
+    }
+
+    return false;
+  }
+
+  // The slot ids of variables referenced in the expression.
+  [[nodiscard]] std::vector<variable_slot_id> get_variable_slot_ids() const {
+    std::vector<variable_slot_id> result;
+
+    result.reserve(variable_bindings_.size());
+    for (const auto& b : variable_bindings_) {
+      result.push_back(b.slot_id);
+    }
+
+    return result;
+  }
+
   bool unset_variable(const std::string& name) {
     std::lock_guard<std::mutex> lock(mutex_);
 
@@ -120,6 +231,7 @@ public:
     } else {
       set_variable_(name, 0.0);
     }
+    applied_variables_version_ = std::nullopt;
 
     return true;
   }
@@ -127,13 +239,32 @@ public:
   double value() const noexcept {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    try {
-      return expression_.value();
-    } catch (std::exception& e) {
-      logger::get_logger()->error("exprtk error: {0}", e.what());
+    return value_();
+  }
+
+  // Set the variables and return the value under one lock.
+  // Use this method when the wrapper is shared via expression_cache and variables differ between users.
+  double evaluate(std::initializer_list<std::pair<std::string, double>> variables) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const auto& [name, value] : variables) {
+      set_variable_(name, value);
     }
+    applied_variables_version_ = std::nullopt;
 
-    return NAN;
+    return value_();
+  }
+
+  [[nodiscard]] std::optional<applied_variables_version> get_applied_variables_version() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return applied_variables_version_;
+  }
+
+  void set_applied_variables_version(const applied_variables_version& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    applied_variables_version_ = value;
   }
 
   template <typename T>
@@ -158,6 +289,35 @@ public:
   }
 
 private:
+  // A referenced variable and the storage managed by symbol_table_.
+  struct variable_binding final {
+    variable_slot_id slot_id;
+    // nullptr for string variables.
+    double* value;
+    // nullptr for non-string variables.
+    std::string* string_value;
+  };
+
+  // Expressions refer only a few variables, so a linear search is faster than a hash lookup.
+  variable_binding* find_variable_binding(variable_slot_id slot_id) {
+    for (auto&& b : variable_bindings_) {
+      if (b.slot_id == slot_id) {
+        return &b;
+      }
+    }
+    return nullptr;
+  }
+
+  double value_() const noexcept {
+    try {
+      return expression_.value();
+    } catch (std::exception& e) {
+      logger::get_logger()->error("exprtk error: {0}", e.what());
+    }
+
+    return NAN;
+  }
+
   void set_variable_(const std::string& name,
                      double value) {
     if (auto p = symbol_table_.get_variable(name)) {
@@ -179,12 +339,76 @@ private:
   expression_t expression_;
   parser_t parser_;
   std::optional<std::string> compile_error_;
+  std::vector<variable_binding> variable_bindings_;
+  std::optional<applied_variables_version> applied_variables_version_;
+
+  mutable std::mutex mutex_;
+};
+
+// A cache of compiled expressions keyed by the expression string.
+//
+// Profiles often contain the same expression in many manipulators (e.g., `expression_if` in each manipulator of a rule),
+// and game_pad_stick_converter compiles formulas on each configuration update.
+// expression_cache returns the same expression_wrapper for the same expression string while the wrapper is used,
+// so the expression is compiled once and variable updates are applied to one symbol table.
+//
+// Note:
+// Users of a shared expression_wrapper have to set variables just before calling `value`.
+// manipulator_environment::apply_to_expression_variable does so in the dispatcher thread which runs manipulators.
+// Users in other threads have to use `evaluate`, which sets variables and calculates the value atomically.
+// (game_pad_stick_converter::evaluate_formula)
+class expression_cache final {
+public:
+  expression_cache(const expression_cache&) = delete;
+
+  expression_cache() : prune_threshold_(prune_threshold_min_) {
+  }
+
+  pqrs::not_null_shared_ptr_t<expression_wrapper> compile(const std::string& expression_string) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (auto it = expressions_.find(expression_string); it != std::end(expressions_)) {
+      if (auto e = it->second.lock()) {
+        return e;
+      }
+    }
+
+    auto e = std::make_shared<expression_wrapper>(expression_string);
+    expressions_[expression_string] = e;
 
+    // Remove released expressions when the cache grows.
+    if (expressions_.size() >= prune_threshold_) {
+      std::erase_if(expressions_,
+                    [](const auto& pair) {
+                      return pair.second.expired();
+                    });
+      prune_threshold_ = std::max(prune_threshold_min_, expressions_.size() * 2);
+    }
+
+    return e;
+  }
+
+  [[nodiscard]] size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return expressions_.size();
+  }
+
+private:
+  static constexpr size_t prune_threshold_min_ = 256;
+
+  std::unordered_map<std::string, std::weak_ptr<expression_wrapper>> expressions_;
+  size_t prune_threshold_;
   mutable std::mutex mutex_;
 };
 
+[[nodiscard]] inline expression_cache& get_shared_expression_cache() {
+  static expression_cache cache;
+  return cache;
+}
+
 inline pqrs::not_null_shared_ptr_t<expression_wrapper> compile(const std::string& expression_string) {
-  return std::make_shared<expression_wrapper>(expression_string);
+  return get_shared_expression_cache().compile(expression_string);
 }
 
 inline bool compare(const std::shared_ptr<expression_wrapper>& a,
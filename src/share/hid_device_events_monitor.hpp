@@ -25,7 +25,9 @@ public:
 
   nod::signal<void()> started;
   nod::signal<void()> stopped;
-  nod::signal<void(pqrs::not_null_shared_ptr_t<std::vector<pqrs::osx::iokit_hid_value>>)> values_arrived;
+  // The values are valid only while the signal is being emitted.
+  // The vector is a reused buffer; slots may filter the values in place.
+  nod::signal<void(std::vector<pqrs::osx::iokit_hid_value>&)> values_arrived;
   nod::signal<void(const std::string&, pqrs::osx::iokit_return)> error_occurred;
 
   //
@@ -89,14 +91,14 @@ public:
     });
 
     device_events_monitor_->input_values_arrived.connect([this](auto&& values) {
-      auto hid_values = std::make_shared<std::vector<pqrs::osx::iokit_hid_value>>();
-      hid_values->reserve(values->size());
+      // Reuse the buffer to avoid allocations for each report.
+      hid_values_.clear();
 
       for (const auto& value : *values) {
-        hid_values->emplace_back(*value);
+        hid_values_.emplace_back(*value);
       }
 
-      input_values_arrived(hid_values);
+      input_values_arrived(hid_values_);
     });
 
     device_events_monitor_->input_report_arrived.connect(
@@ -105,12 +107,10 @@ public:
             return;
           }
 
-          auto hid_values = std::make_shared<std::vector<pqrs::osx::iokit_hid_value>>(
-              input_report_handler_->handle(
-                  report_id,
-                  report,
-                  time_stamp));
-          if (hid_values->empty()) {
+          auto hid_values = input_report_handler_->handle(report_id,
+                                                          report,
+                                                          time_stamp);
+          if (hid_values.empty()) {
             return;
           }
 
@@ -143,9 +143,8 @@ public:
   }
 
 private:
-  void input_values_arrived(
-      pqrs::not_null_shared_ptr_t<std::vector<pqrs::osx::iokit_hid_value>> hid_values) {
-    normalize_time_stamps(*hid_values);
+  void input_values_arrived(std::vector<pqrs::osx::iokit_hid_value>& hid_values) {
+    normalize_time_stamps(hid_values);
     values_arrived(hid_values);
   }
 
@@ -195,5 +194,6 @@ private:
   // handle and reset access handler state from the shared dispatcher thread.
   std::shared_ptr<hid_report_only_events::report_handler> input_report_handler_;
   pqrs::osx::chrono::absolute_time_point last_time_stamp_;
+  std::vector<pqrs::osx::iokit_hid_value> hid_values_;
 };
 } // namespace krbn
@@ -0,0 +1,203 @@
+#pragma once
+
+// `krbn::latency_tracer` is not thread-safe.
+// Use it in the shared dispatcher thread.
+
+#include "types/absolute_time_duration.hpp"
+#include <array>
+#include <bit>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <pqrs/osx/chrono.hpp>
+#include <spdlog/fmt/fmt.h>
+#include <string>
+#include <vector>
+
+namespace krbn {
+// A fixed-size log-linear histogram of durations in microseconds.
+// Each power of two is split into 16 buckets, so percentiles are accurate within 1/16.
+class latency_histogram final {
+public:
+  latency_histogram() : buckets_{},
+                        count_(0),
+                        max_(0) {
+  }
+
+  void record(std::chrono::nanoseconds value) {
+    auto us = static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(value).count(),
+                                                      0));
+
+    ++buckets_[make_bucket_index(us)];
+    ++count_;
+    max_ = std::max(max_, us);
+  }
+
+  [[nodiscard]] uint64_t get_count() const {
+    return count_;
+  }
+
+  // Return the lower bound of the bucket which contains the percentile.
+  [[nodiscard]] std::chrono::microseconds get_percentile(double percentile) const {
+    if (count_ == 0) {
+      return std::chrono::microseconds(0);
+    }
+
+    auto rank = static_cast<uint64_t>(static_cast<double>(count_) * percentile / 100.0);
+    if (rank >= count_) {
+      rank = count_ - 1;
+    }
+
+    uint64_t n = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      n += buckets_[i];
+      if (n > rank) {
+        return std::chrono::microseconds(std::min(make_bucket_lower_bound(i), max_));
+      }
+    }
+
+    return std::chrono::microseconds(max_);
+  }
+
+  [[nodiscard]] std::chrono::microseconds get_max() const {
+    return std::chrono::microseconds(max_);
+  }
+
+  [[nodiscard]] nlohmann::json to_json() const {
+    return nlohmann::json::object({
+        {"count", count_},
+        {"p50_us", get_percentile(50).count()},
+        {"p99_us", get_percentile(99).count()},
+        {"max_us", get_max().count()},
+    });
+  }
+
+private:
+  static constexpr size_t sub_bucket_bits = 4;
+  static constexpr size_t sub_bucket_count = 1 << sub_bucket_bits;
+  static constexpr size_t bucket_count = sub_bucket_count + (64 - sub_bucket_bits) * sub_bucket_count;
+
+  static size_t make_bucket_index(uint64_t value) {
+    if (value < sub_bucket_count) {
+      return value;
+    }
+
+    auto exponent = static_cast<size_t>(std::bit_width(value)) - 1;
+    auto shift = exponent - sub_bucket_bits;
+    return sub_bucket_count + shift * sub_bucket_count + ((value >> shift) - sub_bucket_count);
+  }
+
+  static uint64_t make_bucket_lower_bound(size_t index) {
+    if (index < sub_bucket_count) {
+      return index;
+    }
+
+    auto shift = (index - sub_bucket_count) / sub_bucket_count;
+    auto sub_bucket = (index - sub_bucket_count) % sub_bucket_count;
+    return (sub_bucket_count + sub_bucket) << shift;
+  }
+
+  std::array<uint64_t, bucket_count> buckets_;
+  uint64_t count_;
+  uint64_t max_;
+};
+
+// Collects per-keystroke latency through the manipulation pipeline.
+//
+// - `since_input`: Elapsed time from the input event time stamp until the entry left the stage.
+// - `manipulate`: Time spent in the manipulator_manager of the stage for each entry.
+// - `posted`: Delay of posting reports to the virtual devices from their scheduled time stamps.
+// - `coalesced_pointing_inputs`: The number of pointing_input reports which were removed by coalescing.
+//
+// The tracer is created only while tracing is enabled and callers hold it by pointer,
+// so disabled tracing costs a single null check per stage.
+class latency_tracer final {
+public:
+  class stage final {
+  public:
+    explicit stage(const std::string& name) : name_(name) {
+    }
+
+    [[nodiscard]] const std::string& get_name() const {
+      return name_;
+    }
+
+    [[nodiscard]] const latency_histogram& get_since_input() const {
+      return since_input_;
+    }
+
+    [[nodiscard]] const latency_histogram& get_manipulate() const {
+      return manipulate_;
+    }
+
+  private:
+    friend class latency_tracer;
+
+    std::string name_;
+    latency_histogram since_input_;
+    latency_histogram manipulate_;
+  };
+
+  latency_tracer(const latency_tracer&) = delete;
+
+  explicit latency_tracer(const std::vector<std::string>& stage_names)
+      : coalesced_pointing_inputs_(0) {
+    for (const auto& name : stage_names) {
+      stages_.emplace_back(name);
+    }
+  }
+
+  void record_stage(size_t stage_index,
+                    absolute_time_duration since_input,
+                    absolute_time_duration manipulate) {
+    while (stage_index >= stages_.size()) {
+      stages_.emplace_back(fmt::format("stage{0}", stages_.size()));
+    }
+
+    auto& s = stages_[stage_index];
+    s.since_input_.record(pqrs::osx::chrono::make_nanoseconds(since_input));
+    s.manipulate_.record(pqrs::osx::chrono::make_nanoseconds(manipulate));
+  }
+
+  void record_posted(absolute_time_duration since_input) {
+    posted_.record(pqrs::osx::chrono::make_nanoseconds(since_input));
+  }
+
+  void record_coalesced_pointing_inputs(size_t count) {
+    coalesced_pointing_inputs_ += count;
+  }
+
+  [[nodiscard]] const std::vector<stage>& get_stages() const {
+    return stages_;
+  }
+
+  [[nodiscard]] const latency_histogram& get_posted() const {
+    return posted_;
+  }
+
+  [[nodiscard]] uint64_t get_coalesced_pointing_inputs() const {
+    return coalesced_pointing_inputs_;
+  }
+
+  [[nodiscard]] nlohmann::json to_json() const {
+    auto stages = nlohmann::json::array();
+    for (const auto& s : stages_) {
+      stages.push_back(nlohmann::json::object({
+          {"name", s.get_name()},
+          {"since_input", s.get_since_input().to_json()},
+          {"manipulate", s.get_manipulate().to_json()},
+      }));
+    }
+
+    return nlohmann::json::object({
+        {"stages", stages},
+        {"posted", posted_.to_json()},
+        {"coalesced_pointing_inputs", coalesced_pointing_inputs_},
+    });
+  }
+
+private:
+  std::vector<stage> stages_;
+  latency_histogram posted_;
+  uint64_t coalesced_pointing_inputs_;
+};
+} // namespace krbn
@@ -1,96 +0,0 @@
-#pragma once
-
-#include "exprtk_utility.hpp"
-#include "manipulator/manipulator_environment.hpp"
-#include <gsl/gsl>
-#include <memory>
-#include <string>
-#include <thread>
-#include <unordered_map>
-#include <vector>
-
-namespace krbn::manipulator {
-
-// We manage all conditions::expression instances with a manager
-// because changing a variable via set_variable requires updating every instance.
-
-class condition_expression_manager final {
-public:
-  void insert(std::weak_ptr<exprtk_utility::expression_wrapper> expression) {
-    expressions_.push_back(expression);
-
-    // Set variables for new instance.
-    if (auto shared_ptr = expression.lock()) {
-      for (auto&& [name, value] : variables_) {
-        shared_ptr->set_variable(name, value);
-      }
-
-      for (auto&& [name, value] : string_variables_) {
-        shared_ptr->set_variable(name, value);
-      }
-    }
-  }
-
-  void set_variable(const std::string& name,
-                    double value) {
-    std::erase_if(expressions_, [&](auto&& weak_ptr) {
-      if (auto shared_ptr = weak_ptr.lock()) {
-        if (!exprtk_utility::is_string_variable_name(name)) {
-          shared_ptr->set_variable(name, value);
-          variables_.insert_or_assign(name, value);
-        }
-
-        return false;
-      }
-
-      return true;
-    });
-  }
-
-  void set_variable(const std::string& name,
-                    const std::string& value) {
-    std::erase_if(expressions_, [&](auto&& weak_ptr) {
-      if (auto shared_ptr = weak_ptr.lock()) {
-        if (exprtk_utility::is_string_variable_name(name)) {
-          shared_ptr->set_variable(name, value);
-          string_variables_.insert_or_assign(name, value);
-        }
-
-        return false;
-      }
-
-      return true;
-    });
-  }
-
-  void apply_environment_variables(const manipulator::manipulator_environment& manipulator_environment) {
-    std::erase_if(expressions_, [&](auto&& weak_ptr) {
-      if (auto shared_ptr = weak_ptr.lock()) {
-        manipulator_environment.apply_to_expression_variable(shared_ptr);
-
-        return false;
-      }
-
-      return true;
-    });
-  }
-
-private:
-  std::vector<std::weak_ptr<exprtk_utility::expression_wrapper>> expressions_;
-  std::unordered_map<std::string, double> variables_;
-  std::unordered_map<std::string, std::string> string_variables_;
-};
-
-[[nodiscard]] inline pqrs::not_null_shared_ptr_t<condition_expression_manager> get_shared_condition_expression_manager() {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> lock(mutex);
-
-  static std::shared_ptr<condition_expression_manager> p;
-  if (!p) {
-    p = std::make_shared<condition_expression_manager>();
-  }
-
-  return p;
-}
-
-} // namespace krbn::manipulator
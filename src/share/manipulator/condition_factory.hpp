@@ -1,6 +1,5 @@
 #pragma once
 
-#include "condition_expression_manager.hpp"
 #include "conditions/device.hpp"
 #include "conditions/event_changed.hpp"
 #include "conditions/expression.hpp"
@@ -35,9 +34,7 @@ inline pqrs::not_null_shared_ptr_t<conditions::base> make_condition(const nlohma
     return std::make_shared<conditions::event_changed>(json);
   } else if (type == "expression_if" ||
              type == "expression_unless") {
-    auto c = std::make_shared<conditions::expression>(json);
-    get_shared_condition_expression_manager()->insert(c->get_expression());
-    return c;
+    return std::make_shared<conditions::expression>(json);
   } else if (type == "frontmost_application_if" ||
              type == "frontmost_application_unless") {
     return std::make_shared<conditions::frontmost_application>(json);
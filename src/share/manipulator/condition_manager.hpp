@@ -25,9 +25,10 @@ public:
     //
     // Update condition expression variables
     //
+    // Variables are applied to each expression in conditions::expression::is_fulfilled.
+    //
 
     manipulator_environment.set_variable_system_now_milliseconds();
-    get_shared_condition_expression_manager()->apply_environment_variables(manipulator_environment);
 
     //
     // Evaluate condition rules.
@@ -62,6 +62,43 @@ public:
 
   bool is_fulfilled(const condition_context& condition_context,
                     const manipulator_environment& manipulator_environment) const override {
+    // Device properties and the configuration are not changed until manipulator_environment::get_devices_generation is updated.
+    // (device_grabbed, device_ungrabbed or configuration reload)
+    // So we cache results per device_id.
+
+    auto generation = manipulator_environment.get_devices_generation();
+    if (cached_generation_ != generation) {
+      cached_generation_ = generation;
+      cached_results_.clear();
+    }
+
+    // The result of device_exists_* does not depend on condition_context.device_id.
+    auto device_id = condition_context.device_id;
+    switch (type_) {
+      case type::device_if:
+      case type::device_unless:
+        break;
+      case type::device_exists_if:
+      case type::device_exists_unless:
+        device_id = krbn::device_id(0);
+        break;
+    }
+
+    for (const auto& [id, result] : cached_results_) {
+      if (id == device_id) {
+        return result;
+      }
+    }
+
+    auto result = evaluate(condition_context,
+                           manipulator_environment);
+    cached_results_.emplace_back(device_id, result);
+    return result;
+  }
+
+private:
+  bool evaluate(const condition_context& condition_context,
+                const manipulator_environment& manipulator_environment) const {
     if (!definitions_.empty()) {
       switch (type_) {
         case type::device_if:
@@ -114,7 +151,6 @@ public:
     }
   }
 
-private:
   struct definition final {
     std::optional<pqrs::hid::vendor_id::value_t> vendor_id;
     std::optional<pqrs::hid::product_id::value_t> product_id;
@@ -261,5 +297,9 @@ private:
 
   type type_;
   std::vector<definition> definitions_;
+
+  // The number of grabbed devices is small, so we use std::vector instead of std::unordered_map.
+  mutable std::optional<uint64_t> cached_generation_;
+  mutable std::vector<std::pair<krbn::device_id, bool>> cached_results_;
 };
 } // namespace krbn::manipulator::conditions
@@ -51,6 +51,8 @@ public:
   bool is_fulfilled(const condition_context& condition_context,
                     const manipulator_environment& manipulator_environment) const override {
     if (expression_) {
+      manipulator_environment.apply_to_expression_variable(expression_);
+
       auto value = expression_->value();
       if (std::isnan(value)) {
         return false;
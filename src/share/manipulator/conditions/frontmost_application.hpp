@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base.hpp"
+#include "regex_matcher.hpp"
 #include <pqrs/regex.hpp>
 #include <regex>
 #include <string>
@@ -18,6 +19,9 @@ public:
                                                       type_(type::frontmost_application_if) {
     pqrs::json::requires_object(json, "json");
 
+    std::vector<pqrs::regex> bundle_identifiers;
+    std::vector<pqrs::regex> file_paths;
+
     for (const auto& [key, value] : json.items()) {
       // key is always std::string.
 
@@ -38,7 +42,7 @@ public:
         pqrs::json::requires_array(value, "`bundle_identifiers`");
 
         try {
-          bundle_identifiers_ = value.get<std::vector<pqrs::regex>>();
+          bundle_identifiers = value.get<std::vector<pqrs::regex>>();
         } catch (std::exception& e) {
           throw pqrs::json::unmarshal_error(fmt::format("`{0}` error: {1}", key, e.what()));
         }
@@ -47,7 +51,7 @@ public:
         pqrs::json::requires_array(value, "`file_paths`");
 
         try {
-          file_paths_ = value.get<std::vector<pqrs::regex>>();
+          file_paths = value.get<std::vector<pqrs::regex>>();
         } catch (std::exception& e) {
           throw pqrs::json::unmarshal_error(fmt::format("`{0}` error: {1}", key, e.what()));
         }
@@ -59,6 +63,9 @@ public:
         throw pqrs::json::unmarshal_error(fmt::format("unknown key `{0}` in `{1}`", key, pqrs::json::dump_for_error_message(json)));
       }
     }
+
+    bundle_identifiers_matcher_ = regex_matcher(bundle_identifiers);
+    file_paths_matcher_ = regex_matcher(file_paths);
   }
 
   ~frontmost_application() override {
@@ -66,71 +73,49 @@ public:
 
   bool is_fulfilled(const condition_context& condition_context,
                     const manipulator_environment& manipulator_environment) const override {
-    if (cached_result_ && cached_result_->first == manipulator_environment.get_frontmost_application()) {
+    // The result depends only on the frontmost application.
+    // Reuse the result until the frontmost application is changed.
+    auto generation = manipulator_environment.get_frontmost_application_generation();
+    if (cached_result_ && cached_result_->first == generation) {
       return cached_result_->second;
     }
 
-    bool result = false;
+    bool matched = false;
 
     // Bundle identifiers
 
     if (auto& current_bundle_identifier = manipulator_environment.get_frontmost_application().get_bundle_identifier()) {
-      for (const auto& b : bundle_identifiers_) {
-        if (regex_search(std::begin(*current_bundle_identifier),
-                         std::end(*current_bundle_identifier),
-                         b.get_regex())) {
-          switch (type_) {
-            case type::frontmost_application_if:
-              result = true;
-              goto finish;
-            case type::frontmost_application_unless:
-              result = false;
-              goto finish;
-          }
-        }
-      }
+      matched = bundle_identifiers_matcher_.search(*current_bundle_identifier);
     }
 
     // File paths
 
-    if (auto& current_file_path = manipulator_environment.get_frontmost_application().get_file_path()) {
-      for (const auto& f : file_paths_) {
-        if (regex_search(std::begin(*current_file_path),
-                         std::end(*current_file_path),
-                         f.get_regex())) {
-          switch (type_) {
-            case type::frontmost_application_if:
-              result = true;
-              goto finish;
-            case type::frontmost_application_unless:
-              result = false;
-              goto finish;
-          }
-        }
+    if (!matched) {
+      if (auto& current_file_path = manipulator_environment.get_frontmost_application().get_file_path()) {
+        matched = file_paths_matcher_.search(*current_file_path);
       }
     }
 
-    // Not found
-
+    bool result = false;
     switch (type_) {
       case type::frontmost_application_if:
-        result = false;
-        goto finish;
+        result = matched;
+        break;
       case type::frontmost_application_unless:
-        result = true;
-        goto finish;
+        result = !matched;
+        break;
     }
 
-  finish:
-    cached_result_ = std::make_pair(manipulator_environment.get_frontmost_application(), result);
+    cached_result_ = std::make_pair(generation, result);
     return result;
   }
 
 private:
   type type_;
-  std::vector<pqrs::regex> bundle_identifiers_;
-  std::vector<pqrs::regex> file_paths_;
+  regex_matcher bundle_identifiers_matcher_;
+  regex_matcher file_paths_matcher_;
 
-  mutable std::optional<std::pair<application, bool>> cached_result_;
+  // A pair of manipulator_environment::get_frontmost_application_generation and the result.
+  mutable std::optional<std::pair<uint64_t, bool>> cached_result_;
 };
 } // namespace krbn::manipulator::conditions
@@ -55,6 +55,8 @@ public:
     if (!value_) {
       throw pqrs::json::unmarshal_error(fmt::format("`value` is not found in `{0}`", pqrs::json::dump_for_error_message(json)));
     }
+
+    slot_id_ = get_shared_variable_slot_registry()->intern(*name_);
   }
 
   ~variable() override {
@@ -64,9 +66,9 @@ public:
                     const manipulator_environment& manipulator_environment) const override {
     switch (type_) {
       case type::variable_if:
-        return manipulator_environment.get_variable(*name_) == *value_;
+        return manipulator_environment.get_variable(slot_id_) == *value_;
       case type::variable_unless:
-        return manipulator_environment.get_variable(*name_) != *value_;
+        return manipulator_environment.get_variable(slot_id_) != *value_;
     }
   }
 
@@ -74,5 +76,6 @@ private:
   type type_;
   std::optional<std::string> name_;
   std::optional<manipulator_environment_variable_value> value_;
+  variable_slot_id slot_id_;
 };
 } // namespace krbn::manipulator::conditions
@@ -4,7 +4,10 @@
 #include "device_properties_manager.hpp"
 #include "json_writer.hpp"
 #include "logger.hpp"
+#include "variable_slot_registry.hpp"
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <fstream>
 #include <gsl/gsl>
 #include <iostream>
@@ -21,7 +24,11 @@ public:
   manipulator_environment(const manipulator_environment&) = delete;
 
   manipulator_environment()
-      : core_configuration_(std::make_shared<core_configuration::core_configuration>()) {
+      : id_(make_id()),
+        variables_version_(0),
+        devices_generation_(make_generation()),
+        frontmost_application_generation_(make_generation()),
+        core_configuration_(std::make_shared<core_configuration::core_configuration>()) {
     karabiner_machine_identifier_ = constants::get_karabiner_machine_identifier();
   }
 
@@ -41,7 +48,7 @@ public:
         {"frontmost_application", frontmost_application_},
         {"input_source", input_source_json},
         {"karabiner_machine_identifier", type_safe::get(karabiner_machine_identifier_)},
-        {"variables", variables_},
+        {"variables", make_variables_json()},
         {"virtual_hid_devices_state", virtual_hid_devices_state_},
     });
   }
@@ -65,10 +72,19 @@ public:
   void insert_device_properties(device_id device_id,
                                 pqrs::not_null_shared_ptr_t<device_properties> device_properties) {
     device_properties_manager_.insert(device_id, device_properties);
+    devices_generation_ = make_generation();
   }
 
   void erase_device_properties(device_id device_id) {
     device_properties_manager_.erase(device_id);
+    devices_generation_ = make_generation();
+  }
+
+  // The generation is updated when device properties or core_configuration are changed.
+  // Generations are unique among manipulator_environment instances,
+  // so conditions can cache results per device with the generation.
+  [[nodiscard]] uint64_t get_devices_generation() const {
+    return devices_generation_;
   }
 
   [[nodiscard]] const application& get_frontmost_application() const {
@@ -76,7 +92,17 @@ public:
   }
 
   void set_frontmost_application(const application& value) {
-    frontmost_application_ = value;
+    if (frontmost_application_ != value) {
+      frontmost_application_ = value;
+      frontmost_application_generation_ = make_generation();
+    }
+  }
+
+  // The generation is updated when the frontmost application is changed.
+  // Generations are unique among manipulator_environment instances,
+  // so conditions can cache results with the generation.
+  [[nodiscard]] uint64_t get_frontmost_application_generation() const {
+    return frontmost_application_generation_;
   }
 
   [[nodiscard]] const pqrs::osx::input_source::properties& get_input_source_properties() const {
@@ -88,30 +114,71 @@ public:
   }
 
   [[nodiscard]] manipulator_environment_variable_value get_variable(const std::string& name) const {
-    auto it = variables_.find(name);
-    if (it != std::end(variables_)) {
-      return it->second;
+    if (auto slot_id = get_shared_variable_slot_registry()->find(name)) {
+      return get_variable(*slot_id);
     }
     return manipulator_environment_variable_value();
   }
 
+  [[nodiscard]] const manipulator_environment_variable_value& get_variable(variable_slot_id slot_id) const {
+    static const manipulator_environment_variable_value default_value;
+
+    if (slot_id < variables_.size()) {
+      if (auto& v = variables_[slot_id]) {
+        return *v;
+      }
+    }
+    return default_value;
+  }
+
   void set_variable(const std::string& name, const manipulator_environment_variable_value& value) {
-    // logger::get_logger()->info("set_variable {0} {1}", name, value);
-    variables_[name] = value;
-    unset_variable_names_.erase(name);
+    set_variable(get_shared_variable_slot_registry()->intern(name), value);
+  }
+
+  void set_variable(variable_slot_id slot_id, const manipulator_environment_variable_value& value) {
+    // logger::get_logger()->info("set_variable {0} {1}", slot_id, value);
+    if (slot_id >= variables_.size()) {
+      variables_.resize(slot_id + 1);
+    }
+
+    auto& v = variables_[slot_id];
+    if (v == value) {
+      return;
+    }
+    v = value;
+
+    push_back_variable_change(slot_id);
   }
 
   void unset_variable(const std::string& name) {
-    variables_.erase(name);
-    unset_variable_names_.insert(name);
+    if (auto slot_id = get_shared_variable_slot_registry()->find(name)) {
+      unset_variable(*slot_id);
+    }
+  }
+
+  void unset_variable(variable_slot_id slot_id) {
+    if (slot_id < variables_.size()) {
+      auto& v = variables_[slot_id];
+      if (v) {
+        v = std::nullopt;
+        push_back_variable_change(slot_id);
+      }
+    }
+  }
+
+  // The version is increased each time a variable is changed or unset.
+  [[nodiscard]] uint64_t get_variables_version() const {
+    return variables_version_;
   }
 
   [[nodiscard]] std::vector<std::string> get_variable_names() const {
     std::vector<std::string> names;
 
-    names.reserve(variables_.size());
-    for (const auto& [name, value] : variables_) {
-      names.push_back(name);
+    auto registry = get_shared_variable_slot_registry();
+    for (variable_slot_id slot_id = 0; slot_id < variables_.size(); ++slot_id) {
+      if (variables_[slot_id]) {
+        names.push_back(registry->get_name(slot_id));
+      }
     }
 
     std::sort(std::begin(names), std::end(names));
@@ -120,20 +187,47 @@ public:
   }
 
   void set_variable_system_now_milliseconds() {
+    static const auto slot_id = get_shared_variable_slot_registry()->intern("system.now.milliseconds");
+
     auto now = std::chrono::system_clock::now();
     auto now_milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
     auto now_int64 = static_cast<int64_t>(now_milliseconds.count());
-    set_variable("system.now.milliseconds", manipulator_environment_variable_value(now_int64));
+    set_variable(slot_id, manipulator_environment_variable_value(now_int64));
   }
 
+  // Apply variables to the expression.
+  // Only the variables changed since the last call are applied when the expression was last updated by this instance.
+  // Otherwise, all variables referenced in the expression are applied.
   void apply_to_expression_variable(pqrs::not_null_shared_ptr_t<exprtk_utility::expression_wrapper> expression) const {
-    for (const auto& name : unset_variable_names_) {
-      expression->unset_variable(name);
-    }
+    auto applied_variables_version = expression->get_applied_variables_version();
 
-    for (const auto& [name, value] : variables_) {
-      value.apply_to_expression_variable(name, expression);
+    // The version just before the oldest entry in variable_change_log_.
+    auto oldest_version = variables_version_ - variable_change_log_.size();
+
+    if (applied_variables_version &&
+        applied_variables_version->store_id == id_ &&
+        applied_variables_version->version >= oldest_version) {
+      if (applied_variables_version->version == variables_version_) {
+        return;
+      }
+
+      // exprtk_utility::expression_wrapper ignores variables which are not referenced in the expression.
+      for (auto it = std::next(std::begin(variable_change_log_), applied_variables_version->version - oldest_version);
+           it != std::end(variable_change_log_);
+           ++it) {
+        apply_variable_to_expression(*it, expression);
+      }
+
+    } else {
+      for (const auto& slot_id : expression->get_variable_slot_ids()) {
+        apply_variable_to_expression(slot_id, expression);
+      }
     }
+
+    expression->set_applied_variables_version(exprtk_utility::applied_variables_version{
+        .store_id = id_,
+        .version = variables_version_,
+    });
   }
 
   [[nodiscard]] pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> get_core_configuration() const {
@@ -142,6 +236,7 @@ public:
 
   void set_core_configuration(pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration) {
     core_configuration_ = core_configuration;
+    devices_generation_ = make_generation();
   }
 
   void set_virtual_hid_devices_state(const virtual_hid_devices_state& value) {
@@ -149,13 +244,65 @@ public:
   }
 
 private:
+  nlohmann::json make_variables_json() const {
+    auto json = nlohmann::json::object();
+
+    auto registry = get_shared_variable_slot_registry();
+    for (variable_slot_id slot_id = 0; slot_id < variables_.size(); ++slot_id) {
+      if (auto& v = variables_[slot_id]) {
+        json[registry->get_name(slot_id)] = *v;
+      }
+    }
+
+    return json;
+  }
+
+  static uint64_t make_id() {
+    static std::atomic<uint64_t> id(0);
+    return ++id;
+  }
+
+  static uint64_t make_generation() {
+    static std::atomic<uint64_t> generation(0);
+    return ++generation;
+  }
+
+  void push_back_variable_change(variable_slot_id slot_id) {
+    ++variables_version_;
+
+    variable_change_log_.push_back(slot_id);
+    while (variable_change_log_.size() > variable_change_log_max_size_) {
+      variable_change_log_.pop_front();
+    }
+  }
+
+  void apply_variable_to_expression(variable_slot_id slot_id,
+                                    pqrs::not_null_shared_ptr_t<exprtk_utility::expression_wrapper> expression) const {
+    if (slot_id < variables_.size()) {
+      if (auto& v = variables_[slot_id]) {
+        v->apply_to_expression_variable(slot_id, expression);
+        return;
+      }
+    }
+
+    expression->unset_variable(slot_id);
+  }
+
+  // Expressions which are older than the change log are fully updated.
+  static constexpr size_t variable_change_log_max_size_ = 1024;
+
+  uint64_t id_;
   karabiner_machine_identifier karabiner_machine_identifier_;
   device_properties_manager device_properties_manager_;
   application frontmost_application_;
   pqrs::osx::input_source::properties input_source_properties_;
-  std::unordered_map<std::string, manipulator_environment_variable_value> variables_;
-  // Used to remove unset variables from expression_wrapper.
-  std::unordered_set<std::string> unset_variable_names_;
+  // Indexed by variable_slot_id. std::nullopt means that the variable is not set.
+  std::vector<std::optional<manipulator_environment_variable_value>> variables_;
+  uint64_t variables_version_;
+  // The slot ids of changed variables. The last entry corresponds to variables_version_.
+  std::deque<variable_slot_id> variable_change_log_;
+  uint64_t devices_generation_;
+  uint64_t frontmost_application_generation_;
   pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration_;
   virtual_hid_devices_state virtual_hid_devices_state_;
 };
@@ -1,8 +1,19 @@
 #pragma once
 
 #include "manipulator/manipulator_factory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <pqrs/hash.hpp>
+#include <pqrs/hid.hpp>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace krbn::manipulator {
+// `manipulate` has to be called from a single thread (the shared dispatcher thread).
+// Other methods can be called from any thread.
 class manipulator_manager final {
 public:
   manipulator_manager(const manipulator_manager&) = delete;
@@ -22,7 +33,8 @@ public:
       {
         std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
-        manipulators_.push_back(m);
+        manipulators_.push_back(manipulator_entry{m, nullptr});
+        publish_snapshot();
       }
 
     } catch (const pqrs::json::unmarshal_error& e) {
@@ -36,7 +48,117 @@ public:
   void push_back_manipulator(pqrs::not_null_shared_ptr_t<manipulators::base> ptr) {
     std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
-    manipulators_.push_back(ptr);
+    manipulators_.push_back(manipulator_entry{ptr, nullptr});
+    publish_snapshot();
+  }
+
+  // The content which a manipulator given to `update_manipulators` is built from.
+  // Manipulators which have the same content are built into the same manipulator.
+  class manipulator_content final {
+  public:
+    manipulator_content(const nlohmann::json& json,
+                        const nlohmann::json& parameters_json)
+        : json_(json),
+          parameters_json_(parameters_json),
+          hash_(std::hash<nlohmann::json>{}(json_)) {
+      pqrs::hash::combine(hash_, parameters_json_);
+    }
+
+    [[nodiscard]] size_t get_hash() const {
+      return hash_;
+    }
+
+    bool operator==(const manipulator_content& other) const {
+      return hash_ == other.hash_ &&
+             json_ == other.json_ &&
+             parameters_json_ == other.parameters_json_;
+    }
+
+  private:
+    nlohmann::json json_;
+    nlohmann::json parameters_json_;
+    size_t hash_;
+  };
+
+  // Replace all manipulators with manipulators which are built from `contents` in the given order.
+  //
+  // Manipulators which were added by the previous `update_manipulators` with the same content are reused
+  // with their state (e.g., pressed from events, pending to_delayed_action).
+  // `make_manipulator(index)` is called only for added or changed entries, and it can return nullptr on error.
+  // It is called without locking, so building manipulators does not block `manipulate`.
+  // The other existing manipulators are invalidated as `invalidate_manipulators` does.
+  //
+  // Returns the number of reused manipulators.
+  size_t update_manipulators(std::vector<manipulator_content>&& contents,
+                             const std::function<std::shared_ptr<manipulators::base>(size_t index)>& make_manipulator) {
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+
+    size_t reused_count = 0;
+
+    std::unordered_map<size_t, std::deque<manipulator_entry>> reusable_manipulators;
+    {
+      std::lock_guard<std::mutex> lock(manipulators_mutex_);
+
+      for (const auto& e : manipulators_) {
+        if (e.content &&
+            e.manipulator->get_validity() == validity::valid) {
+          reusable_manipulators[e.content->get_hash()].push_back(e);
+        }
+      }
+    }
+
+    std::vector<manipulator_entry> new_manipulators;
+    new_manipulators.reserve(contents.size());
+    std::unordered_set<const manipulators::base*> reused_manipulators;
+
+    for (size_t i = 0; i < contents.size(); ++i) {
+      auto content = std::make_shared<const manipulator_content>(std::move(contents[i]));
+
+      if (auto it = reusable_manipulators.find(content->get_hash()); it != std::end(reusable_manipulators)) {
+        auto& candidates = it->second;
+        // Compare the contents since different contents may have the same hash.
+        if (auto c = std::ranges::find_if(candidates,
+                                          [&](const auto& e) {
+                                            return *(e.content) == *content;
+                                          });
+            c != std::end(candidates)) {
+          reused_manipulators.insert(c->manipulator.get().get());
+          new_manipulators.push_back(std::move(*c));
+          candidates.erase(c);
+          ++reused_count;
+          continue;
+        }
+      }
+
+      if (auto m = make_manipulator(i)) {
+        new_manipulators.push_back(manipulator_entry{m, content});
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(manipulators_mutex_);
+
+      // Keep removed manipulators before the new manipulators until they become inactive.
+
+      std::erase_if(manipulators_,
+                    [&](const auto& e) {
+                      return reused_manipulators.contains(e.manipulator.get().get());
+                    });
+
+      for (auto&& e : manipulators_) {
+        e.manipulator->set_validity(validity::invalid);
+      }
+
+      manipulators_.insert(std::end(manipulators_),
+                           std::make_move_iterator(std::begin(new_manipulators)),
+                           std::make_move_iterator(std::end(new_manipulators)));
+
+      publish_snapshot();
+    }
+
+    remove_invalid_manipulators();
+
+    return reused_count;
   }
 
   /**
@@ -48,6 +170,8 @@ public:
                   pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration) {
     if (auto input_event_queue = weak_input_event_queue.lock()) {
       if (auto output_event_queue = weak_output_event_queue.lock()) {
+        update_snapshot();
+
         if (!input_event_queue->empty()) {
           auto& front_input_event = input_event_queue->get_front_event();
 
@@ -56,13 +180,9 @@ public:
               output_event_queue->erase_all_active_modifier_flags_except_lock_and_sticky(front_input_event.get_device_id());
               output_event_queue->erase_all_active_pointing_buttons_except_lock(front_input_event.get_device_id());
 
-              {
-                std::lock_guard<std::mutex> lock(manipulators_mutex_);
-
-                for (auto&& m : manipulators_) {
-                  m->handle_device_keys_and_pointing_buttons_are_released_event(front_input_event,
-                                                                                *output_event_queue);
-                }
+              for (auto&& m : snapshot_->manipulators) {
+                m->handle_device_keys_and_pointing_buttons_are_released_event(front_input_event,
+                                                                              *output_event_queue);
               }
               break;
 
@@ -72,31 +192,26 @@ public:
               output_event_queue->erase_all_active_modifier_flags(front_input_event.get_device_id());
               output_event_queue->erase_all_active_pointing_buttons(front_input_event.get_device_id());
 
-              {
-                std::lock_guard<std::mutex> lock(manipulators_mutex_);
-
-                for (auto&& m : manipulators_) {
-                  m->handle_device_ungrabbed_event(front_input_event.get_device_id(),
-                                                   *output_event_queue,
-                                                   front_input_event.get_event_time_stamp().get_time_stamp());
-                }
+              for (auto&& m : snapshot_->manipulators) {
+                m->handle_device_ungrabbed_event(front_input_event.get_device_id(),
+                                                 *output_event_queue,
+                                                 front_input_event.get_event_time_stamp().get_time_stamp());
               }
               break;
 
-            case event_queue::event::type::pointing_device_event_from_event_tap: {
-              std::lock_guard<std::mutex> lock(manipulators_mutex_);
-
-              for (auto&& m : manipulators_) {
+            case event_queue::event::type::pointing_device_event_from_event_tap:
+              for (auto&& m : snapshot_->manipulators) {
                 m->handle_pointing_device_event_from_event_tap(front_input_event,
                                                                *output_event_queue);
               }
-            } break;
+              break;
 
             case event_queue::event::type::none:
             case event_queue::event::type::device_grabbed:
             case event_queue::event::type::frontmost_application_changed:
             case event_queue::event::type::input_source_changed:
             case event_queue::event::type::set_variable:
+            case event_queue::event::type::set_variables:
             case event_queue::event::type::virtual_hid_devices_state_changed:
               // Do nothing
               break;
@@ -115,11 +230,11 @@ public:
             case event_queue::event::type::system_preferences_properties_changed: {
               bool skip = false;
 
-              if (front_input_event.get_validity() == validity::valid) {
-                std::lock_guard<std::mutex> lock(manipulators_mutex_);
+              update_candidate_indices(front_input_event.get_event());
 
-                for (auto&& m : manipulators_) {
-                  if (m->already_manipulated(front_input_event)) {
+              if (front_input_event.get_validity() == validity::valid) {
+                for (const auto& i : candidate_indices_) {
+                  if (snapshot_->manipulators[i]->already_manipulated(front_input_event)) {
                     front_input_event.set_validity(validity::invalid);
                     skip = true;
                     break;
@@ -128,14 +243,15 @@ public:
               }
 
               if (!skip) {
-                std::lock_guard<std::mutex> lock(manipulators_mutex_);
-
-                for (auto&& m : manipulators_) {
+                for (const auto& i : candidate_indices_) {
+                  auto& m = snapshot_->manipulators[i];
                   auto r = m->manipulate(front_input_event,
                                          *input_event_queue,
                                          output_event_queue,
                                          now);
 
+                  set_active(i, m->needs_all_events());
+
                   switch (r) {
                     case manipulate_result::passed:
                     case manipulate_result::manipulated:
@@ -165,7 +281,9 @@ public:
         }
 
       finish:
-        remove_invalid_manipulators();
+        if (snapshot_->has_invalid_manipulators) {
+          remove_invalid_manipulators();
+        }
       }
     }
 
@@ -173,12 +291,15 @@ public:
   }
 
   void invalidate_manipulators() {
+    std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+
     {
       std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
-      for (auto&& m : manipulators_) {
-        m->set_validity(validity::invalid);
+      for (auto&& e : manipulators_) {
+        e.manipulator->set_validity(validity::invalid);
       }
+      publish_snapshot();
     }
 
     remove_invalid_manipulators();
@@ -195,25 +316,169 @@ public:
 
     return std::any_of(std::begin(manipulators_),
                        std::end(manipulators_),
-                       [](auto& m) {
-                         return m->needs_virtual_hid_pointing();
+                       [](auto& e) {
+                         return e.manipulator->needs_virtual_hid_pointing();
                        });
   }
 
 private:
+  struct manipulator_entry final {
+    pqrs::not_null_shared_ptr_t<manipulators::base> manipulator;
+    // The content which is given by `update_manipulators`.
+    std::shared_ptr<const manipulator_content> content;
+  };
+
+  // An immutable copy of `manipulators_` and the dispatch index which is used in `manipulate` without locking.
+  struct snapshot final {
+    std::vector<pqrs::not_null_shared_ptr_t<manipulators::base>> manipulators;
+    // Index for skipping manipulators which never match the front event.
+    std::unordered_map<pqrs::hid::usage_pair, std::vector<size_t>> usage_pair_indices;
+    std::unordered_map<pqrs::hid::usage_page::value_t, std::vector<size_t>> usage_page_indices;
+    std::vector<size_t> all_events_indices;
+    bool has_invalid_manipulators = false;
+  };
+
   void remove_invalid_manipulators() {
     std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
-    manipulators_.erase(std::remove_if(std::begin(manipulators_),
-                                       std::end(manipulators_),
-                                       [](const auto& it) {
-                                         // Keep active manipulators.
-                                         return it->get_validity() == validity::invalid && !it->active();
-                                       }),
-                        std::end(manipulators_));
+    auto it = std::remove_if(std::begin(manipulators_),
+                             std::end(manipulators_),
+                             [](const auto& it) {
+                               // Keep active manipulators.
+                               return it.manipulator->get_validity() == validity::invalid && !it.manipulator->active();
+                             });
+    if (it != std::end(manipulators_)) {
+      manipulators_.erase(it, std::end(manipulators_));
+      publish_snapshot();
+    }
+  }
+
+  // Rebuild the snapshot and the dispatch index from `manipulators_` and publish it to `manipulate`.
+  // Writers rebuild the snapshot, so `manipulate` does not pay the cost on the first event after configuration reload.
+  // This method requires `manipulators_mutex_` to be locked.
+  void publish_snapshot() {
+    auto s = std::make_shared<snapshot>();
+
+    s->manipulators.reserve(manipulators_.size());
+    for (const auto& e : manipulators_) {
+      s->manipulators.push_back(e.manipulator);
+    }
+
+    for (size_t i = 0; i < s->manipulators.size(); ++i) {
+      auto& m = s->manipulators[i];
+
+      if (auto definitions = m->get_dispatch_event_definitions()) {
+        for (const auto& d : *definitions) {
+          if (auto e = d.get_if<momentary_switch_event>()) {
+            push_back_index(s->usage_pair_indices[e->get_usage_pair()], i);
+          } else if (auto any_type = d.get_if<event_definition::any_type>()) {
+            push_back_index(s->usage_page_indices[event_definition::get_usage_page(*any_type)], i);
+          }
+        }
+      } else {
+        s->all_events_indices.push_back(i);
+      }
+
+      if (m->get_validity() == validity::invalid) {
+        s->has_invalid_manipulators = true;
+      }
+    }
+
+    published_snapshot_ = s;
+    manipulators_generation_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Adopt the published snapshot if manipulators are changed since the last call.
+  // The hot path does only one acquire load.
+  void update_snapshot() {
+    auto generation = manipulators_generation_.load(std::memory_order_acquire);
+    if (snapshot_ && snapshot_generation_ == generation) {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(manipulators_mutex_);
+
+      snapshot_ = published_snapshot_;
+      snapshot_generation_ = manipulators_generation_.load(std::memory_order_relaxed);
+    }
+
+    // Reserve the full size so that `set_active` does not allocate in the event path.
+    auto size = snapshot_->manipulators.size();
+    active_flags_.assign(size, 0);
+    active_indices_.clear();
+    active_indices_.reserve(size);
+
+    for (size_t i = 0; i < size; ++i) {
+      if (snapshot_->manipulators[i]->needs_all_events()) {
+        set_active(i, true);
+      }
+    }
+  }
+
+  void set_active(size_t index, bool value) {
+    if (static_cast<bool>(active_flags_[index]) == value) {
+      return;
+    }
+
+    active_flags_[index] = value;
+
+    auto it = std::ranges::lower_bound(active_indices_, index);
+    if (value) {
+      active_indices_.insert(it, index);
+    } else {
+      active_indices_.erase(it);
+    }
+  }
+
+  // Collect indices of manipulators which have to receive the event in rule order.
+  void update_candidate_indices(const event_queue::event& event) {
+    candidate_indices_.clear();
+
+    if (auto e = event.get_if<momentary_switch_event>()) {
+      auto usage_pair = e->get_usage_pair();
+
+      if (auto it = snapshot_->usage_pair_indices.find(usage_pair); it != std::end(snapshot_->usage_pair_indices)) {
+        candidate_indices_.insert(std::end(candidate_indices_), std::begin(it->second), std::end(it->second));
+      }
+
+      if (e->valid()) {
+        if (auto it = snapshot_->usage_page_indices.find(usage_pair.get_usage_page()); it != std::end(snapshot_->usage_page_indices)) {
+          candidate_indices_.insert(std::end(candidate_indices_), std::begin(it->second), std::end(it->second));
+        }
+      }
+    }
+
+    candidate_indices_.insert(std::end(candidate_indices_), std::begin(snapshot_->all_events_indices), std::end(snapshot_->all_events_indices));
+    candidate_indices_.insert(std::end(candidate_indices_), std::begin(active_indices_), std::end(active_indices_));
+
+    std::ranges::sort(candidate_indices_);
+    candidate_indices_.erase(std::unique(std::begin(candidate_indices_), std::end(candidate_indices_)),
+                             std::end(candidate_indices_));
+  }
+
+  static void push_back_index(std::vector<size_t>& indices, size_t index) {
+    if (indices.empty() || indices.back() != index) {
+      indices.push_back(index);
+    }
   }
 
-  std::vector<pqrs::not_null_shared_ptr_t<manipulators::base>> manipulators_;
+  std::vector<manipulator_entry> manipulators_;
+  // The snapshot of `manipulators_` which is rebuilt in `publish_snapshot`. (guarded by `manipulators_mutex_`)
+  std::shared_ptr<const snapshot> published_snapshot_ = std::make_shared<snapshot>();
+  std::atomic<uint64_t> manipulators_generation_{0};
   mutable std::mutex manipulators_mutex_;
+  // Serializes `update_manipulators` and `invalidate_manipulators`.
+  // (`update_manipulators` builds manipulators without locking `manipulators_mutex_`.)
+  std::mutex writer_mutex_;
+
+  // The following members are used only in `manipulate`.
+  std::shared_ptr<const snapshot> snapshot_;
+  uint64_t snapshot_generation_ = 0;
+  // Manipulators which have to receive all events. (e.g., the from key is held down.)
+  // `active_flags_` is indexed by manipulator and `active_indices_` holds the active indices in ascending order.
+  std::vector<uint8_t> active_flags_;
+  std::vector<size_t> active_indices_;
+  std::vector<size_t> candidate_indices_;
 };
 } // namespace krbn::manipulator
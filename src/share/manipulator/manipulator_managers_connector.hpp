@@ -1,10 +1,13 @@
 #pragma once
 
 // `krbn::manipulator::manipulator_managers_connector` can be used safely in a multi-threaded environment.
+// (`manipulate` and `min_input_event_time_stamp` have to be called from a single thread.)
 
 #include "event_queue.hpp"
+#include "latency_tracer.hpp"
 #include "logger.hpp"
 #include "manipulator/manipulator_manager.hpp"
+#include <atomic>
 #include <mutex>
 #include <pqrs/gsl.hpp>
 
@@ -28,8 +31,19 @@ public:
     }
 
     void manipulate(absolute_time_point now,
-                    pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration) const {
+                    pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration,
+                    latency_tracer* tracer,
+                    size_t stage_index) const {
       if (auto manipulator_manager = weak_manipulator_manager_.lock()) {
+        if (tracer) {
+          manipulate_with_latency_tracer(*manipulator_manager,
+                                         now,
+                                         core_configuration,
+                                         *tracer,
+                                         stage_index);
+          return;
+        }
+
         while (true) {
           auto processed = manipulator_manager->manipulate(weak_input_event_queue_,
                                                            weak_output_event_queue_,
@@ -42,6 +56,38 @@ public:
       }
     }
 
+    void manipulate_with_latency_tracer(manipulator_manager& manipulator_manager,
+                                        absolute_time_point now,
+                                        pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration,
+                                        latency_tracer& tracer,
+                                        size_t stage_index) const {
+      while (true) {
+        std::optional<absolute_time_point> input_time_stamp;
+        if (auto input_event_queue = weak_input_event_queue_.lock()) {
+          if (!input_event_queue->empty()) {
+            input_time_stamp = input_event_queue->get_front_event().get_event_time_stamp().get_time_stamp();
+          }
+        }
+
+        auto begin = pqrs::osx::chrono::mach_absolute_time_point();
+
+        auto processed = manipulator_manager.manipulate(weak_input_event_queue_,
+                                                        weak_output_event_queue_,
+                                                        now,
+                                                        core_configuration);
+        if (!processed) {
+          break;
+        }
+
+        if (input_time_stamp) {
+          auto end = pqrs::osx::chrono::mach_absolute_time_point();
+          tracer.record_stage(stage_index,
+                              end - *input_time_stamp,
+                              end - begin);
+        }
+      }
+    }
+
     void invalidate_manipulators() const {
       if (auto manipulator_manager = weak_manipulator_manager_.lock()) {
         manipulator_manager->invalidate_manipulators();
@@ -89,6 +135,7 @@ public:
     connections_.emplace_back(weak_manipulator_manager,
                               weak_input_event_queue,
                               weak_output_event_queue);
+    connections_generation_.fetch_add(1, std::memory_order_release);
   }
 
   void emplace_back_connection(std::weak_ptr<manipulator_manager> weak_manipulator_manager,
@@ -102,18 +149,26 @@ public:
     connections_.emplace_back(weak_manipulator_manager,
                               connections_.back().get_weak_output_event_queue(),
                               weak_output_event_queue);
+    connections_generation_.fetch_add(1, std::memory_order_release);
   }
 
   void manipulate(absolute_time_point now,
                   pqrs::not_null_shared_ptr_t<const core_configuration::core_configuration> core_configuration) const {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-
-    for (auto&& c : connections_) {
-      c.manipulate(now,
-                   core_configuration);
+    const auto& connections = get_connections_snapshot();
+    for (size_t i = 0; i < connections.size(); ++i) {
+      connections[i].manipulate(now,
+                                core_configuration,
+                                latency_tracer_.get(),
+                                i);
     }
   }
 
+  // The latency_tracer is used in `manipulate`, so this method has to be called from the same thread.
+  // Pass nullptr to disable tracing.
+  void set_latency_tracer(std::shared_ptr<latency_tracer> value) {
+    latency_tracer_ = value;
+  }
+
   void invalidate_manipulators() const {
     std::lock_guard<std::mutex> lock(connections_mutex_);
 
@@ -141,11 +196,9 @@ public:
   }
 
   [[nodiscard]] std::optional<absolute_time_point> min_input_event_time_stamp() const {
-    std::lock_guard<std::mutex> lock(connections_mutex_);
-
     std::optional<absolute_time_point> result;
 
-    for (const auto& c : connections_) {
+    for (const auto& c : get_connections_snapshot()) {
       if (auto t = c.make_input_event_time_stamp_with_input_delay()) {
         if (!result || *t < *result) {
           result = t;
@@ -157,7 +210,26 @@ public:
   }
 
 private:
+  // Return a copy of `connections_` which is updated only when connections are changed.
+  const std::vector<connection>& get_connections_snapshot() const {
+    auto generation = connections_generation_.load(std::memory_order_acquire);
+    if (connections_snapshot_generation_ != generation) {
+      std::lock_guard<std::mutex> lock(connections_mutex_);
+
+      connections_snapshot_ = connections_;
+      connections_snapshot_generation_ = connections_generation_.load(std::memory_order_relaxed);
+    }
+
+    return connections_snapshot_;
+  }
+
   std::vector<connection> connections_;
+  std::atomic<uint64_t> connections_generation_{0};
   mutable std::mutex connections_mutex_;
+
+  // The following members are used only in `manipulate` and `min_input_event_time_stamp`.
+  mutable std::vector<connection> connections_snapshot_;
+  mutable uint64_t connections_snapshot_generation_ = 0;
+  std::shared_ptr<latency_tracer> latency_tracer_;
 };
 } // namespace krbn::manipulator
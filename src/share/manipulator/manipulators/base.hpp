@@ -26,6 +26,19 @@ public:
 
   virtual bool needs_virtual_hid_pointing() const = 0;
 
+  // Return event definitions which can be a target of `manipulate`.
+  // manipulator_manager uses them to skip manipulators that never match the front event.
+  // std::nullopt means the manipulator has to receive all events.
+  virtual std::optional<std::vector<event_definition>> get_dispatch_event_definitions() const {
+    return std::nullopt;
+  }
+
+  // Return true while the manipulator has state which has to be updated by any event.
+  // (e.g., to_delayed_action is canceled by other key_down events.)
+  virtual bool needs_all_events() const {
+    return true;
+  }
+
   virtual void handle_device_keys_and_pointing_buttons_are_released_event(const event_queue::entry& front_input_event,
                                                                           event_queue::queue& output_event_queue) = 0;
 
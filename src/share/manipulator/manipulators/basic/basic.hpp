@@ -708,6 +708,28 @@ public:
     return !manipulated_original_events_.empty();
   }
 
+  std::optional<std::vector<event_definition>> get_dispatch_event_definitions() const override {
+    return from_.get_event_definitions();
+  }
+
+  bool needs_all_events() const override {
+    if (active()) {
+      return true;
+    }
+
+    if (to_if_other_key_pressed_ &&
+        to_if_other_key_pressed_->pending()) {
+      return true;
+    }
+
+    if (to_delayed_action_ &&
+        to_delayed_action_->pending()) {
+      return true;
+    }
+
+    return false;
+  }
+
   bool needs_virtual_hid_pointing() const override {
     for (const auto& events : {to_,
                                to_after_key_up_,
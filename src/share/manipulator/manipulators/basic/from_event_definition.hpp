@@ -61,38 +61,8 @@ public:
     if (auto any_type = event_definition.get_if<event_definition::any_type>()) {
       if (auto e = event.get_if<momentary_switch_event>()) {
         if (e->valid()) {
-          auto usage_page = e->get_usage_pair().get_usage_page();
-
-          switch (*any_type) {
-            case event_definition::any_type::key_code:
-              if (usage_page == pqrs::hid::usage_page::keyboard_or_keypad) {
-                return true;
-              }
-              break;
-
-            case event_definition::any_type::consumer_key_code:
-              if (usage_page == pqrs::hid::usage_page::consumer) {
-                return true;
-              }
-              break;
-
-            case event_definition::any_type::apple_vendor_keyboard_key_code:
-              if (usage_page == pqrs::hid::usage_page::apple_vendor_keyboard) {
-                return true;
-              }
-              break;
-
-            case event_definition::any_type::apple_vendor_top_case_key_code:
-              if (usage_page == pqrs::hid::usage_page::apple_vendor_top_case) {
-                return true;
-              }
-              break;
-
-            case event_definition::any_type::pointing_button:
-              if (usage_page == pqrs::hid::usage_page::button) {
-                return true;
-              }
-              break;
+          if (e->get_usage_pair().get_usage_page() == event_definition::get_usage_page(*any_type)) {
+            return true;
           }
         }
       }
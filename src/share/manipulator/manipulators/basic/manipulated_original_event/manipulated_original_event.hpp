@@ -13,7 +13,7 @@ public:
   manipulated_original_event(const std::vector<from_event>& from_events,
                              const std::unordered_set<modifier_flag>& from_mandatory_modifiers,
                              absolute_time_point key_down_time_stamp,
-                             std::unordered_set<modifier_flag> key_down_modifier_flags)
+                             modifier_flag_mask key_down_modifier_flags)
       : from_events_(from_events),
         from_mandatory_modifiers_(from_mandatory_modifiers),
         key_down_time_stamp_(key_down_time_stamp),
@@ -39,7 +39,7 @@ public:
     return key_down_time_stamp_;
   }
 
-  [[nodiscard]] const std::unordered_set<modifier_flag>& get_key_down_modifier_flags() const {
+  [[nodiscard]] const modifier_flag_mask& get_key_down_modifier_flags() const {
     return key_down_modifier_flags_;
   }
 
@@ -101,7 +101,7 @@ private:
   std::unordered_set<modifier_flag> from_mandatory_modifiers_;
   std::unordered_set<modifier_flag> key_up_posted_from_mandatory_modifiers_;
   absolute_time_point key_down_time_stamp_;
-  std::unordered_set<modifier_flag> key_down_modifier_flags_;
+  modifier_flag_mask key_down_modifier_flags_;
   bool alone_;
   bool halted_;
   events_at_key_up events_at_key_up_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../types.hpp"
+#include "debounced_task.hpp"
 #include "event_sender.hpp"
 #include <unordered_set>
 #include <vector>
@@ -115,6 +116,11 @@ public:
     post_events(to_if_canceled_);
   }
 
+  // Return true until to_if_invoked or to_if_canceled is posted.
+  [[nodiscard]] bool pending() const {
+    return current_manipulated_original_event_ != nullptr;
+  }
+
   [[nodiscard]] bool needs_virtual_hid_pointing() const {
     for (const auto& events : {to_if_invoked_,
                                to_if_canceled_}) {
@@ -195,6 +201,6 @@ private:
   std::optional<event_queue::entry> front_input_event_;
   std::shared_ptr<manipulated_original_event::manipulated_original_event> current_manipulated_original_event_;
   std::weak_ptr<event_queue::queue> output_event_queue_;
-  pqrs::dispatcher::extra::debounced_task delayed_action_task_;
+  krbn::debounced_task delayed_action_task_;
 };
 } // namespace krbn::manipulator::manipulators::basic
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../../types.hpp"
+#include "debounced_task.hpp"
 #include "event_sender.hpp"
 #include <pqrs/json.hpp>
 #include <unordered_set>
@@ -142,6 +143,6 @@ private:
   std::optional<event_queue::entry> front_input_event_;
   std::weak_ptr<manipulated_original_event::manipulated_original_event> current_manipulated_original_event_;
   std::weak_ptr<event_queue::queue> output_event_queue_;
-  pqrs::dispatcher::extra::debounced_task held_down_task_;
+  krbn::debounced_task held_down_task_;
 };
 } // namespace krbn::manipulator::manipulators::basic
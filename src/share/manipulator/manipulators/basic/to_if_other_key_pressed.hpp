@@ -208,6 +208,11 @@ public:
     }
   }
 
+  // Return true while the from key is pressed.
+  [[nodiscard]] bool pending() const {
+    return from_device_id_ != std::nullopt;
+  }
+
   [[nodiscard]] bool needs_virtual_hid_pointing() const {
     for (const auto& entry : entries_) {
       if (std::ranges::any_of(entry->get_to(),
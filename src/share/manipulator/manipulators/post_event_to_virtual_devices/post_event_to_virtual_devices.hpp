@@ -250,6 +250,7 @@ public:
 
         case event_queue::event::type::none:
         case event_queue::event::type::set_variable:
+        case event_queue::event::type::set_variables:
         case event_queue::event::type::sticky_modifier:
         case event_queue::event::type::device_keys_and_pointing_buttons_are_released:
         case event_queue::event::type::device_grabbed:
@@ -410,6 +411,14 @@ public:
     queue_.set_cgeventtap_fallback_enabled(value);
   }
 
+  void set_pointing_input_coalescing_enabled(bool value) {
+    queue_.set_pointing_input_coalescing_enabled(value);
+  }
+
+  void set_latency_tracer(std::shared_ptr<latency_tracer> value) {
+    queue_.set_latency_tracer(value);
+  }
+
   void set_sleep_shortcut_delay(std::chrono::milliseconds value) {
     sleep_shortcut_delay_ = value;
   }
@@ -4,9 +4,12 @@
 #include "../../../pressed_keys_manager.hpp"
 #include "console_user_server_peer.hpp"
 #include "keyboard_repeat_detector.hpp"
+#include "latency_tracer.hpp"
 #include "types.hpp"
 #include "virtual_hid_device_utility.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <pqrs/dispatcher.hpp>
 #include <pqrs/karabiner/driverkit/virtual_hid_device_service.hpp>
 #include <pqrs/osx/input_source_selector.hpp>
@@ -341,6 +344,7 @@ public:
         virtual_hid_keyboard_pressed_keys_manager_(virtual_hid_keyboard_pressed_keys_manager),
         keyboard_suppression_(keyboard_suppression),
         cgeventtap_fallback_enabled_(false),
+        pointing_input_coalescing_enabled_(false),
         last_event_type_(event_type::single),
         last_event_time_stamp_(0) {
   }
@@ -361,6 +365,18 @@ public:
     cgeventtap_fallback_enabled_ = value;
   }
 
+  // Merge adjacent pointing_input reports in async_post_events when they are already due.
+  // (See comments in `coalesce_pointing_inputs` for details.)
+  void set_pointing_input_coalescing_enabled(bool value) {
+    pointing_input_coalescing_enabled_ = value;
+  }
+
+  // The latency_tracer is used in the shared dispatcher thread.
+  // Pass nullptr to disable tracing.
+  void set_latency_tracer(std::shared_ptr<latency_tracer> value) {
+    latency_tracer_ = value;
+  }
+
   void emplace_back_key_event(const pqrs::hid::usage_pair& usage_pair,
                               event_type event_type,
                               absolute_time_point time_stamp) {
@@ -551,6 +567,13 @@ public:
         [this, weak_virtual_hid_device_service_client, weak_console_user_server_peer] {
           auto now = pqrs::osx::chrono::mach_absolute_time_point();
 
+          if (pointing_input_coalescing_enabled_) {
+            auto merged = coalesce_pointing_inputs(now);
+            if (latency_tracer_) {
+              latency_tracer_->record_coalesced_pointing_inputs(merged);
+            }
+          }
+
           while (!events_.empty()) {
             auto& e = events_.front();
             if (e.get_time_stamp() > now) {
@@ -572,6 +595,10 @@ public:
               return;
             }
 
+            if (latency_tracer_) {
+              latency_tracer_->record_posted(now - e.get_time_stamp());
+            }
+
             if (auto input = e.get_keyboard_input()) {
               if (auto client = weak_virtual_hid_device_service_client.lock()) {
                 handle_posted_momentary_switch_event(e);
@@ -657,6 +684,111 @@ public:
     keyboard_repeat_detector_.clear();
   }
 
+  // High polling rate mice (1000-8000 Hz) produce a pointing_input report for each pointing_motion.
+  // When the dispatcher is busy, these reports pile up in events_ and the cursor lags behind.
+  //
+  // This method merges each run of adjacent pointing_input reports which are already due and have the same buttons into one report.
+  // The sums of x, y and wheels are preserved.
+  // If a sum exceeds the range of the report (-127 ... 127), the remainder is carried to the following reports.
+  //
+  // The reports are merged in place in a single pass over the due events.
+  //
+  // Returns the number of removed reports.
+  size_t coalesce_pointing_inputs(absolute_time_point now) {
+    using pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::pointing_input;
+
+    auto take = [](int& value) {
+      auto v = std::clamp(value, -127, 127);
+      value -= v;
+      return static_cast<uint8_t>(v);
+    };
+
+    auto report_count = [](int value) {
+      return static_cast<size_t>((std::abs(value) + 126) / 127);
+    };
+
+    size_t write = 0;
+    size_t read = 0;
+    while (read < events_.size() &&
+           events_[read].get_time_stamp() <= now) {
+      auto front = events_[read].get_pointing_input();
+      if (!front) {
+        if (write != read) {
+          events_[write] = std::move(events_[read]);
+        }
+        ++write;
+        ++read;
+        continue;
+      }
+
+      auto buttons = front->buttons;
+      auto time_stamp = events_[read].get_time_stamp();
+      int x = 0;
+      int y = 0;
+      int vertical_wheel = 0;
+      int horizontal_wheel = 0;
+
+      auto end = read;
+      while (end < events_.size() &&
+             events_[end].get_time_stamp() <= now) {
+        auto input = events_[end].get_pointing_input();
+        if (!input ||
+            input->buttons != buttons) {
+          break;
+        }
+
+        // The report fields are uint8_t which hold signed values.
+        x += static_cast<int8_t>(input->x);
+        y += static_cast<int8_t>(input->y);
+        vertical_wheel += static_cast<int8_t>(input->vertical_wheel);
+        horizontal_wheel += static_cast<int8_t>(input->horizontal_wheel);
+
+        ++end;
+      }
+
+      auto size = end - read;
+      auto reports = std::max({size_t(1),
+                               report_count(x),
+                               report_count(y),
+                               report_count(vertical_wheel),
+                               report_count(horizontal_wheel)});
+
+      if (reports >= size) {
+        // Keep the run as is.
+        for (; read < end; ++read, ++write) {
+          if (write != read) {
+            events_[write] = std::move(events_[read]);
+          }
+        }
+        continue;
+      }
+
+      // `write + reports` does not exceed `end`, so the merged reports overwrite only processed events.
+      for (size_t i = 0; i < reports; ++i) {
+        pointing_input report;
+        report.buttons = buttons;
+        report.x = take(x);
+        report.y = take(y);
+        report.vertical_wheel = take(vertical_wheel);
+        report.horizontal_wheel = take(horizontal_wheel);
+
+        events_[write] = event(report,
+                               time_stamp);
+        ++write;
+      }
+
+      read = end;
+    }
+
+    auto merged = read - write;
+    if (merged > 0) {
+      events_.erase(std::begin(events_) + write,
+                    std::begin(events_) + read);
+    }
+
+    return merged;
+  }
+
 private:
   void adjust_time_stamp(absolute_time_point& time_stamp,
                          event_type et,
@@ -735,6 +867,8 @@ private:
   pqrs::not_null_shared_ptr_t<pressed_keys_manager> virtual_hid_keyboard_pressed_keys_manager_;
   pqrs::not_null_shared_ptr_t<keyboard_suppression> keyboard_suppression_;
   bool cgeventtap_fallback_enabled_;
+  bool pointing_input_coalescing_enabled_;
+  std::shared_ptr<latency_tracer> latency_tracer_;
 
   keyboard_repeat_detector keyboard_repeat_detector_;
 
@@ -67,6 +67,24 @@ public:
     return std::get_if<T>(&value_);
   }
 
+  // Return usage_page of momentary_switch_event which matches `any_type`.
+  static pqrs::hid::usage_page::value_t get_usage_page(any_type value) {
+    switch (value) {
+      case any_type::key_code:
+        return pqrs::hid::usage_page::keyboard_or_keypad;
+      case any_type::consumer_key_code:
+        return pqrs::hid::usage_page::consumer;
+      case any_type::apple_vendor_keyboard_key_code:
+        return pqrs::hid::usage_page::apple_vendor_keyboard;
+      case any_type::apple_vendor_top_case_key_code:
+        return pqrs::hid::usage_page::apple_vendor_top_case;
+      case any_type::pointing_button:
+        return pqrs::hid::usage_page::button;
+    }
+
+    return pqrs::hid::usage_page::undefined;
+  }
+
   [[nodiscard]] std::optional<event_queue::event> to_event() const {
     switch (type_) {
       case type::none:
@@ -3,10 +3,11 @@
 #include "types.hpp"
 #include <array>
 #include <thread>
-#include <unordered_set>
 #include <vector>
 
 namespace krbn {
+// active_modifier_flags_ keeps the history of modifier flag changes to pair increase and decrease entries.
+// The per-modifier counters are maintained incrementally alongside it so that is_pressed and other queries are O(1).
 class modifier_flag_manager final {
 public:
 #include "modifier_flag_manager/active_modifier_flag.hpp"
@@ -14,7 +15,8 @@ public:
 
   modifier_flag_manager(const modifier_flag_manager&) = delete;
 
-  modifier_flag_manager() {
+  modifier_flag_manager() : states_{},
+                            pressed_modifier_flags_() {
   }
 
   void push_back_active_modifier_flag(const active_modifier_flag& flag) {
@@ -23,7 +25,7 @@ public:
       case active_modifier_flag::type::decrease:
       case active_modifier_flag::type::increase_sticky:
       case active_modifier_flag::type::decrease_sticky:
-        active_modifier_flags_.push_back(flag);
+        push_back(flag);
         erase_pairs();
         break;
 
@@ -31,93 +33,55 @@ public:
       case active_modifier_flag::type::decrease_lock:
       case active_modifier_flag::type::increase_led_lock:
         // Remove same type entries.
-        active_modifier_flags_.erase(std::remove_if(std::begin(active_modifier_flags_),
-                                                    std::end(active_modifier_flags_),
-                                                    [&](auto& f) {
-                                                      return f == flag;
-                                                    }),
-                                     std::end(active_modifier_flags_));
-
-        active_modifier_flags_.push_back(flag);
+        erase_if([&](auto& f) {
+          return f == flag;
+        });
+
+        push_back(flag);
         erase_pairs();
         break;
 
       case active_modifier_flag::type::decrease_led_lock:
         // Remove all type::increase_led_lock.
-        active_modifier_flags_.erase(std::remove_if(std::begin(active_modifier_flags_),
-                                                    std::end(active_modifier_flags_),
-                                                    [&](auto& f) {
-                                                      return f.is_paired(flag);
-                                                    }),
-                                     std::end(active_modifier_flags_));
+        erase_if([&](auto& f) {
+          return f.is_paired(flag);
+        });
         break;
     }
   }
 
   void erase_all_active_modifier_flags(device_id device_id) {
-    active_modifier_flags_.erase(std::remove_if(std::begin(active_modifier_flags_),
-                                                std::end(active_modifier_flags_),
-                                                [&](const active_modifier_flag& f) {
-                                                  return f.get_device_id() == device_id;
-                                                }),
-                                 std::end(active_modifier_flags_));
+    erase_if([&](const active_modifier_flag& f) {
+      return f.get_device_id() == device_id;
+    });
   }
 
   void erase_all_active_modifier_flags_except_lock_and_sticky(device_id device_id) {
-    active_modifier_flags_.erase(std::remove_if(std::begin(active_modifier_flags_),
-                                                std::end(active_modifier_flags_),
-                                                [&](const active_modifier_flag& f) {
-                                                  return f.get_device_id() == device_id && !f.any_lock() && !f.sticky();
-                                                }),
-                                 std::end(active_modifier_flags_));
+    erase_if([&](const active_modifier_flag& f) {
+      return f.get_device_id() == device_id && !f.any_lock() && !f.sticky();
+    });
   }
 
   void erase_caps_lock_sticky_modifier_flags() {
-    active_modifier_flags_.erase(std::remove_if(std::begin(active_modifier_flags_),
-                                                std::end(active_modifier_flags_),
-                                                [&](const active_modifier_flag& f) {
-                                                  return f.get_modifier_flag() == modifier_flag::caps_lock && f.sticky();
-                                                }),
-                                 std::end(active_modifier_flags_));
+    erase_if([&](const active_modifier_flag& f) {
+      return f.get_modifier_flag() == modifier_flag::caps_lock && f.sticky();
+    });
   }
 
   void erase_all_sticky_modifier_flags() {
-    active_modifier_flags_.erase(std::remove_if(std::begin(active_modifier_flags_),
-                                                std::end(active_modifier_flags_),
-                                                [&](const active_modifier_flag& f) {
-                                                  return f.sticky();
-                                                }),
-                                 std::end(active_modifier_flags_));
+    erase_if([&](const active_modifier_flag& f) {
+      return f.sticky();
+    });
   }
 
   void reset() {
     active_modifier_flags_.clear();
+    states_ = {};
+    pressed_modifier_flags_ = modifier_flag_mask();
   }
 
   [[nodiscard]] bool is_pressed(modifier_flag modifier_flag) const {
-    int count = 0;
-    size_t size = 0;
-
-    int led_count = 0;
-
-    for (const auto& f : active_modifier_flags_) {
-      if (f.get_modifier_flag() == modifier_flag) {
-        if (f.led_lock()) {
-          led_count += f.get_count();
-        } else {
-          count += f.get_count();
-          ++size;
-        }
-      }
-    }
-
-    if (size == 0) {
-      // Use led lock if other flags do not exist.
-      return led_count > 0;
-    } else {
-      // Ignore led lock if other flags exist.
-      return count > 0;
-    }
+    return pressed_modifier_flags_.contains(modifier_flag);
   }
 
   [[nodiscard]] const std::vector<active_modifier_flag>& get_active_modifier_flags() const {
@@ -129,32 +93,24 @@ public:
   }
 
   [[nodiscard]] size_t led_lock_size(modifier_flag modifier_flag) const {
-    return std::count_if(std::begin(active_modifier_flags_),
-                         std::end(active_modifier_flags_),
-                         [&](const active_modifier_flag& f) {
-                           return f.get_modifier_flag() == modifier_flag && f.led_lock();
-                         });
+    if (auto s = find_state(modifier_flag)) {
+      return static_cast<size_t>(s->led_lock_size);
+    }
+    return 0;
   }
 
   [[nodiscard]] size_t sticky_size(modifier_flag modifier_flag) const {
-    return std::count_if(std::begin(active_modifier_flags_),
-                         std::end(active_modifier_flags_),
-                         [&](const active_modifier_flag& f) {
-                           return f.get_modifier_flag() == modifier_flag && f.sticky();
-                         });
+    if (auto s = find_state(modifier_flag)) {
+      return static_cast<size_t>(s->sticky_size);
+    }
+    return 0;
   }
 
   [[nodiscard]] bool is_sticky_active(modifier_flag modifier_flag) const {
-    auto count = std::accumulate(std::begin(active_modifier_flags_),
-                                 std::end(active_modifier_flags_),
-                                 0,
-                                 [&](const auto& count, const auto& f) {
-                                   if (f.get_modifier_flag() == modifier_flag && f.sticky()) {
-                                     return count + f.get_count();
-                                   }
-                                   return count;
-                                 });
-    return count > 0;
+    if (auto s = find_state(modifier_flag)) {
+      return s->sticky_count > 0;
+    }
+    return false;
   }
 
   pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report::modifiers make_hid_report_modifiers() const {
@@ -170,6 +126,10 @@ public:
         modifier_flag::right_option,
         modifier_flag::right_command,
     };
+    if (pressed_modifier_flags_.empty()) {
+      return modifiers;
+    }
+
     for (const auto& m : modifier_flags) {
       if (is_pressed(m)) {
         if (auto r = make_hid_report_modifier(m)) {
@@ -181,34 +141,86 @@ public:
     return modifiers;
   }
 
-  std::unordered_set<modifier_flag> make_modifier_flags() const {
-    std::unordered_set<modifier_flag> modifier_flags;
-
-    for (const auto& m : {
-             modifier_flag::caps_lock,
-             modifier_flag::left_control,
-             modifier_flag::left_shift,
-             modifier_flag::left_option,
-             modifier_flag::left_command,
-             modifier_flag::right_control,
-             modifier_flag::right_shift,
-             modifier_flag::right_option,
-             modifier_flag::right_command,
-             modifier_flag::fn,
-         }) {
-      if (is_pressed(m)) {
-        modifier_flags.insert(m);
+  [[nodiscard]] modifier_flag_mask make_modifier_flags() const {
+    auto modifier_flags = pressed_modifier_flags_;
+    modifier_flags.erase(modifier_flag::zero);
+    return modifier_flags;
+  }
+
+private:
+  struct state final {
+    // The sum of counts and the number of entries except led_lock.
+    int count;
+    int size;
+
+    int led_lock_count;
+    int led_lock_size;
+
+    int sticky_count;
+    int sticky_size;
+  };
+
+  [[nodiscard]] const state* find_state(modifier_flag modifier_flag) const {
+    if (modifier_flag_mask::valid(modifier_flag)) {
+      return &(states_[static_cast<size_t>(modifier_flag)]);
+    }
+    return nullptr;
+  }
+
+  // Apply `f` to the counters. `sign` is 1 when `f` is added and -1 when `f` is removed.
+  void update_state(const active_modifier_flag& f, int sign) {
+    auto modifier_flag = f.get_modifier_flag();
+    if (!modifier_flag_mask::valid(modifier_flag)) {
+      return;
+    }
+
+    auto& s = states_[static_cast<size_t>(modifier_flag)];
+
+    if (f.led_lock()) {
+      s.led_lock_count += sign * f.get_count();
+      s.led_lock_size += sign;
+    } else {
+      s.count += sign * f.get_count();
+      s.size += sign;
+
+      if (f.sticky()) {
+        s.sticky_count += sign * f.get_count();
+        s.sticky_size += sign;
       }
     }
 
-    return modifier_flags;
+    // Use led lock if other flags do not exist.
+    // Ignore led lock if other flags exist.
+    if (s.size == 0 ? s.led_lock_count > 0 : s.count > 0) {
+      pressed_modifier_flags_.insert(modifier_flag);
+    } else {
+      pressed_modifier_flags_.erase(modifier_flag);
+    }
+  }
+
+  void push_back(const active_modifier_flag& f) {
+    active_modifier_flags_.push_back(f);
+    update_state(f, 1);
+  }
+
+  template <typename Predicate>
+  void erase_if(Predicate predicate) {
+    std::erase_if(active_modifier_flags_,
+                  [&](const active_modifier_flag& f) {
+                    if (predicate(f)) {
+                      update_state(f, -1);
+                      return true;
+                    }
+                    return false;
+                  });
   }
 
-private:
   void erase_pairs() {
     for (size_t i1 = 0; i1 < active_modifier_flags_.size(); ++i1) {
       for (size_t i2 = i1 + 1; i2 < active_modifier_flags_.size(); ++i2) {
         if (active_modifier_flags_[i1].is_paired(active_modifier_flags_[i2])) {
+          update_state(active_modifier_flags_[i2], -1);
+          update_state(active_modifier_flags_[i1], -1);
           active_modifier_flags_.erase(std::begin(active_modifier_flags_) + i2);
           active_modifier_flags_.erase(std::begin(active_modifier_flags_) + i1);
           if (i1 > 0) {
@@ -221,6 +233,8 @@ private:
   }
 
   std::vector<active_modifier_flag> active_modifier_flags_;
+  std::array<state, static_cast<size_t>(modifier_flag::end_)> states_;
+  modifier_flag_mask pressed_modifier_flags_;
 };
 
 inline std::ostream& operator<<(std::ostream& stream, const modifier_flag_manager::active_modifier_flag& value) {
@@ -3,7 +3,7 @@
 class scoped_modifier_flags final {
 public:
   scoped_modifier_flags(modifier_flag_manager& modifier_flag_manager,
-                        std::unordered_set<modifier_flag> modifier_flags)
+                        modifier_flag_mask modifier_flags)
       : modifier_flag_manager_(modifier_flag_manager) {
     for (const auto& m : {
              modifier_flag::caps_lock,
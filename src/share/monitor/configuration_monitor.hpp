@@ -11,6 +11,8 @@
 #include <nod/nod.hpp>
 #include <optional>
 #include <pqrs/osx/file_monitor.hpp>
+#include <sys/stat.h>
+#include <time.h>
 
 namespace krbn {
 class configuration_monitor final : public pqrs::dispatcher::extra::dispatcher_client {
@@ -104,14 +106,54 @@ private:
       file_path = user_core_configuration_file_path_.value_or(system_core_configuration_file_path_);
     }
 
-    if (path_may_exist(file_path)) {
+    //
+    // Skip loading if the file is not changed since the last load.
+    // (Editors and file synchronization tools often trigger file events without changes.)
+    //
+
+    struct stat file_stat;
+    auto file_stat_available = (stat(file_path.c_str(), &file_stat) == 0);
+
+    if (file_stat_available &&
+        is_loaded_file_unchanged(file_path, file_stat)) {
+      logger::get_logger()->debug("{0} is not changed.", file_path);
+      return;
+    }
+
+    auto file_exists = path_may_exist(file_path);
+    if (file_exists) {
       logger::get_logger()->info("Load {0}...", file_path);
     }
 
+    auto wall_time_begin = std::chrono::steady_clock::now();
+    auto cpu_time_begin = get_thread_cpu_time();
+
     auto c = std::make_shared<core_configuration::core_configuration>(file_path,
                                                                       expected_user_core_configuration_file_owner_,
                                                                       error_handling_);
 
+    if (file_exists) {
+      auto wall_time = std::chrono::steady_clock::now() - wall_time_begin;
+      auto cpu_time = get_thread_cpu_time() - cpu_time_begin;
+      logger::get_logger()->info("{0} is loaded in {1:.3f} ms (CPU time of the monitor thread: {2:.3f} ms)",
+                                 file_path,
+                                 std::chrono::duration<double, std::milli>(wall_time).count(),
+                                 std::chrono::duration<double, std::milli>(cpu_time).count());
+    }
+
+    if (c->get_load_state() == core_configuration::core_configuration::load_state::loaded &&
+        c->get_source() != core_configuration::core_configuration::source::default_configuration &&
+        c->get_file_digest() &&
+        file_stat_available) {
+      loaded_file_ = loaded_file{
+          .file_path = file_path,
+          .owner = file_stat.st_uid,
+          .digest = *(c->get_file_digest()),
+      };
+    } else {
+      loaded_file_ = std::nullopt;
+    }
+
     auto previous_load_state = load_state_;
     auto load_state = c->get_load_state();
     if (!load_state_ || *load_state_ != load_state) {
@@ -140,7 +182,7 @@ private:
                                 *previous_load_state != core_configuration::core_configuration::load_state::loaded;
     if (!recovered_from_error &&
         core_configuration_ &&
-        core_configuration_->to_json() == c->to_json()) {
+        core_configuration_->has_same_json(*c)) {
       return;
     }
 
@@ -153,6 +195,36 @@ private:
     });
   }
 
+  // The file size and the owner are compared before the file body is read.
+  [[nodiscard]] bool is_loaded_file_unchanged(const std::string& file_path,
+                                              const struct stat& file_stat) const {
+    if (!loaded_file_ ||
+        !core_configuration_ ||
+        loaded_file_->file_path != file_path ||
+        loaded_file_->owner != file_stat.st_uid ||
+        loaded_file_->digest.size != static_cast<size_t>(file_stat.st_size)) {
+      return false;
+    }
+
+    auto body = filesystem_utility::read_file(file_path);
+    if (!body) {
+      return false;
+    }
+
+    return loaded_file_->digest == core_configuration::core_configuration::file_digest{
+                                       .size = body->size(),
+                                       .hash = std::hash<std::string>{}(*body),
+                                   };
+  }
+
+  [[nodiscard]] static std::chrono::nanoseconds get_thread_cpu_time() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+      return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+
   // Unlike std::filesystem::exists, this treats errors such as permission_denied as evidence that
   // the path is not missing. This prevents falling back to another configuration when the intended
   // configuration exists but cannot be accessed.
@@ -179,5 +251,13 @@ private:
   std::shared_ptr<core_configuration::core_configuration> core_configuration_;
   std::optional<core_configuration::core_configuration::load_state> load_state_;
   std::string parse_error_message_;
+
+  struct loaded_file final {
+    std::string file_path;
+    uid_t owner;
+    core_configuration::core_configuration::file_digest digest;
+  };
+  // The file of the last successful load.
+  std::optional<loaded_file> loaded_file_;
 };
 } // namespace krbn
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace krbn::parallel_utility {
+// Returns the number of worker threads used for `count` independent tasks.
+inline size_t get_worker_count(size_t count,
+                               size_t max_worker_count = 8) {
+  size_t n = std::max(1u, std::thread::hardware_concurrency());
+  return std::min({n, max_worker_count, count});
+}
+
+// Call `function(index)` for each index in [0, count) on a bounded set of worker threads.
+// The order of calls is not specified, so `function` must store its result by index.
+// `function` must not throw.
+template <typename F>
+inline void for_each_index(size_t count,
+                           F&& function,
+                           size_t max_worker_count = 8) {
+  auto worker_count = get_worker_count(count, max_worker_count);
+  if (worker_count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      function(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next_index(0);
+  auto worker = [&] {
+    while (true) {
+      auto i = next_index.fetch_add(1);
+      if (i >= count) {
+        return;
+      }
+      function(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(worker_count - 1);
+  for (size_t i = 0; i < worker_count - 1; ++i) {
+    threads.emplace_back(worker);
+  }
+
+  // The calling thread also works.
+  worker();
+
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+} // namespace krbn::parallel_utility
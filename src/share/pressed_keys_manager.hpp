@@ -3,22 +3,30 @@
 // `krbn::pressed_keys_manager` can be used safely in a multi-threaded environment.
 
 #include "types.hpp"
-#include <unordered_set>
+#include <algorithm>
 #include <vector>
 
 namespace krbn {
+// Only a few keys are pressed at the same time, so a flat vector is faster than a hash set.
+// It also avoids a node allocation on each key_down once the initial capacity is reserved.
 class pressed_keys_manager {
 public:
+  pressed_keys_manager() {
+    entries_.reserve(32);
+  }
+
   void insert(const momentary_switch_event& value) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    entries_.insert(value);
+    if (std::ranges::find(entries_, value) == std::end(entries_)) {
+      entries_.push_back(value);
+    }
   }
 
   void erase(const momentary_switch_event& value) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    entries_.erase(value);
+    std::erase(entries_, value);
   }
 
   [[nodiscard]] bool empty() const {
@@ -30,18 +38,13 @@ public:
   [[nodiscard]] bool contains(const momentary_switch_event& value) const {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    return entries_.contains(value);
+    return std::ranges::find(entries_, value) != std::end(entries_);
   }
 
   std::vector<momentary_switch_event> make_entries_and_clear() {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    std::vector<momentary_switch_event> result;
-    result.reserve(entries_.size());
-
-    for (const auto& e : entries_) {
-      result.push_back(e);
-    }
+    std::vector<momentary_switch_event> result(entries_);
 
     entries_.clear();
 
@@ -51,14 +54,7 @@ public:
   std::vector<momentary_switch_event> make_entries() const {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    std::vector<momentary_switch_event> result;
-    result.reserve(entries_.size());
-
-    for (const auto& e : entries_) {
-      result.push_back(e);
-    }
-
-    return result;
+    return entries_;
   }
 
   void clear() {
@@ -68,7 +64,7 @@ public:
   }
 
 private:
-  std::unordered_set<momentary_switch_event> entries_;
+  std::vector<momentary_switch_event> entries_;
   mutable std::mutex mutex_;
 };
 } // namespace krbn
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <optional>
+#include <pqrs/regex.hpp>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace krbn {
+// regex_matcher returns whether any of the given regexes matches a string (`regex_search`).
+//
+// Most patterns in complex_modifications are plain strings such as `^com\.apple\.Terminal$`.
+// These patterns are matched by string comparison instead of std::regex.
+// The other patterns are combined into a single std::regex in order to scan the string once.
+class regex_matcher final {
+public:
+  regex_matcher() = default;
+
+  explicit regex_matcher(const std::vector<pqrs::regex>& regexes) {
+    std::vector<const pqrs::regex*> other_regexes;
+
+    for (const auto& r : regexes) {
+      if (auto l = make_literal(r)) {
+        literals_.push_back(*l);
+      } else {
+        other_regexes.push_back(&r);
+      }
+    }
+
+    if (other_regexes.size() > 1 && combinable(other_regexes)) {
+      std::string combined;
+      for (const auto& r : other_regexes) {
+        if (!combined.empty()) {
+          combined += '|';
+        }
+        combined += "(?:";
+        combined += r->get_string();
+        combined += ')';
+      }
+
+      try {
+        regexes_.emplace_back(combined, std::regex_constants::ECMAScript);
+        return;
+      } catch (const std::exception&) {
+        // Use the regexes one by one.
+      }
+    }
+
+    for (const auto& r : other_regexes) {
+      regexes_.push_back(r->get_regex());
+    }
+  }
+
+  [[nodiscard]] bool empty() const {
+    return literals_.empty() && regexes_.empty();
+  }
+
+  [[nodiscard]] bool search(const std::string& string) const {
+    for (const auto& l : literals_) {
+      if (l.matches(string)) {
+        return true;
+      }
+    }
+
+    for (const auto& r : regexes_) {
+      if (std::regex_search(string, r)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  [[nodiscard]] size_t literals_size() const {
+    return literals_.size();
+  }
+
+  [[nodiscard]] size_t regexes_size() const {
+    return regexes_.size();
+  }
+
+private:
+  struct literal final {
+    std::string string;
+    bool anchored_begin;
+    bool anchored_end;
+
+    [[nodiscard]] bool matches(std::string_view s) const {
+      if (anchored_begin && anchored_end) {
+        return s == string;
+      } else if (anchored_begin) {
+        return s.starts_with(string);
+      } else if (anchored_end) {
+        return s.ends_with(string);
+      } else {
+        return s.find(string) != std::string_view::npos;
+      }
+    }
+  };
+
+  // Return a literal if the pattern consists of plain characters, escaped punctuations and optional `^`, `$` anchors.
+  static std::optional<literal> make_literal(const pqrs::regex& regex) {
+    if (regex.get_flags() != std::regex_constants::ECMAScript) {
+      return std::nullopt;
+    }
+
+    std::string_view pattern = regex.get_string();
+
+    literal result{
+        .string = "",
+        .anchored_begin = false,
+        .anchored_end = false,
+    };
+
+    if (pattern.starts_with('^')) {
+      result.anchored_begin = true;
+      pattern.remove_prefix(1);
+    }
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      auto c = pattern[i];
+
+      switch (c) {
+        case '\\': {
+          if (i + 1 >= pattern.size()) {
+            return std::nullopt;
+          }
+
+          // `\d`, `\w`, `\b`, `\1`, etc. are not literals.
+          auto next = pattern[i + 1];
+          if (std::string_view(".^$|?*+()[]{}\\/-").find(next) == std::string_view::npos) {
+            return std::nullopt;
+          }
+
+          result.string += next;
+          ++i;
+          break;
+        }
+
+        case '$':
+          if (i + 1 == pattern.size()) {
+            result.anchored_end = true;
+            break;
+          }
+          return std::nullopt;
+
+        case '.':
+        case '^':
+        case '|':
+        case '?':
+        case '*':
+        case '+':
+        case '(':
+        case ')':
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+          return std::nullopt;
+
+        default:
+          result.string += c;
+          break;
+      }
+    }
+
+    return result;
+  }
+
+  // Backreferences are renumbered when regexes are combined.
+  static bool combinable(const std::vector<const pqrs::regex*>& regexes) {
+    for (const auto& r : regexes) {
+      if (r->get_flags() != std::regex_constants::ECMAScript) {
+        return false;
+      }
+
+      const auto& s = r->get_string();
+      for (size_t i = 0; i + 1 < s.size(); ++i) {
+        if (s[i] == '\\') {
+          if ('1' <= s[i + 1] && s[i + 1] <= '9') {
+            return false;
+          }
+          // Skip the escaped character.
+          ++i;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  std::vector<literal> literals_;
+  std::vector<std::regex> regexes_;
+};
+} // namespace krbn
@@ -0,0 +1,537 @@
+#pragma once
+
+// `krbn::shell_command_worker` can be used safely in a multi-threaded environment.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <fcntl.h>
+#include <iomanip>
+#include <nod/nod.hpp>
+#include <optional>
+#include <poll.h>
+#include <pqrs/dispatcher.hpp>
+#include <pqrs/process.hpp>
+#include <random>
+#include <spawn.h>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifdef __APPLE__
+extern char** environ;
+#endif
+
+namespace krbn {
+// shell_command_worker is a long-lived `/bin/sh` which runs shell commands fed over its stdin.
+//
+// Running a command with `/bin/sh -c` costs fork, exec and the shell startup for each command.
+// The worker pays them once and runs each command in a subshell instead.
+//
+// Protocol:
+// Each command is written into the worker's stdin as the following script.
+// The command runs in a subshell so that `exit`, `cd` and syntax errors in the command do not affect the worker.
+// The worker writes a start marker line before the command and an end marker line with the exit status after the command
+// into both stdout and stderr.
+//
+//   printf '\n%s start\n' '<marker>'
+//   printf '\n%s start\n' '<marker>' >&2
+//   ( eval '<command>' ) </dev/null
+//   krbn_status=$?
+//   printf '\n%s end %d\n' '<marker>' "$krbn_status"
+//   printf '\n%s end %d\n' '<marker>' "$krbn_status" >&2
+//
+// Background processes launched by a command may write after the end marker.
+// Such output is dropped until the start marker of the next command, so it is not attributed to the next command.
+//
+// A worker runs one command at a time.
+class shell_command_worker final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  // output_parser splits the output of the worker into the command output and the marker lines.
+  class output_parser final {
+  public:
+    explicit output_parser(const std::string& marker)
+        : start_marker_("\n" + marker + " start\n"),
+          end_marker_("\n" + marker + " end "),
+          started_(false) {
+    }
+
+    // Returns the output of the current command which is ready to be passed.
+    // The output before the start marker and after the end marker is dropped.
+    // Bytes which may be a part of a marker are kept until the next call.
+    std::vector<uint8_t> append(const uint8_t* data, size_t size) {
+      std::vector<uint8_t> output;
+
+      if (exit_status_) {
+        return output;
+      }
+
+      pending_.insert(std::end(pending_), data, data + size);
+
+      if (!started_) {
+        auto it = std::search(std::begin(pending_),
+                              std::end(pending_),
+                              std::begin(start_marker_),
+                              std::end(start_marker_));
+        if (it == std::end(pending_)) {
+          pending_.erase(std::begin(pending_),
+                         std::begin(pending_) + find_partial_marker(start_marker_));
+          return output;
+        }
+
+        pending_.erase(std::begin(pending_), it + start_marker_.size());
+        started_ = true;
+      }
+
+      auto it = std::search(std::begin(pending_),
+                            std::end(pending_),
+                            std::begin(end_marker_),
+                            std::end(end_marker_));
+      if (it != std::end(pending_)) {
+        output.insert(std::end(output), std::begin(pending_), it);
+
+        auto status_begin = it + end_marker_.size();
+        auto status_end = std::find(status_begin, std::end(pending_), '\n');
+        if (status_end == std::end(pending_)) {
+          pending_.erase(std::begin(pending_), it);
+          return output;
+        }
+
+        int status = -1;
+        std::from_chars(reinterpret_cast<const char*>(&*status_begin),
+                        reinterpret_cast<const char*>(&*status_begin) + (status_end - status_begin),
+                        status);
+        exit_status_ = status;
+
+        pending_.clear();
+        return output;
+      }
+
+      auto keep_from = find_partial_marker(end_marker_);
+      output.insert(std::end(output), std::begin(pending_), std::begin(pending_) + keep_from);
+      pending_.erase(std::begin(pending_), std::begin(pending_) + keep_from);
+
+      return output;
+    }
+
+    // The exit status of the current command. std::nullopt until the end marker is received.
+    [[nodiscard]] const std::optional<int>& get_exit_status() const {
+      return exit_status_;
+    }
+
+    // Call when the next command is started.
+    void reset() {
+      pending_.clear();
+      started_ = false;
+      exit_status_ = std::nullopt;
+    }
+
+  private:
+    // Returns the position of the tail of pending_ which may be the beginning of `marker`.
+    // (pending_.size() if there is no such tail.)
+    [[nodiscard]] size_t find_partial_marker(const std::string& marker) const {
+      for (auto i = pending_.size() > marker.size() ? pending_.size() - marker.size() : 0;
+           i < pending_.size();
+           ++i) {
+        if (pending_[i] == marker.front() &&
+            std::equal(std::begin(pending_) + i, std::end(pending_), std::begin(marker))) {
+          return i;
+        }
+      }
+      return pending_.size();
+    }
+
+    std::string start_marker_;
+    std::string end_marker_;
+    std::vector<uint8_t> pending_;
+    bool started_;
+    std::optional<int> exit_status_;
+  };
+
+  // Signals (invoked from the dispatcher thread)
+
+  nod::signal<void(uint64_t command_id, std::shared_ptr<std::vector<uint8_t>>)> stdout_received;
+  nod::signal<void(uint64_t command_id, std::shared_ptr<std::vector<uint8_t>>)> stderr_received;
+  nod::signal<void(uint64_t command_id, int exit_status)> command_finished;
+  // The worker exited. The running command (if any) is passed as command_id.
+  nod::signal<void(std::optional<uint64_t> command_id)> exited;
+
+  // Methods
+
+  shell_command_worker(const shell_command_worker&) = delete;
+
+  shell_command_worker(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher)
+      : dispatcher_client(weak_dispatcher),
+        marker_(make_marker()),
+        stdout_parser_(marker_),
+        stderr_parser_(marker_),
+        killed_(false) {
+  }
+
+  ~shell_command_worker() {
+    detach_from_dispatcher([this] {
+      terminate();
+    });
+  }
+
+  // Spawn `/bin/sh`. Returns false if the worker could not be started.
+  // Call from the dispatcher thread.
+  bool start() {
+    if (pid_ || thread_) {
+      return false;
+    }
+
+    stdin_pipe_ = std::make_unique<pqrs::process::pipe>();
+    stdout_pipe_ = std::make_unique<pqrs::process::pipe>();
+    stderr_pipe_ = std::make_unique<pqrs::process::pipe>();
+    wakeup_pipe_ = std::make_unique<pqrs::process::pipe>();
+
+    auto stdin_write_end = stdin_pipe_->get_write_end();
+    auto stdout_read_end = stdout_pipe_->get_read_end();
+    auto stderr_read_end = stderr_pipe_->get_read_end();
+    auto wakeup_read_end = wakeup_pipe_->get_read_end();
+    auto wakeup_write_end = wakeup_pipe_->get_write_end();
+    if (!stdin_write_end ||
+        !stdout_read_end ||
+        !stderr_read_end ||
+        !wakeup_read_end ||
+        !wakeup_write_end) {
+      close_pipes();
+      return false;
+    }
+
+    // The parent side file descriptors must not be inherited by other processes.
+    // Otherwise, the worker does not receive EOF of stdin while other processes are alive.
+    for (auto fd : {*stdin_write_end, *stdout_read_end, *stderr_read_end, *wakeup_read_end, *wakeup_write_end}) {
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+#ifdef F_SETNOSIGPIPE
+    // Avoid SIGPIPE when the worker exits unexpectedly.
+    fcntl(*stdin_write_end, F_SETNOSIGPIPE, 1);
+#endif
+
+    pqrs::process::file_actions actions;
+    add_file_actions(actions, *stdin_pipe_, STDIN_FILENO, true);
+    add_file_actions(actions, *stdout_pipe_, STDOUT_FILENO, false);
+    add_file_actions(actions, *stderr_pipe_, STDERR_FILENO, false);
+
+    char sh[] = "/bin/sh";
+    char* argv[] = {sh, nullptr};
+
+    pid_t pid;
+    if (posix_spawn(&pid,
+                    argv[0],
+                    actions.get_actions(),
+                    nullptr,
+                    argv,
+                    environ) != 0) {
+      close_pipes();
+      return false;
+    }
+
+    pid_ = pid;
+
+    stdin_pipe_->close_read_end();
+    stdout_pipe_->close_write_end();
+    stderr_pipe_->close_write_end();
+
+    killed_ = false;
+    thread_ = std::make_unique<std::thread>([this,
+                                             pid,
+                                             stdout_fd = *stdout_read_end,
+                                             stderr_fd = *stderr_read_end,
+                                             wakeup_fd = *wakeup_read_end] {
+      poll_output(pid, stdout_fd, stderr_fd, wakeup_fd);
+    });
+
+    return true;
+  }
+
+  // Call from the dispatcher thread.
+  [[nodiscard]] bool running() const {
+    return pid_ != std::nullopt;
+  }
+
+  // Call from the dispatcher thread.
+  [[nodiscard]] bool busy() const {
+    return command_id_ != std::nullopt;
+  }
+
+  // Run the command in the worker.
+  // Returns false if the worker is not running or busy.
+  // Call from the dispatcher thread.
+  bool run(uint64_t command_id, const std::string& command) {
+    if (!running() || busy()) {
+      return false;
+    }
+
+    auto fd = stdin_pipe_ ? stdin_pipe_->get_write_end() : std::nullopt;
+    if (!fd) {
+      return false;
+    }
+
+    stdout_parser_.reset();
+    stderr_parser_.reset();
+
+    if (!write_all(*fd, make_script(marker_, command))) {
+      // The worker state is unknown after a partial write.
+      terminate();
+      return false;
+    }
+
+    command_id_ = command_id;
+
+    return true;
+  }
+
+  static std::string make_script(const std::string& marker,
+                                 const std::string& command) {
+    std::string script;
+    script.reserve(command.size() + marker.size() * 4 + 192);
+
+    script += "printf '\\n%s start\\n' '" + marker + "'\n";
+    script += "printf '\\n%s start\\n' '" + marker + "' >&2\n";
+    script += "( eval '";
+    for (auto c : command) {
+      if (c == '\'') {
+        script += "'\\''";
+      } else {
+        script += c;
+      }
+    }
+    script += "' ) </dev/null\n";
+    script += "krbn_status=$?\n";
+    script += "printf '\\n%s end %d\\n' '" + marker + "' \"$krbn_status\"\n";
+    script += "printf '\\n%s end %d\\n' '" + marker + "' \"$krbn_status\" >&2\n";
+
+    return script;
+  }
+
+private:
+  static std::string make_marker() {
+    static std::random_device random_device;
+    static std::mt19937_64 engine(random_device());
+
+    std::stringstream ss;
+    ss << "karabiner-shell-command-worker-"
+       << std::hex << std::setw(16) << std::setfill('0') << engine();
+    return ss.str();
+  }
+
+  static void add_file_actions(pqrs::process::file_actions& actions,
+                               const pqrs::process::pipe& pipe,
+                               int target_fd,
+                               bool read) {
+    auto child_end = read ? pipe.get_read_end() : pipe.get_write_end();
+    auto parent_end = read ? pipe.get_write_end() : pipe.get_read_end();
+
+    if (parent_end) {
+      actions.addclose(*parent_end);
+    }
+    if (child_end) {
+      actions.adddup2(*child_end, target_fd);
+      actions.addclose(*child_end);
+    }
+  }
+
+  static bool write_all(int fd, const std::string& data) {
+    const char* p = data.data();
+    auto remaining = data.size();
+
+    while (remaining > 0) {
+      auto n = write(fd, p, remaining);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return false;
+      }
+      p += n;
+      remaining -= n;
+    }
+
+    return true;
+  }
+
+  // Run in thread_.
+  // `terminate` closes the write end of wakeup_pipe_ to wake up poll.
+  void poll_output(pid_t pid, int stdout_fd, int stderr_fd, int wakeup_fd) {
+    // The first entry is the wakeup file descriptor.
+    std::vector<pollfd> poll_file_descriptors{
+        {wakeup_fd, POLLIN, 0},
+        {stdout_fd, POLLIN, 0},
+        {stderr_fd, POLLIN, 0},
+    };
+    auto output_file_descriptors_begin = std::next(std::begin(poll_file_descriptors));
+    std::vector<uint8_t> buffer(32 * 1024);
+    constexpr int timeout = 500;
+
+    while (!killed_) {
+      if (std::none_of(output_file_descriptors_begin,
+                       std::end(poll_file_descriptors),
+                       [](const auto& poll_file_descriptor) {
+                         return poll_file_descriptor.fd != -1;
+                       })) {
+        break;
+      }
+
+      auto poll_result = poll(poll_file_descriptors.data(), poll_file_descriptors.size(), timeout);
+      if (poll_result < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        break;
+      } else if (poll_result == 0) {
+        // Background processes launched by commands may keep the pipes open after the worker exited.
+        // Thus, check the worker process itself on timeout.
+        int stat;
+        if (waitpid(pid, &stat, WNOHANG) == pid) {
+          if (!killed_) {
+            enqueue_to_dispatcher([this] {
+              handle_exited();
+            });
+          }
+          return;
+        }
+        continue;
+      }
+
+      if (poll_file_descriptors.front().revents != 0) {
+        break;
+      }
+
+      for (auto it = output_file_descriptors_begin; it != std::end(poll_file_descriptors); ++it) {
+        auto& poll_file_descriptor = *it;
+        if (poll_file_descriptor.fd == -1 ||
+            !(poll_file_descriptor.revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))) {
+          continue;
+        }
+
+        auto n = read(poll_file_descriptor.fd, buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) {
+          continue;
+        }
+        if (n <= 0) {
+          poll_file_descriptor.fd = -1;
+          continue;
+        }
+
+        auto b = std::make_shared<std::vector<uint8_t>>(std::begin(buffer), std::begin(buffer) + n);
+        if (poll_file_descriptor.fd == stdout_fd) {
+          enqueue_to_dispatcher([this, b] {
+            handle_output(stdout_parser_, stdout_received, *b);
+          });
+        } else {
+          enqueue_to_dispatcher([this, b] {
+            handle_output(stderr_parser_, stderr_received, *b);
+          });
+        }
+      }
+    }
+
+    // Wait the worker process.
+    // (The worker is killed in `terminate` if killed_ is true.)
+    int stat;
+    pid_t waitpid_result;
+    do {
+      waitpid_result = waitpid(pid, &stat, 0);
+    } while (waitpid_result == -1 && errno == EINTR);
+
+    if (!killed_) {
+      enqueue_to_dispatcher([this] {
+        handle_exited();
+      });
+    }
+  }
+
+  // Run in the dispatcher thread.
+  void handle_output(output_parser& parser,
+                     nod::signal<void(uint64_t, std::shared_ptr<std::vector<uint8_t>>)>& signal,
+                     const std::vector<uint8_t>& buffer) {
+    if (!command_id_) {
+      return;
+    }
+
+    auto output = parser.append(buffer.data(), buffer.size());
+    if (!output.empty()) {
+      signal(*command_id_, std::make_shared<std::vector<uint8_t>>(std::move(output)));
+    }
+
+    if (auto exit_status = stdout_parser_.get_exit_status()) {
+      if (stderr_parser_.get_exit_status()) {
+        auto command_id = *command_id_;
+        command_id_ = std::nullopt;
+        command_finished(command_id, *exit_status);
+      }
+    }
+  }
+
+  // Run in the dispatcher thread.
+  void handle_exited() {
+    if (!pid_) {
+      return;
+    }
+
+    terminate();
+
+    auto command_id = command_id_;
+    command_id_ = std::nullopt;
+    exited(command_id);
+  }
+
+  void terminate() {
+    killed_ = true;
+
+    // Close stdin at first to let the worker exit normally.
+    if (stdin_pipe_) {
+      stdin_pipe_->close_write_end();
+    }
+
+    if (pid_) {
+      ::kill(*pid_, SIGKILL);
+      pid_ = std::nullopt;
+    }
+
+    // Wake up thread_ which may wait for the output of background processes launched by commands.
+    if (wakeup_pipe_) {
+      wakeup_pipe_->close_write_end();
+    }
+
+    // thread_ reaps the worker process.
+    if (thread_ && thread_->joinable()) {
+      thread_->join();
+    }
+    thread_ = nullptr;
+
+    close_pipes();
+  }
+
+  void close_pipes() {
+    stdin_pipe_ = nullptr;
+    stdout_pipe_ = nullptr;
+    stderr_pipe_ = nullptr;
+    wakeup_pipe_ = nullptr;
+  }
+
+  const std::string marker_;
+
+  // Accessed only from the dispatcher thread.
+  std::unique_ptr<pqrs::process::pipe> stdin_pipe_;
+  std::unique_ptr<pqrs::process::pipe> stdout_pipe_;
+  std::unique_ptr<pqrs::process::pipe> stderr_pipe_;
+  std::unique_ptr<pqrs::process::pipe> wakeup_pipe_;
+  std::optional<pid_t> pid_;
+  std::optional<uint64_t> command_id_;
+  output_parser stdout_parser_;
+  output_parser stderr_parser_;
+  std::unique_ptr<std::thread> thread_;
+
+  std::atomic<bool> killed_;
+};
+} // namespace krbn
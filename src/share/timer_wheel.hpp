@@ -0,0 +1,364 @@
+#pragma once
+
+// `krbn::timer_wheel` can be used safely in a multi-threaded environment.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <pqrs/dispatcher.hpp>
+#include <vector>
+
+namespace krbn {
+// A hashed timer wheel for short timers which are canceled and re-armed frequently
+// (to_if_held_down, to_delayed_action, etc.).
+//
+// pqrs::dispatcher keeps scheduled functions in a sorted deque, so each schedule costs a sorted insert,
+// allocations for the entry and the function, and canceled functions stay in the deque until their time comes.
+// timer_wheel links timers into intrusive lists of 1 ms slots instead.
+// Schedule and cancel are O(1) without allocations, and the wheel keeps only a few entries in the dispatcher
+// at the earliest deadline.
+//
+// An expired function is called via `dispatcher_client::enqueue_to_dispatcher` of the timer owner,
+// so it is not called after the owner is detached from the dispatcher.
+class timer_wheel final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  class entry final {
+  public:
+    entry(const entry&) = delete;
+
+    explicit entry(pqrs::dispatcher::extra::dispatcher_client& dispatcher_client)
+        : dispatcher_client_(dispatcher_client),
+          generation_(0) {
+    }
+
+    [[nodiscard]] pqrs::dispatcher::extra::dispatcher_client& get_dispatcher_client() const {
+      return dispatcher_client_;
+    }
+
+    [[nodiscard]] uint64_t get_generation() const {
+      return generation_;
+    }
+
+    // Invalidate functions which are already enqueued to the dispatcher.
+    uint64_t increment_generation() {
+      return ++generation_;
+    }
+
+  private:
+    friend class timer_wheel;
+
+    pqrs::dispatcher::extra::dispatcher_client& dispatcher_client_;
+    std::atomic<uint64_t> generation_;
+
+    // The following members are protected by timer_wheel::mutex_.
+
+    std::function<void()> function_;
+    pqrs::dispatcher::time_point when_;
+    uint64_t sequence_ = 0;
+    size_t slot_index_ = 0;
+    entry* previous_ = nullptr;
+    entry* next_ = nullptr;
+    bool linked_ = false;
+  };
+
+  timer_wheel(const timer_wheel&) = delete;
+
+  explicit timer_wheel(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher = pqrs::dispatcher::extra::get_shared_dispatcher())
+      : dispatcher_client(weak_dispatcher),
+        slots_{},
+        occupied_{},
+        size_(0),
+        sequence_(0) {
+  }
+
+  ~timer_wheel() override {
+    detach_from_dispatcher();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& s : slots_) {
+      while (s.head) {
+        unlink(*s.head);
+      }
+    }
+  }
+
+  // Replace the function of `e` and schedule it at `when`.
+  // The previous schedule of `e` is canceled.
+  bool schedule(entry& e,
+                std::function<void()> function,
+                pqrs::dispatcher::time_point when) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!attached()) {
+      return false;
+    }
+
+    e.increment_generation();
+    e.function_ = std::move(function);
+
+    if (e.linked_) {
+      unlink(e);
+    }
+
+    e.when_ = when;
+    e.sequence_ = ++sequence_;
+    link(e);
+
+    if (!armed_when_ || when < *armed_when_) {
+      arm(when);
+    }
+
+    return true;
+  }
+
+  void cancel(entry& e) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    e.increment_generation();
+    e.function_ = nullptr;
+
+    if (e.linked_) {
+      unlink(e);
+    }
+  }
+
+  [[nodiscard]] size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return size_;
+  }
+
+private:
+  static constexpr size_t slot_count = 1024;
+  static constexpr size_t occupied_word_bits = 64;
+
+  struct slot final {
+    entry* head;
+    entry* tail;
+  };
+
+  static int64_t make_tick(pqrs::dispatcher::time_point time_point) {
+    return time_point.time_since_epoch().count();
+  }
+
+  static size_t make_slot_index(int64_t tick) {
+    return static_cast<size_t>(static_cast<uint64_t>(tick) % slot_count);
+  }
+
+  void link(entry& e) {
+    auto tick = make_tick(e.when_);
+    if (last_processed_tick_ && tick < *last_processed_tick_) {
+      // Put past timers into the slot which is scanned by the next `process`.
+      tick = *last_processed_tick_;
+    }
+
+    auto index = make_slot_index(tick);
+    auto& s = slots_[index];
+
+    e.slot_index_ = index;
+    e.previous_ = s.tail;
+    e.next_ = nullptr;
+    if (s.tail) {
+      s.tail->next_ = &e;
+    } else {
+      s.head = &e;
+    }
+    s.tail = &e;
+    e.linked_ = true;
+
+    occupied_[index / occupied_word_bits] |= (uint64_t(1) << (index % occupied_word_bits));
+    ++size_;
+  }
+
+  void unlink(entry& e) {
+    auto index = e.slot_index_;
+    auto& s = slots_[index];
+
+    if (e.previous_) {
+      e.previous_->next_ = e.next_;
+    } else {
+      s.head = e.next_;
+    }
+    if (e.next_) {
+      e.next_->previous_ = e.previous_;
+    } else {
+      s.tail = e.previous_;
+    }
+
+    e.previous_ = nullptr;
+    e.next_ = nullptr;
+    e.linked_ = false;
+
+    if (!s.head) {
+      occupied_[index / occupied_word_bits] &= ~(uint64_t(1) << (index % occupied_word_bits));
+    }
+    --size_;
+  }
+
+  void arm(pqrs::dispatcher::time_point when) {
+    armed_when_ = when;
+
+    enqueue_to_dispatcher(
+        [this, when] {
+          fire(when);
+        },
+        when);
+  }
+
+  // This method is executed in the dispatcher thread.
+  void fire(pqrs::dispatcher::time_point when) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (armed_when_ != when) {
+      // The wheel is re-armed at an earlier time.
+      return;
+    }
+    armed_when_ = std::nullopt;
+
+    auto now = make_tick(when_now());
+
+    process(now);
+
+    // Call expired functions in the order of schedules.
+    std::ranges::sort(expired_entries_,
+                      [](const entry* a, const entry* b) {
+                        if (a->when_ != b->when_) {
+                          return a->when_ < b->when_;
+                        }
+                        return a->sequence_ < b->sequence_;
+                      });
+
+    for (auto e : expired_entries_) {
+      auto generation = e->get_generation();
+      e->get_dispatcher_client().enqueue_to_dispatcher([e, generation, function = std::move(e->function_)] {
+        if (e->get_generation() != generation) {
+          return;
+        }
+
+        if (function) {
+          function();
+        }
+      });
+      e->function_ = nullptr;
+    }
+    expired_entries_.clear();
+
+    if (size_ > 0) {
+      arm(pqrs::dispatcher::time_point(pqrs::dispatcher::duration(find_next_tick(now))));
+    }
+  }
+
+  // Move expired entries into `expired_entries_`.
+  void process(int64_t now) {
+    // Scan all slots when the time goes backward (e.g., pseudo_time_source is set) or jumps over the wheel.
+    bool scan_all = !last_processed_tick_ ||
+                    now < *last_processed_tick_ ||
+                    now - *last_processed_tick_ >= static_cast<int64_t>(slot_count);
+
+    auto begin = scan_all ? now - static_cast<int64_t>(slot_count) + 1 : *last_processed_tick_;
+
+    for (auto tick = begin; tick <= now; ++tick) {
+      auto index = make_slot_index(tick);
+      if (!(occupied_[index / occupied_word_bits] & (uint64_t(1) << (index % occupied_word_bits)))) {
+        continue;
+      }
+
+      auto e = slots_[index].head;
+      while (e) {
+        auto next = e->next_;
+        auto tick = make_tick(e->when_);
+        if (tick <= now) {
+          unlink(*e);
+          expired_entries_.push_back(e);
+        } else if (make_slot_index(tick) != index) {
+          // A past timer which is linked in `link` became a future timer since the time went backward.
+          unlink(*e);
+          relinked_entries_.push_back(e);
+        }
+        e = next;
+      }
+    }
+
+    last_processed_tick_ = now;
+
+    for (auto e : relinked_entries_) {
+      link(*e);
+    }
+    relinked_entries_.clear();
+  }
+
+  // Return the tick of the next occupied slot after `now`.
+  // The returned tick might be earlier than the actual deadline if the slot contains timers of the later rounds.
+  // In that case, the wheel is re-armed when the tick comes.
+  int64_t find_next_tick(int64_t now) const {
+    auto index = make_slot_index(now);
+
+    for (size_t distance = 1; distance <= slot_count;) {
+      auto i = (index + distance) % slot_count;
+      auto word = occupied_[i / occupied_word_bits] >> (i % occupied_word_bits);
+      if (word) {
+        auto d = distance + static_cast<size_t>(std::countr_zero(word));
+        return now + static_cast<int64_t>(std::min(d, slot_count));
+      }
+
+      // Skip to the next word.
+      distance += occupied_word_bits - (i % occupied_word_bits);
+    }
+
+    return now + static_cast<int64_t>(slot_count);
+  }
+
+  std::array<slot, slot_count> slots_;
+  std::array<uint64_t, slot_count / occupied_word_bits> occupied_;
+  size_t size_;
+  uint64_t sequence_;
+  std::optional<int64_t> last_processed_tick_;
+  std::optional<pqrs::dispatcher::time_point> armed_when_;
+  std::vector<entry*> expired_entries_;
+  std::vector<entry*> relinked_entries_;
+  mutable std::mutex mutex_;
+};
+
+[[nodiscard]] inline std::shared_ptr<timer_wheel>& get_shared_timer_wheel_storage() {
+  static std::shared_ptr<timer_wheel> p;
+  return p;
+}
+
+[[nodiscard]] inline std::mutex& get_shared_timer_wheel_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Call after pqrs::dispatcher::extra::initialize_shared_dispatcher.
+inline void initialize_shared_timer_wheel() {
+  std::lock_guard<std::mutex> lock(get_shared_timer_wheel_mutex());
+
+  get_shared_timer_wheel_storage() = std::make_shared<timer_wheel>();
+}
+
+// Call before pqrs::dispatcher::extra::terminate_shared_dispatcher.
+inline void terminate_shared_timer_wheel() {
+  std::shared_ptr<timer_wheel> p;
+
+  {
+    std::lock_guard<std::mutex> lock(get_shared_timer_wheel_mutex());
+
+    p = std::move(get_shared_timer_wheel_storage());
+  }
+
+  // Release the wheel outside of the lock since it waits for the running function in `detach_from_dispatcher`.
+  p = nullptr;
+}
+
+[[nodiscard]] inline std::weak_ptr<timer_wheel> get_shared_timer_wheel() {
+  std::lock_guard<std::mutex> lock(get_shared_timer_wheel_mutex());
+
+  return get_shared_timer_wheel_storage();
+}
+} // namespace krbn
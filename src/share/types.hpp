@@ -18,8 +18,10 @@
 #include "types/manipulator_environment_variable_set_variable.hpp"
 #include "types/manipulator_environment_variable_value.hpp"
 #include "types/modifier_flag.hpp"
+#include "types/modifier_flag_mask.hpp"
 #include "types/momentary_switch_event.hpp"
 #include "types/mouse_key.hpp"
+#include "types/multitouch_extension_variables.hpp"
 #include "types/notification_message.hpp"
 #include "types/operation_type.hpp"
 #include "types/pointing_motion.hpp"
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <nlohmann/json.hpp>
+#include <pqrs/hash.hpp>
 #include <pqrs/hid.hpp>
 #include <pqrs/hid/extra/nlohmann_json.hpp>
 
@@ -281,3 +282,23 @@ inline void from_json(const nlohmann::json& json, device_identifiers& value) {
   value = device_identifiers(json);
 }
 } // namespace krbn
+
+namespace std {
+template <>
+struct hash<krbn::device_identifiers> final {
+  std::size_t operator()(const krbn::device_identifiers& value) const {
+    std::size_t h = 0;
+
+    pqrs::hash::combine(h, value.get_vendor_id());
+    pqrs::hash::combine(h, value.get_product_id());
+    pqrs::hash::combine(h, value.get_is_keyboard());
+    pqrs::hash::combine(h, value.get_is_pointing_device());
+    pqrs::hash::combine(h, value.get_is_game_pad());
+    pqrs::hash::combine(h, value.get_is_consumer());
+    pqrs::hash::combine(h, value.get_is_virtual_device());
+    pqrs::hash::combine(h, value.get_device_address());
+
+    return h;
+  }
+};
+} // namespace std
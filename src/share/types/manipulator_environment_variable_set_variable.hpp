@@ -22,12 +22,12 @@ public:
                                                 std::optional<manipulator_environment_variable_value> key_up_value,
                                                 std::shared_ptr<exprtk_utility::expression_wrapper> key_up_expression,
                                                 type type = type::set)
-      : name_(name),
-        value_(value),
+      : value_(value),
         expression_(expression),
         key_up_value_(key_up_value),
         key_up_expression_(key_up_expression),
         type_(type) {
+    set_name(name);
   }
 
   [[nodiscard]] std::optional<std::string> get_name() const {
@@ -36,6 +36,17 @@ public:
 
   void set_name(std::optional<std::string> value) {
     name_ = value;
+
+    if (name_) {
+      slot_id_ = get_shared_variable_slot_registry()->intern(*name_);
+    } else {
+      slot_id_ = std::nullopt;
+    }
+  }
+
+  // The slot id of `name`. It is interned when the name is set.
+  [[nodiscard]] std::optional<variable_slot_id> get_slot_id() const {
+    return slot_id_;
   }
 
   [[nodiscard]] std::optional<manipulator_environment_variable_value> get_value() const {
@@ -93,6 +104,7 @@ public:
 
 private:
   std::optional<std::string> name_;
+  std::optional<variable_slot_id> slot_id_;
   std::optional<manipulator_environment_variable_value> value_;
   std::shared_ptr<exprtk_utility::expression_wrapper> expression_;
   std::optional<manipulator_environment_variable_value> key_up_value_;
@@ -28,14 +28,14 @@ public:
     return std::get_if<T>(&value_);
   }
 
-  void apply_to_expression_variable(const std::string& variable_name,
+  void apply_to_expression_variable(variable_slot_id slot_id,
                                     pqrs::not_null_shared_ptr_t<exprtk_utility::expression_wrapper> expression) const {
     if (auto v = get_if<int64_t>()) {
-      expression->set_variable(variable_name, *v);
+      expression->set_variable(slot_id, static_cast<double>(*v));
     } else if (auto v = get_if<bool>()) {
-      expression->set_variable(variable_name, *v);
+      expression->set_variable(slot_id, static_cast<double>(*v));
     } else if (auto v = get_if<std::string>()) {
-      expression->set_variable(variable_name, *v);
+      expression->set_variable(slot_id, *v);
     }
   }
 
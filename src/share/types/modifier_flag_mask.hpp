@@ -0,0 +1,84 @@
+#pragma once
+
+#include "modifier_flag.hpp"
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+
+namespace krbn {
+// A set of modifier_flag stored in a bitmask.
+class modifier_flag_mask final {
+public:
+  modifier_flag_mask() : bits_(0) {
+  }
+
+  modifier_flag_mask(std::initializer_list<modifier_flag> flags) : bits_(0) {
+    for (const auto& f : flags) {
+      insert(f);
+    }
+  }
+
+  [[nodiscard]] static bool valid(modifier_flag flag) {
+    return flag < modifier_flag::end_;
+  }
+
+  void insert(modifier_flag flag) {
+    if (valid(flag)) {
+      bits_ |= make_bit(flag);
+    }
+  }
+
+  void erase(modifier_flag flag) {
+    if (valid(flag)) {
+      bits_ &= ~make_bit(flag);
+    }
+  }
+
+  [[nodiscard]] bool contains(modifier_flag flag) const {
+    return valid(flag) && (bits_ & make_bit(flag)) != 0;
+  }
+
+  [[nodiscard]] bool empty() const {
+    return bits_ == 0;
+  }
+
+  [[nodiscard]] size_t size() const {
+    return static_cast<size_t>(std::popcount(bits_));
+  }
+
+  [[nodiscard]] uint32_t get_bits() const {
+    return bits_;
+  }
+
+  bool operator==(const modifier_flag_mask&) const = default;
+
+private:
+  static uint32_t make_bit(modifier_flag flag) {
+    return uint32_t(1) << static_cast<uint32_t>(flag);
+  }
+
+  uint32_t bits_;
+};
+
+static_assert(static_cast<uint32_t>(modifier_flag::end_) <= 32);
+
+inline std::ostream& operator<<(std::ostream& stream, const modifier_flag_mask& value) {
+  stream << "[";
+
+  bool first = true;
+  for (auto i = static_cast<uint32_t>(modifier_flag::zero); i < static_cast<uint32_t>(modifier_flag::end_); ++i) {
+    auto flag = modifier_flag(i);
+    if (value.contains(flag)) {
+      if (!first) {
+        stream << ",";
+      }
+      stream << flag;
+      first = false;
+    }
+  }
+
+  stream << "]";
+  return stream;
+}
+} // namespace krbn
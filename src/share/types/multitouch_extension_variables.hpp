@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <pqrs/json.hpp>
+#include <vector>
+
+namespace krbn {
+// The finger and palm counts which Karabiner-MultitouchExtension sends to the core_service daemon.
+//
+// Karabiner-MultitouchExtension sends the counts for each touch frame,
+// so they are sent as a compact binary message instead of a msgpack json object.
+// The message contains only the counts which are changed since the previous message.
+//
+// Message layout (little-endian):
+//
+//   uint8_t  marker         (message_marker)
+//   uint8_t  version        (message_version)
+//   uint16_t changed_mask   (bit N represents names[N])
+//   int32_t  values[]       (the values of the changed counts in the order of names)
+class multitouch_extension_variables final {
+public:
+  static constexpr std::array names{
+      "multitouch_extension_finger_count_upper_quarter_area",
+      "multitouch_extension_finger_count_lower_quarter_area",
+      "multitouch_extension_finger_count_left_quarter_area",
+      "multitouch_extension_finger_count_right_quarter_area",
+      "multitouch_extension_finger_count_upper_half_area",
+      "multitouch_extension_finger_count_lower_half_area",
+      "multitouch_extension_finger_count_left_half_area",
+      "multitouch_extension_finger_count_right_half_area",
+      "multitouch_extension_finger_count_total",
+      "multitouch_extension_palm_count_upper_half_area",
+      "multitouch_extension_palm_count_lower_half_area",
+      "multitouch_extension_palm_count_left_half_area",
+      "multitouch_extension_palm_count_right_half_area",
+      "multitouch_extension_palm_count_total",
+  };
+
+  using values_t = std::array<int32_t, names.size()>;
+  using changed_mask_t = uint16_t;
+
+  static_assert(names.size() <= sizeof(changed_mask_t) * 8);
+
+  static constexpr changed_mask_t all_mask = (1 << names.size()) - 1;
+
+  // 0xc1 is never used in msgpack.
+  // Thus, the message can be distinguished from msgpack messages by the first byte.
+  static constexpr uint8_t message_marker = 0xc1;
+  static constexpr uint8_t message_version = 1;
+  static constexpr size_t message_header_size = 4;
+
+  multitouch_extension_variables()
+      : values_{} {
+  }
+
+  explicit multitouch_extension_variables(const values_t& values)
+      : values_(values) {
+  }
+
+  [[nodiscard]] const values_t& get_values() const {
+    return values_;
+  }
+
+  [[nodiscard]] changed_mask_t make_changed_mask(const multitouch_extension_variables& other) const {
+    changed_mask_t mask = 0;
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (values_[i] != other.values_[i]) {
+        mask |= (1 << i);
+      }
+    }
+    return mask;
+  }
+
+  [[nodiscard]] std::vector<uint8_t> make_message(changed_mask_t changed_mask) const {
+    changed_mask &= all_mask;
+
+    std::vector<uint8_t> message;
+    message.reserve(message_header_size + sizeof(int32_t) * std::popcount(changed_mask));
+
+    message.push_back(message_marker);
+    message.push_back(message_version);
+    message.push_back(static_cast<uint8_t>(changed_mask & 0xff));
+    message.push_back(static_cast<uint8_t>((changed_mask >> 8) & 0xff));
+
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (changed_mask & (1 << i)) {
+        auto v = static_cast<uint32_t>(values_[i]);
+        message.push_back(static_cast<uint8_t>(v & 0xff));
+        message.push_back(static_cast<uint8_t>((v >> 8) & 0xff));
+        message.push_back(static_cast<uint8_t>((v >> 16) & 0xff));
+        message.push_back(static_cast<uint8_t>((v >> 24) & 0xff));
+      }
+    }
+
+    return message;
+  }
+
+  [[nodiscard]] static bool is_message(const std::vector<uint8_t>& buffer) {
+    return !buffer.empty() &&
+           buffer[0] == message_marker;
+  }
+
+  // Apply the values in the message.
+  // Returns the changed_mask of the message, or std::nullopt if the message is malformed.
+  // (The values are not modified if the message is malformed.)
+  [[nodiscard]] std::optional<changed_mask_t> apply_message(const std::vector<uint8_t>& buffer) {
+    if (buffer.size() < message_header_size ||
+        buffer[0] != message_marker ||
+        buffer[1] != message_version) {
+      return std::nullopt;
+    }
+
+    auto changed_mask = static_cast<changed_mask_t>(buffer[2] | (buffer[3] << 8));
+    if ((changed_mask & ~all_mask) != 0 ||
+        buffer.size() != message_header_size + sizeof(int32_t) * std::popcount(changed_mask)) {
+      return std::nullopt;
+    }
+
+    auto p = std::begin(buffer) + message_header_size;
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (changed_mask & (1 << i)) {
+        auto v = static_cast<uint32_t>(p[0]) |
+                 (static_cast<uint32_t>(p[1]) << 8) |
+                 (static_cast<uint32_t>(p[2]) << 16) |
+                 (static_cast<uint32_t>(p[3]) << 24);
+        values_[i] = static_cast<int32_t>(v);
+        p += sizeof(int32_t);
+      }
+    }
+
+    return changed_mask;
+  }
+
+  constexpr bool operator==(const multitouch_extension_variables&) const = default;
+
+private:
+  values_t values_;
+};
+
+inline void to_json(nlohmann::json& json, const multitouch_extension_variables& value) {
+  json = nlohmann::json::object();
+
+  const auto& values = value.get_values();
+  for (size_t i = 0; i < values.size(); ++i) {
+    json[multitouch_extension_variables::names[i]] = values[i];
+  }
+}
+} // namespace krbn
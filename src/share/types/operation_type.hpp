@@ -48,11 +48,15 @@ enum class operation_type : uint8_t {
   observe_notification_message,
   get_system_variables, // Return only the system.* entries from manipulator_environment.variables.
   get_multitouch_extension_variables,
+  observe_multitouch_extension_variables,
+  set_latency_trace_enabled,
+  get_latency_trace,
   // core_service (daemon) -> any
   connected_devices,
   notification_message,
   system_variables,
   multitouch_extension_variables,
+  latency_trace,
   end_,
 };
 
@@ -91,10 +95,14 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
         {operation_type::observe_notification_message, "observe_notification_message"},
         {operation_type::get_system_variables, "get_system_variables"},
         {operation_type::get_multitouch_extension_variables, "get_multitouch_extension_variables"},
+        {operation_type::observe_multitouch_extension_variables, "observe_multitouch_extension_variables"},
+        {operation_type::set_latency_trace_enabled, "set_latency_trace_enabled"},
+        {operation_type::get_latency_trace, "get_latency_trace"},
         {operation_type::connected_devices, "connected_devices"},
         {operation_type::notification_message, "notification_message"},
         {operation_type::system_variables, "system_variables"},
         {operation_type::multitouch_extension_variables, "multitouch_extension_variables"},
+        {operation_type::latency_trace, "latency_trace"},
         {operation_type::end_, "end_"},
     });
 } // namespace krbn
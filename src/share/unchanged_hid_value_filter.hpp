@@ -0,0 +1,278 @@
+#pragma once
+
+// `krbn::unchanged_hid_value_filter` can be used safely in a single-threaded environment.
+
+#include "types.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <pqrs/osx/chrono.hpp>
+#include <pqrs/osx/iokit_hid_value.hpp>
+#include <vector>
+
+namespace krbn {
+// unchanged_hid_value_filter removes HID values which do not change the state of the device.
+//
+// Why this is needed:
+// Some game pads, foot pedals and vendor devices keep sending the same button states and
+// slightly jittering axis values even when no input is made.
+// These values cost the event pipeline and the dispatcher time without any effect.
+//
+// Behavior:
+// - The last passed value is kept for each (usage_page, usage) in a small sorted table.
+// - A value is removed if it is equal to the last passed value.
+// - A value of a continuous axis (e.g., generic_desktop x, y, rx, slider, simulation controls) is also removed
+//   if the difference from the last passed value is within dead_band.
+//   The dead band is not applied to categorical elements such as hat switches,
+//   because neighboring values are different states (e.g., north and north-east).
+// - Values of elements which have a negative logical_min are always passed,
+//   because they are usually relative values (e.g., pointing motion, wheels)
+//   and the same value is meaningful for each report.
+//
+// The filter is active when parameters::enabled is true, or once the device sends
+// more than parameters::auto_enable_values_per_second values per second.
+//
+// The passed and dropped counts are also summarized for each report_interval,
+// so that the counts of devices which stay grabbed can be reported periodically.
+class unchanged_hid_value_filter final {
+public:
+  struct counts final {
+    uint64_t passed = 0;
+    uint64_t dropped = 0;
+
+    bool operator==(const counts&) const = default;
+  };
+
+  struct parameters final {
+    bool enabled = false;
+    int dead_band = 0;
+    // 0 disables the automatic activation.
+    int auto_enable_values_per_second = 0;
+
+    bool operator==(const parameters&) const = default;
+  };
+
+  unchanged_hid_value_filter()
+      : auto_enabled_(false),
+        window_duration_(pqrs::osx::chrono::make_absolute_time_duration(std::chrono::seconds(1))),
+        window_values_count_(0),
+        passed_count_(0),
+        dropped_count_(0),
+        report_interval_(pqrs::osx::chrono::make_absolute_time_duration(std::chrono::seconds(60))) {
+  }
+
+  [[nodiscard]] const parameters& get_parameters() const {
+    return parameters_;
+  }
+
+  void set_parameters(const parameters& value) {
+    if (parameters_ == value) {
+      return;
+    }
+
+    parameters_ = value;
+    auto_enabled_ = false;
+    window_begin_ = std::nullopt;
+    window_values_count_ = 0;
+    last_values_.clear();
+  }
+
+  // Call when the device is reopened since the device state is also reset.
+  void reset() {
+    last_values_.clear();
+  }
+
+  [[nodiscard]] bool active() const {
+    return parameters_.enabled || auto_enabled_;
+  }
+
+  [[nodiscard]] bool get_auto_enabled() const {
+    return auto_enabled_;
+  }
+
+  [[nodiscard]] uint64_t get_passed_count() const {
+    return passed_count_;
+  }
+
+  [[nodiscard]] uint64_t get_dropped_count() const {
+    return dropped_count_;
+  }
+
+  // Returns the counts since the previous report when report_interval has passed in `filter`.
+  // (std::nullopt if no report is pending or no value was dropped in the interval.)
+  std::optional<counts> take_periodic_report() {
+    auto r = pending_report_;
+    pending_report_ = std::nullopt;
+    return r;
+  }
+
+  // Remove the unchanged values from `hid_values` in place.
+  // Returns true when the filter is automatically enabled by this call.
+  bool filter(std::vector<pqrs::osx::iokit_hid_value>& hid_values) {
+    if (hid_values.empty()) {
+      return false;
+    }
+
+    auto time_stamp = hid_values.back().get_time_stamp();
+    auto auto_enabled = update_event_rate(hid_values);
+
+    if (!active()) {
+      passed_count_ += hid_values.size();
+      update_periodic_report(time_stamp);
+      return auto_enabled;
+    }
+
+    auto size = hid_values.size();
+
+    std::erase_if(hid_values,
+                  [this](const auto& v) {
+                    return unchanged(v);
+                  });
+
+    passed_count_ += hid_values.size();
+    dropped_count_ += size - hid_values.size();
+    update_periodic_report(time_stamp);
+
+    return auto_enabled;
+  }
+
+private:
+  struct last_value final {
+    uint64_t key;
+    CFIndex integer_value;
+  };
+
+  void update_periodic_report(absolute_time_point time_stamp) {
+    if (!report_begin_ ||
+        time_stamp < *report_begin_) {
+      report_begin_ = time_stamp;
+      return;
+    }
+
+    if (time_stamp - *report_begin_ < report_interval_) {
+      return;
+    }
+
+    counts c{
+        .passed = passed_count_ - reported_counts_.passed,
+        .dropped = dropped_count_ - reported_counts_.dropped,
+    };
+    if (c.dropped > 0) {
+      pending_report_ = c;
+    }
+
+    report_begin_ = time_stamp;
+    reported_counts_ = counts{
+        .passed = passed_count_,
+        .dropped = dropped_count_,
+    };
+  }
+
+  bool update_event_rate(const std::vector<pqrs::osx::iokit_hid_value>& hid_values) {
+    if (auto_enabled_ ||
+        parameters_.enabled ||
+        parameters_.auto_enable_values_per_second <= 0) {
+      return false;
+    }
+
+    // Count the values in one-second windows.
+    auto time_stamp = hid_values.back().get_time_stamp();
+    if (!window_begin_ ||
+        time_stamp < *window_begin_ ||
+        time_stamp - *window_begin_ >= window_duration_) {
+      window_begin_ = time_stamp;
+      window_values_count_ = 0;
+    }
+
+    window_values_count_ += hid_values.size();
+
+    if (window_values_count_ > static_cast<uint64_t>(parameters_.auto_enable_values_per_second)) {
+      auto_enabled_ = true;
+      window_begin_ = std::nullopt;
+      window_values_count_ = 0;
+      return true;
+    }
+
+    return false;
+  }
+
+  static bool is_continuous_axis(pqrs::hid::usage_page::value_t usage_page,
+                                 pqrs::hid::usage::value_t usage) {
+    if (usage_page == pqrs::hid::usage_page::generic_desktop) {
+      return usage == pqrs::hid::usage::generic_desktop::x ||
+             usage == pqrs::hid::usage::generic_desktop::y ||
+             usage == pqrs::hid::usage::generic_desktop::z ||
+             usage == pqrs::hid::usage::generic_desktop::rx ||
+             usage == pqrs::hid::usage::generic_desktop::ry ||
+             usage == pqrs::hid::usage::generic_desktop::rz ||
+             usage == pqrs::hid::usage::generic_desktop::slider ||
+             usage == pqrs::hid::usage::generic_desktop::dial ||
+             usage == pqrs::hid::usage::generic_desktop::wheel;
+    }
+
+    // Simulation controls (e.g., throttle, accelerator, brake, steering)
+    return usage_page == pqrs::hid::usage_page::simulation;
+  }
+
+  bool unchanged(const pqrs::osx::iokit_hid_value& v) {
+    auto usage_page = v.get_usage_page();
+    auto usage = v.get_usage();
+    auto logical_max = v.get_logical_max();
+    auto logical_min = v.get_logical_min();
+
+    if (!usage_page || !usage || !logical_max || !logical_min) {
+      return false;
+    }
+
+    if (*logical_min < 0) {
+      return false;
+    }
+
+    auto key = (static_cast<uint64_t>(static_cast<uint32_t>(type_safe::get(*usage_page))) << 32) |
+               static_cast<uint32_t>(type_safe::get(*usage));
+    auto integer_value = v.get_integer_value();
+
+    auto it = std::lower_bound(std::begin(last_values_),
+                               std::end(last_values_),
+                               key,
+                               [](const auto& a, auto k) {
+                                 return a.key < k;
+                               });
+    if (it == std::end(last_values_) || it->key != key) {
+      last_values_.insert(it, last_value{
+                                  .key = key,
+                                  .integer_value = integer_value,
+                              });
+      return false;
+    }
+
+    auto difference = integer_value - it->integer_value;
+    if (difference < 0) {
+      difference = -difference;
+    }
+
+    auto dead_band = is_continuous_axis(*usage_page, *usage) ? std::max(0, parameters_.dead_band) : 0;
+    if (difference <= dead_band) {
+      return true;
+    }
+
+    it->integer_value = integer_value;
+    return false;
+  }
+
+  parameters parameters_;
+  bool auto_enabled_;
+  pqrs::osx::chrono::absolute_time_duration window_duration_;
+  std::optional<absolute_time_point> window_begin_;
+  uint64_t window_values_count_;
+  uint64_t passed_count_;
+  uint64_t dropped_count_;
+  pqrs::osx::chrono::absolute_time_duration report_interval_;
+  std::optional<absolute_time_point> report_begin_;
+  counts reported_counts_;
+  std::optional<counts> pending_report_;
+  // Sorted by key.
+  std::vector<last_value> last_values_;
+};
+} // namespace krbn
@@ -0,0 +1,80 @@
+#pragma once
+
+// `krbn::variable_slot_registry` can be used safely in a multi-threaded environment.
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <pqrs/gsl.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace krbn {
+// Variable names are interned into integer slot ids when the configuration is loaded.
+// manipulator_environment and exprtk_utility::expression_wrapper use slot ids to access variables without string hashing.
+using variable_slot_id = size_t;
+
+class variable_slot_registry final {
+public:
+  variable_slot_registry(const variable_slot_registry&) = delete;
+
+  variable_slot_registry() {
+  }
+
+  variable_slot_id intern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = slot_ids_.find(name);
+    if (it != std::end(slot_ids_)) {
+      return it->second;
+    }
+
+    auto slot_id = names_.size();
+    names_.push_back(name);
+    slot_ids_.emplace(name, slot_id);
+    return slot_id;
+  }
+
+  [[nodiscard]] std::optional<variable_slot_id> find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = slot_ids_.find(name);
+    if (it != std::end(slot_ids_)) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+  // The returned reference is valid as long as the registry exists since names are never removed.
+  [[nodiscard]] const std::string& get_name(variable_slot_id slot_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return names_.at(slot_id);
+  }
+
+  [[nodiscard]] size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return names_.size();
+  }
+
+private:
+  // Use std::deque to keep references to names stable.
+  std::deque<std::string> names_;
+  std::unordered_map<std::string, variable_slot_id> slot_ids_;
+
+  mutable std::mutex mutex_;
+};
+
+[[nodiscard]] inline pqrs::not_null_shared_ptr_t<variable_slot_registry> get_shared_variable_slot_registry() {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+
+  static std::shared_ptr<variable_slot_registry> p;
+  if (!p) {
+    p = std::make_shared<variable_slot_registry>();
+  }
+
+  return p;
+}
+} // namespace krbn
@@ -86,6 +86,28 @@ int main() {
       expect(monitor.get_count() == 2);
       expect(monitor.get_selected_profile_name() == "user1");
 
+      // ============================================================
+      // Touch user.json (ignored since the content is not changed.)
+      // ============================================================
+
+      system("touch target/user.json");
+
+      monitor.wait();
+
+      expect(monitor.get_count() == 2);
+      expect(monitor.get_selected_profile_name() == "user1");
+
+      // ============================================================
+      // Reformat user.json (ignored since the json is not changed.)
+      // ============================================================
+
+      system("echo '{ \"profiles\": [ { \"selected\": true, \"name\": \"user1\" } ] }' > target/user.json");
+
+      monitor.wait();
+
+      expect(monitor.get_count() == 2);
+      expect(monitor.get_selected_profile_name() == "user1");
+
       // ============================================================
       // Update system.json (ignored since user.json exists.)
       // ============================================================
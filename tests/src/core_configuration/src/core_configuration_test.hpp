@@ -294,6 +294,27 @@ void run_core_configuration_test() {
     }
   };
 
+  "file_digest and json_hash"_test = [] {
+    krbn::core_configuration::core_configuration configuration1("json/example.jsonc",
+                                                                geteuid(),
+                                                                krbn::core_configuration::error_handling::strict);
+    krbn::core_configuration::core_configuration configuration2("json/example.jsonc",
+                                                                geteuid(),
+                                                                krbn::core_configuration::error_handling::strict);
+    krbn::core_configuration::core_configuration default_configuration("json/not_found.json",
+                                                                       geteuid(),
+                                                                       krbn::core_configuration::error_handling::strict);
+
+    expect(configuration1.get_file_digest() != std::nullopt);
+    expect(configuration1.get_file_digest() == configuration2.get_file_digest());
+    expect(configuration1.get_json_hash() == configuration2.get_json_hash());
+    expect(configuration1.has_same_json(configuration2));
+
+    expect(default_configuration.get_file_digest() == std::nullopt);
+    expect(configuration1.get_json_hash() != default_configuration.get_json_hash());
+    expect(!configuration1.has_same_json(default_configuration));
+  };
+
   "load_state.permission_error"_test = [] {
     // A process running as root can read a mode 000 file, so this test is only meaningful for
     // the regular user account used to run Karabiner-Elements.
@@ -1169,6 +1190,85 @@ void run_core_configuration_test() {
     expect(pqrs::hid::product_id::value_t(1003) == profile.get_devices()[1]->get_identifiers().get_product_id());
   };
 
+  "profile.find_device"_test = [] {
+    auto json = nlohmann::json::object({
+        {"devices", nlohmann::json::array()},
+    });
+
+    for (int i = 0; i < 1000; ++i) {
+      json["devices"].push_back(nlohmann::json::object({
+          {"identifiers", {
+                              {"vendor_id", 1234},
+                              {"product_id", i},
+                              {"is_keyboard", true},
+                              {"device_address", fmt::format("aa-bb-cc-dd-{0:02x}-{1:02x}", i / 256, i % 256)},
+                          }},
+          {"treat_as_built_in_keyboard", i % 2 == 0},
+      }));
+    }
+
+    krbn::core_configuration::details::profile profile(json,
+                                                       krbn::core_configuration::error_handling::strict);
+
+    expect(1000 == profile.get_devices().size());
+
+    for (int i = 0; i < 1000; ++i) {
+      auto identifiers = krbn::device_identifiers({
+          .vendor_id = pqrs::hid::vendor_id::value_t(1234),
+          .product_id = pqrs::hid::product_id::value_t(i),
+          .is_keyboard = true,
+          .device_address = fmt::format("aa-bb-cc-dd-{0:02x}-{1:02x}", i / 256, i % 256),
+      });
+
+      auto d = profile.find_device(identifiers);
+      expect(d != nullptr);
+      expect(d == profile.get_devices()[i].get());
+      expect(d->get_treat_as_built_in_keyboard() == (i % 2 == 0));
+      expect(profile.find_device_or_default(identifiers).get() == d);
+      expect(profile.get_device(identifiers).get() == d);
+    }
+
+    // Lookups do not add devices.
+
+    auto identifiers = krbn::device_identifiers({
+        .vendor_id = pqrs::hid::vendor_id::value_t(1234),
+        .product_id = pqrs::hid::product_id::value_t(1000),
+        .is_keyboard = true,
+    });
+
+    expect(profile.find_device(identifiers) == nullptr);
+
+    {
+      auto d = profile.find_device_or_default(identifiers);
+      expect(d->get_identifiers() == identifiers);
+      expect(d->get_ignore() == false);
+      expect(d->get_manipulate_caps_lock_led() == true);
+      expect(d->get_treat_as_built_in_keyboard() == false);
+      expect(profile.find_device_or_default(identifiers)->to_json() == d->to_json());
+    }
+
+    expect(1000 == profile.get_devices().size());
+
+    // get_device adds the device.
+
+    auto d = profile.get_device(identifiers);
+    expect(1001 == profile.get_devices().size());
+    expect(profile.find_device(identifiers) == d.get());
+    expect(profile.find_device_or_default(identifiers).get() == d.get());
+
+    // The index is updated by erase_not_connected_configured_devices.
+
+    d->set_ignore(true);
+
+    krbn::connected_devices connected_devices;
+    profile.erase_not_connected_configured_devices(connected_devices);
+
+    expect(profile.find_device(identifiers) == nullptr);
+    for (const auto& device : profile.get_devices()) {
+      expect(profile.find_device(device->get_identifiers()) == device.get());
+    }
+  };
+
   "simple_modifications"_test = [] {
     // load values from json (v2)
     {
@@ -1452,6 +1552,91 @@ void run_core_configuration_test() {
     }
   };
 
+  "complex_modifications.eval_js"_test = [] {
+    auto make_eval_js_rule = [](int i) {
+      return nlohmann::json::object({
+          {"eval_js", fmt::format(R"(
+function main() {{
+  return {{
+    description: "rule {0}",
+    manipulators: [{{ type: "basic", from: {{ key_code: "a" }}, to: [{{ key_code: "b" }}] }}],
+  }};
+}}
+main();
+)",
+                                  i)},
+      });
+    };
+
+    // Rules are stored in order.
+    {
+      auto rules = nlohmann::json::array();
+      for (int i = 0; i < 32; ++i) {
+        if (i % 4 == 0) {
+          rules.push_back(nlohmann::json::object({
+              {"description", fmt::format("rule {0}", i)},
+              {"manipulators", nlohmann::json::array({
+                                   nlohmann::json::object({
+                                       {"type", "basic"},
+                                       {"from", nlohmann::json::object({{"key_code", "a"}})},
+                                   }),
+                               })},
+          }));
+        } else {
+          rules.push_back(make_eval_js_rule(i));
+        }
+      }
+
+      auto json = nlohmann::json::object({{"rules", rules}});
+      krbn::core_configuration::details::complex_modifications complex_modifications(json,
+                                                                                     krbn::core_configuration::error_handling::strict);
+      expect(complex_modifications.get_rules().size() == 32);
+      for (int i = 0; i < 32; ++i) {
+        const auto& r = complex_modifications.get_rules()[i];
+        expect(fmt::format("rule {0}", i) == r->get_description());
+        expect(1 == r->get_manipulators().size());
+      }
+
+      expect(json == complex_modifications.to_json()) << UT_SHOW_LINE;
+    }
+
+    // The first error in the rules order is reported.
+    {
+      auto rules = nlohmann::json::array();
+      for (int i = 0; i < 16; ++i) {
+        if (i == 5) {
+          rules.push_back(nlohmann::json::object({{"eval_js", "function main() {"}}));
+        } else if (i == 9) {
+          rules.push_back(nlohmann::json::object({{"eval_js", "throw new Error('error 9');"}}));
+        } else {
+          rules.push_back(make_eval_js_rule(i));
+        }
+      }
+
+      // The error message of the serial loading.
+      std::string expected_message;
+      try {
+        krbn::core_configuration::details::complex_modifications_rule rule(rules[5],
+                                                                           std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>(),
+                                                                           krbn::core_configuration::error_handling::strict);
+        expect(false);
+      } catch (pqrs::json::unmarshal_error& ex) {
+        expected_message = ex.what();
+      }
+      expect(expected_message.starts_with("`eval_js` error: javascript error: SyntaxError:")) << expected_message;
+
+      try {
+        krbn::core_configuration::details::complex_modifications complex_modifications(nlohmann::json::object({{"rules", rules}}),
+                                                                                       krbn::core_configuration::error_handling::strict);
+        expect(false);
+      } catch (pqrs::json::unmarshal_error& ex) {
+        expect(expected_message == ex.what()) << ex.what();
+      } catch (...) {
+        expect(false);
+      }
+    }
+  };
+
   "complex_modifications.push_front_rule"_test = [] {
     {
       auto manipulators = nlohmann::json::array({
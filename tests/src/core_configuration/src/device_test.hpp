@@ -325,6 +325,8 @@ void run_device_test() {
           {"mouse_flip_y", true},
           {"mouse_swap_wheels", true},
           {"mouse_swap_xy", true},
+          {"filter_unchanged_hid_values", true},
+          {"filter_unchanged_hid_values_dead_band", 2},
           {"game_pad_swap_sticks", true},
           {"game_pad_xy_stick_deadzone", 0.2},
           {"game_pad_xy_stick_delta_magnitude_detection_threshold", 0.1},
@@ -361,6 +363,8 @@ void run_device_test() {
                               },
                           }},
           {"ignore", true},
+          {"filter_unchanged_hid_values", true},
+          {"filter_unchanged_hid_values_dead_band", 2},
           {"game_pad_swap_sticks", true},
           {"game_pad_xy_stick_deadzone", 0.2},
           {"game_pad_xy_stick_delta_magnitude_detection_threshold", 0.1},
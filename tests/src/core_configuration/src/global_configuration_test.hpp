@@ -26,9 +26,12 @@ void run_global_configuration_test() {
       expect(global_configuration.get_notification_window_colors().get_dark().get_text_color() == "system");
       expect(global_configuration.get_unsafe_ui() == false);
       expect(global_configuration.get_filter_useless_events_from_specific_devices() == true);
+      expect(global_configuration.get_filter_unchanged_hid_values_auto_enable_values_per_second() == 0);
       expect(global_configuration.get_reorder_same_timestamp_input_events_to_prioritize_modifiers() == true);
       expect(global_configuration.get_enable_cgeventtap_fallback() == false);
       expect(global_configuration.get_delay_milliseconds_before_sleep_shortcut() == 500);
+      expect(global_configuration.get_coalesce_pointing_motion() == false);
+      expect(global_configuration.get_shell_command_worker_count() == 0);
     }
 
     // load values from json
@@ -58,9 +61,12 @@ void run_global_configuration_test() {
            }},
           {"unsafe_ui", true},
           {"filter_useless_events_from_specific_devices", false},
+          {"filter_unchanged_hid_values_auto_enable_values_per_second", 2000},
           {"reorder_same_timestamp_input_events_to_prioritize_modifiers", false},
           {"enable_cgeventtap_fallback", true},
           {"delay_milliseconds_before_sleep_shortcut", 250},
+          {"coalesce_pointing_motion", true},
+          {"shell_command_worker_count", 2},
       };
       krbn::core_configuration::details::global_configuration global_configuration(json,
                                                                                    krbn::core_configuration::error_handling::strict);
@@ -80,9 +86,12 @@ void run_global_configuration_test() {
       expect(global_configuration.to_json()["notification_window_colors"]["dark"]["text_color"] == "#abcdefff");
       expect(global_configuration.get_unsafe_ui() == true);
       expect(global_configuration.get_filter_useless_events_from_specific_devices() == false);
+      expect(global_configuration.get_filter_unchanged_hid_values_auto_enable_values_per_second() == 2000);
       expect(global_configuration.get_reorder_same_timestamp_input_events_to_prioritize_modifiers() == false);
       expect(global_configuration.get_enable_cgeventtap_fallback() == true);
       expect(global_configuration.get_delay_milliseconds_before_sleep_shortcut() == 250);
+      expect(global_configuration.get_coalesce_pointing_motion() == true);
+      expect(global_configuration.get_shell_command_worker_count() == 2);
 
       //
       // Set default values
@@ -103,9 +112,12 @@ void run_global_configuration_test() {
       global_configuration.get_notification_window_colors().get_dark().set_text_color("system");
       global_configuration.set_unsafe_ui(false);
       global_configuration.set_filter_useless_events_from_specific_devices(true);
+      global_configuration.set_filter_unchanged_hid_values_auto_enable_values_per_second(0);
       global_configuration.set_reorder_same_timestamp_input_events_to_prioritize_modifiers(true);
       global_configuration.set_enable_cgeventtap_fallback(false);
       global_configuration.set_delay_milliseconds_before_sleep_shortcut(500);
+      global_configuration.set_coalesce_pointing_motion(false);
+      global_configuration.set_shell_command_worker_count(0);
       nlohmann::json j(global_configuration);
       expect(j.empty());
     }
@@ -125,9 +137,12 @@ void run_global_configuration_test() {
           {"notification_window_colors", nlohmann::json::object({{"light", nlohmann::json::object({{"background_color", nlohmann::json::array()}})}})},
           {"unsafe_ui", nlohmann::json::object()},
           {"filter_useless_events_from_specific_devices", nlohmann::json::object()},
+          {"filter_unchanged_hid_values_auto_enable_values_per_second", nlohmann::json::object()},
           {"reorder_same_timestamp_input_events_to_prioritize_modifiers", nlohmann::json::object()},
           {"enable_cgeventtap_fallback", nlohmann::json::object()},
           {"delay_milliseconds_before_sleep_shortcut", nlohmann::json::object()},
+          {"coalesce_pointing_motion", nlohmann::json::object()},
+          {"shell_command_worker_count", nlohmann::json::object()},
       };
       krbn::core_configuration::details::global_configuration global_configuration(json,
                                                                                    krbn::core_configuration::error_handling::loose);
@@ -143,9 +158,12 @@ void run_global_configuration_test() {
       expect(global_configuration.get_notification_window_colors().get_light().get_background_color() == "system");
       expect(global_configuration.get_unsafe_ui() == false);
       expect(global_configuration.get_filter_useless_events_from_specific_devices() == true);
+      expect(global_configuration.get_filter_unchanged_hid_values_auto_enable_values_per_second() == 0);
       expect(global_configuration.get_reorder_same_timestamp_input_events_to_prioritize_modifiers() == true);
       expect(global_configuration.get_enable_cgeventtap_fallback() == false);
       expect(global_configuration.get_delay_milliseconds_before_sleep_shortcut() == 500);
+      expect(global_configuration.get_coalesce_pointing_motion() == false);
+      expect(global_configuration.get_shell_command_worker_count() == 0);
     }
 
     // invalid notification_window_position in json
@@ -180,6 +198,17 @@ void run_global_configuration_test() {
       expect(global_configuration.get_delay_milliseconds_before_sleep_shortcut() == 10000);
     }
 
+    // clamp shell_command_worker_count
+    {
+      krbn::core_configuration::details::global_configuration global_configuration(
+          nlohmann::json({{"shell_command_worker_count", -1}}),
+          krbn::core_configuration::error_handling::strict);
+      expect(global_configuration.get_shell_command_worker_count() == 0);
+
+      global_configuration.set_shell_command_worker_count(9);
+      expect(global_configuration.get_shell_command_worker_count() == 8);
+    }
+
     // invalid notification window colors in json
     {
       nlohmann::json json{
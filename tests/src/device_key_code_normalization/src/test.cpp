@@ -5,7 +5,7 @@
 #include <boost/ut.hpp>
 
 namespace {
-krbn::event_queue::not_null_entries_ptr_t make_entries(
+std::vector<krbn::event_queue::entry> make_entries(
     pqrs::not_null_shared_ptr_t<krbn::device_properties> device_properties,
     pqrs::hid::usage::value_t usage,
     int value,
@@ -23,13 +23,13 @@ krbn::event_queue::not_null_entries_ptr_t make_entries(
                                                   {});
 }
 
-void manipulate(const krbn::event_queue::not_null_entries_ptr_t& entries,
+void manipulate(const std::vector<krbn::event_queue::entry>& entries,
                 const std::shared_ptr<krbn::event_queue::queue>& input_queue,
                 krbn::manipulator::manipulator_managers_connector& connector,
                 const std::shared_ptr<const krbn::core_configuration::core_configuration>& core_configuration) {
-  for (const auto& entry : *entries) {
-    input_queue->push_back_entry(*entry);
-    connector.manipulate(entry->get_event_time_stamp().get_time_stamp(),
+  for (const auto& entry : entries) {
+    input_queue->push_back_entry(entry);
+    connector.manipulate(entry.get_event_time_stamp().get_time_stamp(),
                          core_configuration);
   }
 }
@@ -0,0 +1,116 @@
+#include "core_configuration/core_configuration.hpp"
+#include "eval_js_cache.hpp"
+#include <boost/ut.hpp>
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+  using namespace std::literals;
+
+  "eval_js_cache"_test = [] {
+    krbn::eval_js_cache cache("tmp/eval_js_cache", "1.0.0");
+
+    expect(!cache.find("code1"));
+    expect(0 == cache.get_hit_count());
+    expect(1 == cache.get_miss_count());
+
+    cache.save("code1", nlohmann::json::object({{"description", "rule1"}}));
+    cache.save("code2", nlohmann::json::object({{"description", "rule2"}}));
+
+    {
+      auto json = cache.find("code1");
+      expect(json != std::nullopt);
+      expect(nlohmann::json::object({{"description", "rule1"}}) == *json);
+    }
+    {
+      auto json = cache.find("code2");
+      expect(json != std::nullopt);
+      expect(nlohmann::json::object({{"description", "rule2"}}) == *json);
+    }
+    expect(2 == cache.get_hit_count());
+    expect(1 == cache.get_miss_count());
+
+    // Other versions do not use the cache files.
+    {
+      krbn::eval_js_cache other_cache("tmp/eval_js_cache", "2.0.0");
+      expect(!other_cache.find("code1"));
+      expect(1 == other_cache.get_miss_count());
+    }
+
+    // clear
+    expect(2 == cache.clear());
+    expect(!cache.find("code1"));
+    expect(!cache.find("code2"));
+  };
+
+  "eval_js_cache prune"_test = [] {
+    krbn::eval_js_cache cache("tmp/eval_js_cache_prune", "1.0.0", 4);
+
+    for (int i = 0; i < 10; ++i) {
+      cache.save(fmt::format("code{0}", i), nlohmann::json(i));
+    }
+
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("tmp/eval_js_cache_prune")) {
+      if (entry.path().extension() == ".json") {
+        ++count;
+      }
+    }
+    expect(count <= 4) << count;
+
+    // The last saved entry remains.
+    expect(cache.find("code9") != std::nullopt);
+  };
+
+  "complex_modifications_rule with shared eval_js_cache"_test = [] {
+    krbn::initialize_shared_eval_js_cache("tmp/eval_js_cache_rule", "1.0.0");
+
+    auto json = nlohmann::json::object({
+        {"eval_js", R"(
+function main() {
+  return {
+    description: "example",
+    enabled: false,
+    manipulators: [{ type: "basic", from: { key_code: "a" }, to: [{ key_code: "b" }] }],
+  };
+}
+main();
+)"},
+    });
+
+    auto parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>();
+    auto cache = krbn::get_shared_eval_js_cache();
+
+    for (int i = 0; i < 2; ++i) {
+      krbn::core_configuration::details::complex_modifications_rule rule(json,
+                                                                         parameters,
+                                                                         krbn::core_configuration::error_handling::strict);
+      expect("example"s == rule.get_description());
+      expect(1 == rule.get_manipulators().size());
+      // `enabled` in the evaluated json is ignored.
+      expect(true == rule.get_enabled());
+    }
+
+    expect(1 == cache->get_hit_count());
+    expect(1 == cache->get_miss_count());
+
+    // Errors are not cached.
+    for (int i = 0; i < 2; ++i) {
+      try {
+        krbn::core_configuration::details::complex_modifications_rule rule(nlohmann::json::object({{"eval_js", "function main() {"}}),
+                                                                           parameters,
+                                                                           krbn::core_configuration::error_handling::strict);
+        expect(false);
+      } catch (pqrs::json::unmarshal_error& ex) {
+        expect(std::string_view(ex.what()).starts_with("`eval_js` error: javascript error: SyntaxError:")) << ex.what();
+      }
+    }
+
+    expect(1 == cache->get_hit_count());
+    expect(3 == cache->get_miss_count());
+
+    krbn::terminate_shared_eval_js_cache();
+  };
+
+  return 0;
+}
@@ -194,6 +194,40 @@ void run_event_queue_test() {
       auto event_from_json = krbn::event_queue::event::make_from_json(json);
       expect(json == event_from_json.to_json());
     }
+    {
+      nlohmann::json expected;
+      expected["type"] = "set_variables";
+      expected["set_variables"] = nlohmann::json::array({
+          nlohmann::json::object({
+              {"name", "example1"},
+              {"value", 100},
+              {"type", "set"},
+          }),
+          nlohmann::json::object({
+              {"name", "example2"},
+              {"type", "unset"},
+          }),
+      });
+      auto json = krbn::event_queue::event::make_set_variables_event({
+                                                                         krbn::manipulator_environment_variable_set_variable(
+                                                                             "example1",
+                                                                             krbn::manipulator_environment_variable_value(100),
+                                                                             nullptr,
+                                                                             std::nullopt,
+                                                                             nullptr),
+                                                                         krbn::manipulator_environment_variable_set_variable(
+                                                                             "example2",
+                                                                             std::nullopt,
+                                                                             nullptr,
+                                                                             std::nullopt,
+                                                                             nullptr,
+                                                                             krbn::manipulator_environment_variable_set_variable::type::unset),
+                                                                     })
+                      .to_json();
+      expect(json == expected) << json.dump();
+      auto event_from_json = krbn::event_queue::event::make_from_json(json);
+      expect(json == event_from_json.to_json());
+    }
     {
       nlohmann::json expected;
       expected["type"] = "frontmost_application_changed";
@@ -321,7 +355,7 @@ void run_event_queue_test() {
                      pqrs::hid::usage_page::button,
                      pqrs::hid::usage::button::button_2)) == false);
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, a_event, key_down, a_event);
       PUSH_BACK_ENTRY(expected, 1, 200, left_shift_event, key_down, left_shift_event);
       PUSH_BACK_ENTRY(expected, 1, 300, button2_event, key_down, button2_event);
@@ -361,7 +395,7 @@ void run_event_queue_test() {
 
       event_queue.sort_events();
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, left_control_event, key_down, left_control_event);
       PUSH_BACK_ENTRY(expected, 1, 100, left_shift_event, key_down, left_shift_event);
       PUSH_BACK_ENTRY(expected, 1, 100, a_event, key_down, a_event);
@@ -385,7 +419,7 @@ void run_event_queue_test() {
 
       event_queue.sort_events();
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, left_shift_event, key_down, left_shift_event);
       PUSH_BACK_ENTRY(expected, 1, 100, left_control_event, key_down, left_control_event);
       PUSH_BACK_ENTRY(expected, 1, 100, a_event, key_down, a_event);
@@ -402,7 +436,7 @@ void run_event_queue_test() {
 
       event_queue.sort_events();
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, left_control_event, key_down, left_control_event);
       PUSH_BACK_ENTRY(expected, 1, 100, left_shift_event, key_down, left_shift_event);
       PUSH_BACK_ENTRY(expected, 1, 100, b_event, key_down, b_event);
@@ -419,7 +453,7 @@ void run_event_queue_test() {
 
       event_queue.sort_events();
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, left_control_event, key_down, left_control_event);
       PUSH_BACK_ENTRY(expected, 1, 100, left_shift_event, key_down, left_shift_event);
       PUSH_BACK_ENTRY(expected, 1, 100, b_event, key_up, b_event);
@@ -437,7 +471,7 @@ void run_event_queue_test() {
 
       event_queue.sort_events();
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, b_event, key_up, b_event);
       PUSH_BACK_ENTRY(expected, 1, 100, a_event, key_up, a_event);
       PUSH_BACK_ENTRY(expected, 1, 100, device_keys_and_pointing_buttons_are_released_event, single, device_keys_and_pointing_buttons_are_released_event);
@@ -520,7 +554,7 @@ void run_event_queue_test() {
 
       ENQUEUE_EVENT(event_queue, 1, 400, tab_event, key_up, tab_event);
 
-      std::vector<krbn::event_queue::entry> expected;
+      std::deque<krbn::event_queue::entry> expected;
       PUSH_BACK_ENTRY(expected, 1, 100, tab_event, key_down, tab_event);
       PUSH_BACK_ENTRY(expected, 1, 210, tab_event, key_up, tab_event);
       PUSH_BACK_ENTRY(expected, 1, 310, tab_event, key_down, tab_event);
@@ -534,6 +568,39 @@ void run_event_queue_test() {
     }
   };
 
+  "erase_front_event"_test = [] {
+    {
+      krbn::event_queue::queue event_queue;
+
+      // Interleave push and erase to reuse storage.
+
+      for (int i = 0; i < 1000; ++i) {
+        ENQUEUE_EVENT(event_queue, 1, i * 2, a_event, key_down, a_event);
+        ENQUEUE_EVENT(event_queue, 1, i * 2 + 1, a_event, key_up, a_event);
+
+        expect(event_queue.get_front_event().get_event_time_stamp().get_time_stamp() == krbn::absolute_time_point(i));
+        event_queue.erase_front_event();
+      }
+
+      expect(event_queue.get_entries().size() == 1000);
+
+      std::deque<krbn::event_queue::entry> expected;
+      for (int i = 1000; i < 2000; ++i) {
+        if (i % 2 == 0) {
+          PUSH_BACK_ENTRY(expected, 1, i, a_event, key_down, a_event);
+        } else {
+          PUSH_BACK_ENTRY(expected, 1, i, a_event, key_up, a_event);
+        }
+      }
+      expect(event_queue.get_entries() == expected);
+
+      while (!event_queue.empty()) {
+        event_queue.erase_front_event();
+      }
+      expect(event_queue.get_entries().empty());
+    }
+  };
+
   "caps_lock_state_changed"_test = [] {
     {
       krbn::event_queue::queue event_queue;
@@ -563,9 +630,62 @@ void run_event_queue_test() {
     }
   };
 
+  "set_variables"_test = [] {
+    using set_variable = krbn::manipulator_environment_variable_set_variable;
+
+    krbn::event_queue::queue event_queue;
+    auto& environment = event_queue.get_manipulator_environment();
+
+    environment.set_variable("example3", krbn::manipulator_environment_variable_value(3));
+
+    auto e = krbn::event_queue::event::make_set_variables_event({
+        set_variable("example1", krbn::manipulator_environment_variable_value(1), nullptr, std::nullopt, nullptr),
+        set_variable("example2", krbn::manipulator_environment_variable_value(std::string("two")), nullptr, std::nullopt, nullptr),
+        set_variable("example3", std::nullopt, nullptr, std::nullopt, nullptr, set_variable::type::unset),
+    });
+
+    auto variables_version = environment.get_variables_version();
+
+    ENQUEUE_EVENT(event_queue, 0, 100, e, single, e);
+
+    // All variables are applied by a single entry.
+    expect(1 == event_queue.get_entries().size());
+    expect(environment.get_variable("example1") == krbn::manipulator_environment_variable_value(1));
+    expect(environment.get_variable("example2") == krbn::manipulator_environment_variable_value(std::string("two")));
+    expect(environment.get_variable("example3") == krbn::manipulator_environment_variable_value());
+    expect(variables_version + 3 == environment.get_variables_version());
+  };
+
   "hash"_test = [] {
     using event = krbn::event_queue::event;
     expect(std::hash<event>{}(a_event) !=
            std::hash<event>{}(b_event));
+
+    auto e1 = event::make_shell_command_event("open https://pqrs.org");
+    auto e2 = event::make_shell_command_event("open https://pqrs.org");
+    expect(std::hash<event>{}(e1) ==
+           std::hash<event>{}(e2));
+  };
+
+  "shared_payload"_test = [] {
+    using event = krbn::event_queue::event;
+
+    auto e1 = event::make_shell_command_event("open https://pqrs.org");
+    auto e2 = e1;
+    auto e3 = event::make_shell_command_event("open https://pqrs.org");
+    auto e4 = event::make_shell_command_event("open /Applications");
+
+    // Copies share the payload.
+    expect(e1.get_if<std::string>() == e2.get_if<std::string>());
+
+    // Payloads are compared by value.
+    expect(e1 == e2);
+    expect(e1 == e3);
+    expect(e1 != e4);
+
+    expect(*(e1.get_if<std::string>()) == "open https://pqrs.org");
+    expect(e1.get_shell_command() == "open https://pqrs.org");
+    expect(e1.get_if<krbn::momentary_switch_event>() == nullptr);
+    expect(a_event.get_if<std::string>() == nullptr);
   };
 }
@@ -0,0 +1,88 @@
+#include "allocation_counter.hpp"
+#include "event_queue.hpp"
+#include <boost/ut.hpp>
+
+namespace {
+std::vector<pqrs::osx::iokit_hid_value> make_hid_values(pqrs::hid::usage::value_t usage,
+                                                        CFIndex integer_value,
+                                                        uint64_t time_stamp) {
+  return {
+      pqrs::osx::iokit_hid_value(krbn::absolute_time_point(time_stamp),
+                                 integer_value,
+                                 pqrs::hid::usage_page::keyboard_or_keypad,
+                                 usage,
+                                 std::nullopt, // logical_max
+                                 std::nullopt  // logical_min
+                                 ),
+  };
+}
+
+// Replicate the path from device_grabber_details::entry to merged_input_event_queue in device_grabber.
+void handle_hid_values(pqrs::not_null_shared_ptr_t<krbn::device_properties> device_properties,
+                       pqrs::not_null_shared_ptr_t<krbn::pressed_keys_manager> pressed_keys_manager,
+                       const std::vector<pqrs::osx::iokit_hid_value>& hid_values,
+                       std::vector<krbn::event_queue::entry>& entries,
+                       krbn::event_queue::queue& queue) {
+  entries.clear();
+  krbn::event_queue::utility::make_entries(device_properties,
+                                           hid_values,
+                                           {},
+                                           entries);
+  krbn::event_queue::utility::insert_device_keys_and_pointing_buttons_are_released_event(entries,
+                                                                                         device_properties->get_device_id(),
+                                                                                         pressed_keys_manager);
+  for (auto&& e : entries) {
+    queue.push_back_entry(std::move(e));
+  }
+}
+} // namespace
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  "hid values to event_queue"_test = [] {
+    auto device_properties = krbn::device_properties::make_device_properties(krbn::device_id(1),
+                                                                             nullptr);
+    auto pressed_keys_manager = std::make_shared<krbn::pressed_keys_manager>();
+    std::vector<krbn::event_queue::entry> entries;
+    krbn::event_queue::queue queue;
+
+    std::vector<std::vector<pqrs::osx::iokit_hid_value>> reports;
+    for (int i = 0; i < 100; ++i) {
+      auto t = static_cast<uint64_t>(i) * 1000;
+      reports.push_back(make_hid_values(pqrs::hid::usage::keyboard_or_keypad::keyboard_a, 1, t));
+      reports.push_back(make_hid_values(pqrs::hid::usage::keyboard_or_keypad::keyboard_a, 0, t + 100));
+    }
+
+    auto run = [&] {
+      size_t count = 0;
+      for (const auto& r : reports) {
+        handle_hid_values(device_properties,
+                          pressed_keys_manager,
+                          r,
+                          entries,
+                          queue);
+
+        while (!queue.empty()) {
+          queue.erase_front_event();
+          ++count;
+        }
+      }
+      return count;
+    };
+
+    // Warm up buffers.
+    run();
+
+    auto begin = krbn::allocation_counter::get_count();
+    auto count = run();
+    auto allocations = krbn::allocation_counter::get_count() - begin;
+
+    // key_down, key_up and device_keys_and_pointing_buttons_are_released for each keystroke.
+    expect(count == 300);
+    expect(allocations == 0) << "allocations: " << allocations;
+  };
+
+  return 0;
+}
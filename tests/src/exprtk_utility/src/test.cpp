@@ -78,6 +78,20 @@ sin(radian) * m;
     expect(12.0_d == expression->value());
   };
 
+  "evaluate"_test = [] {
+    auto expression = krbn::exprtk_utility::compile("example_variable1 + example_variable2");
+    expect(3.0_d == expression->evaluate({
+                        {"example_variable1", 1.0},
+                        {"example_variable2", 2.0},
+                    }));
+
+    // Unspecified variables keep their values.
+    expect(12.0_d == expression->evaluate({
+                         {"example_variable1", 10.0},
+                     }));
+    expect(12.0_d == expression->value());
+  };
+
   "set_variable (string)"_test = [] {
     auto expression = krbn::exprtk_utility::compile("example_string like 'hello*'");
     expect(0.0_d == expression->value());
@@ -135,6 +149,45 @@ sin(radian) * m;
     expect(0.0_d == expression->value());
   };
 
+  "set_variable (slot_id)"_test = [] {
+    auto registry = krbn::get_shared_variable_slot_registry();
+
+    auto expression = krbn::exprtk_utility::compile("example_variable * 2 + (example_string like 'hello*')");
+
+    auto variable_slot_id = registry->intern("example_variable");
+    auto string_slot_id = registry->intern("example_string");
+    auto unrelated_slot_id = registry->intern("unrelated_variable");
+
+    expect(variable_slot_id == registry->intern("example_variable"));
+    expect("example_variable"sv == registry->get_name(variable_slot_id));
+    expect(std::nullopt == registry->find("unknown_variable"));
+
+    auto slot_ids = expression->get_variable_slot_ids();
+    std::ranges::sort(slot_ids);
+    auto expected_slot_ids = std::vector<krbn::variable_slot_id>{variable_slot_id, string_slot_id};
+    std::ranges::sort(expected_slot_ids);
+    expect(expected_slot_ids == slot_ids);
+
+    expect(true == expression->set_variable(variable_slot_id, 21.0));
+    expect(true == expression->set_variable(string_slot_id, std::string("hello world")));
+    expect(43.0_d == expression->value());
+
+    // Type mismatch
+    expect(false == expression->set_variable(variable_slot_id, std::string("hello")));
+    expect(false == expression->set_variable(string_slot_id, 1.0));
+
+    // Unreferenced variable
+    expect(false == expression->set_variable(unrelated_slot_id, 1.0));
+    expect(false == expression->unset_variable(unrelated_slot_id));
+    expect(43.0_d == expression->value());
+
+    expect(true == expression->unset_variable(variable_slot_id));
+    expect(1.0_d == expression->value());
+
+    expect(true == expression->unset_variable(string_slot_id));
+    expect(0.0_d == expression->value());
+  };
+
   "value<int64_t>"_test = [] {
     auto expression = krbn::exprtk_utility::compile("42");
     expect(42_i64 == expression->value<int64_t>());
@@ -162,5 +215,69 @@ sin(radian) * m;
     expect(false == krbn::exprtk_utility::compare(e1_1, e2_2));
   };
 
+  "expression_cache"_test = [] {
+    krbn::exprtk_utility::expression_cache cache;
+
+    auto e1_1 = cache.compile("x + 1");
+    auto e1_2 = cache.compile("x + 1");
+    auto e2 = cache.compile("x + 2");
+
+    expect(e1_1 == e1_2);
+    expect(e1_1 != e2);
+    expect(2 == cache.size());
+
+    // Shared compile
+    expect(krbn::exprtk_utility::compile("shared_expression * 2") == krbn::exprtk_utility::compile("shared_expression * 2"));
+  };
+
+  "expression_cache prune"_test = [] {
+    krbn::exprtk_utility::expression_cache cache;
+
+    auto kept = cache.compile("kept_variable");
+
+    for (int i = 0; i < 1000; ++i) {
+      cache.compile(fmt::format("{0} + 1", i));
+    }
+
+    // Released expressions are removed.
+    expect(cache.size() < 300);
+    expect(kept == cache.compile("kept_variable"));
+  };
+
+  "set_variable resets applied_variables_version"_test = [] {
+    auto expression = krbn::exprtk_utility::compile("applied_version_test_variable + 1");
+
+    expression->set_applied_variables_version(krbn::exprtk_utility::applied_variables_version{
+        .store_id = 1,
+        .version = 1,
+    });
+    expect(expression->get_applied_variables_version() != std::nullopt);
+
+    expect(true == expression->set_variable("applied_version_test_variable", 1.0));
+    expect(expression->get_applied_variables_version() == std::nullopt);
+
+    // The setters with variable_slot_id also reset the version.
+
+    auto slot_id = krbn::get_shared_variable_slot_registry()->intern("applied_version_test_variable");
+    krbn::exprtk_utility::applied_variables_version version{
+        .store_id = 1,
+        .version = 2,
+    };
+
+    expression->set_applied_variables_version(version);
+    expect(true == expression->set_variable(slot_id, 2.0));
+    expect(expression->get_applied_variables_version() == std::nullopt);
+
+    expression->set_applied_variables_version(version);
+    expect(true == expression->unset_variable(slot_id));
+    expect(expression->get_applied_variables_version() == std::nullopt);
+
+    // Variables which are not referenced do not change the version.
+
+    expression->set_applied_variables_version(version);
+    expect(false == expression->set_variable(krbn::get_shared_variable_slot_registry()->intern("applied_version_unrelated_variable"), 1.0));
+    expect(expression->get_applied_variables_version() != std::nullopt);
+  };
+
   return 0;
 }
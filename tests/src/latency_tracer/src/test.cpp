@@ -0,0 +1,94 @@
+#include "latency_tracer.hpp"
+#include <boost/ut.hpp>
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+  using namespace std::literals;
+
+  "latency_histogram"_test = [] {
+    {
+      krbn::latency_histogram h;
+      expect(0 == h.get_count());
+      expect(0us == h.get_percentile(50));
+      expect(0us == h.get_percentile(99));
+      expect(0us == h.get_max());
+    }
+
+    // Small values are recorded exactly.
+    {
+      krbn::latency_histogram h;
+      for (int i = 0; i < 10; ++i) {
+        h.record(std::chrono::microseconds(i));
+      }
+      expect(10 == h.get_count());
+      expect(5us == h.get_percentile(50));
+      expect(9us == h.get_percentile(99));
+      expect(9us == h.get_max());
+    }
+
+    // Large values are recorded within 1/16 error.
+    {
+      krbn::latency_histogram h;
+      for (int i = 1; i <= 1000; ++i) {
+        h.record(std::chrono::microseconds(i));
+      }
+      expect(1000 == h.get_count());
+      expect(h.get_percentile(50) <= 500us);
+      expect(h.get_percentile(50) >= 500us - 500us / 16);
+      expect(h.get_percentile(99) <= 990us);
+      expect(h.get_percentile(99) >= 990us - 990us / 16);
+      expect(1000us == h.get_max());
+
+      expect(nlohmann::json::object({
+                 {"count", 1000},
+                 {"p50_us", h.get_percentile(50).count()},
+                 {"p99_us", h.get_percentile(99).count()},
+                 {"max_us", 1000},
+             }) == h.to_json());
+    }
+
+    // Negative values are treated as zero.
+    {
+      krbn::latency_histogram h;
+      h.record(std::chrono::microseconds(-10));
+      expect(1 == h.get_count());
+      expect(0us == h.get_max());
+    }
+  };
+
+  "latency_tracer"_test = [] {
+    krbn::latency_tracer tracer(std::vector<std::string>{"stage_a", "stage_b"});
+
+    auto ms = [](int value) {
+      return pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(value));
+    };
+
+    tracer.record_stage(0, ms(2), ms(1));
+    tracer.record_stage(1, ms(3), ms(1));
+    tracer.record_stage(3, ms(4), ms(1));
+    tracer.record_posted(ms(1));
+    tracer.record_coalesced_pointing_inputs(3);
+    tracer.record_coalesced_pointing_inputs(0);
+
+    auto& stages = tracer.get_stages();
+    expect(4 == stages.size());
+    expect("stage_a"s == stages[0].get_name());
+    expect("stage_b"s == stages[1].get_name());
+    expect("stage2"s == stages[2].get_name());
+    expect("stage3"s == stages[3].get_name());
+
+    expect(1 == stages[0].get_since_input().get_count());
+    expect(0 == stages[2].get_since_input().get_count());
+    expect(1 == tracer.get_posted().get_count());
+    expect(3 == tracer.get_coalesced_pointing_inputs());
+
+    auto json = tracer.to_json();
+    expect(4 == json.at("stages").size());
+    expect("stage_b"s == json.at("stages").at(1).at("name").get<std::string>());
+    expect(1 == json.at("posted").at("count").get<int>());
+    expect(3 == json.at("coalesced_pointing_inputs").get<int>());
+  };
+
+  return 0;
+}
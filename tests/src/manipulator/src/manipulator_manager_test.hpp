@@ -123,4 +123,229 @@ void run_manipulator_manager_test() {
       manager = nullptr;
     }
   };
+
+  "dispatch_index"_test = [] {
+    auto make_key_code_event = [](pqrs::hid::usage::value_t usage) {
+      return krbn::event_queue::event(krbn::momentary_switch_event(pqrs::hid::usage_page::keyboard_or_keypad,
+                                                                   usage));
+    };
+
+    auto push_back_entry = [&](krbn::event_queue::queue& queue,
+                               pqrs::hid::usage::value_t usage,
+                               krbn::event_type event_type,
+                               krbn::absolute_time_point time_stamp) {
+      auto event = make_key_code_event(usage);
+      queue.emplace_back_entry(krbn::device_id(1),
+                               krbn::event_queue::event_time_stamp(time_stamp),
+                               event,
+                               event_type,
+                               krbn::event_integer_value::value_t(event_type == krbn::event_type::key_down ? 1 : 0),
+                               event,
+                               krbn::event_queue::state::original);
+    };
+
+    auto make_output = [](const krbn::event_queue::queue& queue) {
+      std::vector<std::pair<krbn::event_queue::event, krbn::event_type>> result;
+      for (const auto& e : queue.get_entries()) {
+        result.emplace_back(e.get_event(), e.get_event_type());
+      }
+      return result;
+    };
+
+    auto parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>();
+    auto core_configuration = std::make_shared<krbn::core_configuration::core_configuration>();
+
+    //
+    // Rule ordering is kept between `key_code` and `any`.
+    //
+
+    {
+      auto input_event_queue = std::make_shared<krbn::event_queue::queue>();
+      auto output_event_queue = std::make_shared<krbn::event_queue::queue>();
+      auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+
+      for (const auto& json : {
+               nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "b"}, "to": [{"key_code": "2"}]})"),
+               nlohmann::json::parse(R"({"type": "basic", "from": {"any": "key_code"}, "to": [{"key_code": "1"}]})"),
+               nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "a"}, "to": [{"key_code": "3"}]})"),
+           }) {
+        manager->push_back_manipulator(json, parameters);
+      }
+
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_a, krbn::event_type::key_down, krbn::absolute_time_point(1000));
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_b, krbn::event_type::key_down, krbn::absolute_time_point(2000));
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_a, krbn::event_type::key_up, krbn::absolute_time_point(3000));
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_b, krbn::event_type::key_up, krbn::absolute_time_point(4000));
+
+      while (manager->manipulate(input_event_queue,
+                                 output_event_queue,
+                                 krbn::absolute_time_point(5000),
+                                 core_configuration)) {
+      }
+
+      std::vector<std::pair<krbn::event_queue::event, krbn::event_type>> expected{
+          {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_1), krbn::event_type::key_down},
+          {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_2), krbn::event_type::key_down},
+          {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_1), krbn::event_type::key_up},
+          {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_2), krbn::event_type::key_up},
+      };
+      expect(expected == make_output(*output_event_queue));
+
+      manager->invalidate_manipulators();
+    }
+
+    //
+    // Manipulators with pending to_delayed_action receive unrelated events.
+    //
+
+    {
+      auto input_event_queue = std::make_shared<krbn::event_queue::queue>();
+      auto output_event_queue = std::make_shared<krbn::event_queue::queue>();
+      auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+
+      manager->push_back_manipulator(nlohmann::json::parse(R"(
+{
+  "type": "basic",
+  "from": {"key_code": "c"},
+  "to": [{"key_code": "c"}],
+  "to_delayed_action": {
+    "to_if_invoked": [{"key_code": "y"}],
+    "to_if_canceled": [{"key_code": "x"}]
+  }
+})"),
+                                     parameters);
+
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_c, krbn::event_type::key_down, krbn::absolute_time_point(1000));
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_c, krbn::event_type::key_up, krbn::absolute_time_point(2000));
+      push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_e, krbn::event_type::key_down, krbn::absolute_time_point(3000));
+
+      while (manager->manipulate(input_event_queue,
+                                 output_event_queue,
+                                 krbn::absolute_time_point(4000),
+                                 core_configuration)) {
+      }
+
+      auto output = make_output(*output_event_queue);
+      auto x_key_down = std::make_pair(make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_x),
+                                       krbn::event_type::key_down);
+      expect(std::ranges::find(output, x_key_down) != std::end(output));
+
+      manager->invalidate_manipulators();
+    }
+  };
+
+  "update_manipulators"_test = [] {
+    auto make_key_code_event = [](pqrs::hid::usage::value_t usage) {
+      return krbn::event_queue::event(krbn::momentary_switch_event(pqrs::hid::usage_page::keyboard_or_keypad,
+                                                                   usage));
+    };
+
+    auto push_back_entry = [&](krbn::event_queue::queue& queue,
+                               pqrs::hid::usage::value_t usage,
+                               krbn::event_type event_type,
+                               krbn::absolute_time_point time_stamp) {
+      auto event = make_key_code_event(usage);
+      queue.emplace_back_entry(krbn::device_id(1),
+                               krbn::event_queue::event_time_stamp(time_stamp),
+                               event,
+                               event_type,
+                               krbn::event_integer_value::value_t(event_type == krbn::event_type::key_down ? 1 : 0),
+                               event,
+                               krbn::event_queue::state::original);
+    };
+
+    auto parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>();
+    auto core_configuration = std::make_shared<krbn::core_configuration::core_configuration>();
+
+    auto input_event_queue = std::make_shared<krbn::event_queue::queue>();
+    auto output_event_queue = std::make_shared<krbn::event_queue::queue>();
+    auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+
+    std::vector<nlohmann::json> jsons;
+    std::vector<std::shared_ptr<krbn::manipulator::manipulators::base>> made_manipulators;
+
+    auto update = [&] {
+      std::vector<krbn::manipulator::manipulator_manager::manipulator_content> contents;
+      for (const auto& j : jsons) {
+        contents.emplace_back(j, parameters->to_json());
+      }
+
+      made_manipulators.clear();
+      return manager->update_manipulators(std::move(contents),
+                                          [&](size_t index) -> std::shared_ptr<krbn::manipulator::manipulators::base> {
+                                            auto m = krbn::manipulator::manipulator_factory::make_manipulator(jsons[index],
+                                                                                                              parameters);
+                                            made_manipulators.push_back(m);
+                                            return m;
+                                          });
+    };
+
+    jsons.push_back(nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "a"}, "to": [{"key_code": "1"}]})"));
+    jsons.push_back(nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "b"}, "to": [{"key_code": "2"}]})"));
+    jsons.push_back(nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "c"}, "to": [{"key_code": "3"}]})"));
+
+    expect(update() == 0);
+    expect(made_manipulators.size() == 3);
+    expect(manager->get_manipulators_size() == 3);
+
+    // Press `a` before reloading.
+
+    push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_a, krbn::event_type::key_down, krbn::absolute_time_point(1000));
+    while (manager->manipulate(input_event_queue,
+                               output_event_queue,
+                               krbn::absolute_time_point(1000),
+                               core_configuration)) {
+    }
+
+    // Change `c` and add `d`.
+
+    jsons[2] = nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "c"}, "to": [{"key_code": "4"}]})");
+    jsons.push_back(nlohmann::json::parse(R"({"type": "basic", "from": {"key_code": "d"}, "to": [{"key_code": "5"}]})"));
+
+    expect(update() == 2);
+    expect(made_manipulators.size() == 2);
+    expect(manager->get_manipulators_size() == 4);
+
+    // The reused manipulator handles key_up of `a`.
+
+    push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_a, krbn::event_type::key_up, krbn::absolute_time_point(2000));
+    push_back_entry(*input_event_queue, pqrs::hid::usage::keyboard_or_keypad::keyboard_c, krbn::event_type::key_down, krbn::absolute_time_point(3000));
+    while (manager->manipulate(input_event_queue,
+                               output_event_queue,
+                               krbn::absolute_time_point(3000),
+                               core_configuration)) {
+    }
+
+    std::vector<std::pair<krbn::event_queue::event, krbn::event_type>> expected{
+        {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_1), krbn::event_type::key_down},
+        {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_1), krbn::event_type::key_up},
+        {make_key_code_event(pqrs::hid::usage::keyboard_or_keypad::keyboard_4), krbn::event_type::key_down},
+    };
+    std::vector<std::pair<krbn::event_queue::event, krbn::event_type>> actual;
+    for (const auto& e : output_event_queue->get_entries()) {
+      actual.emplace_back(e.get_event(), e.get_event_type());
+    }
+    expect(expected == actual);
+
+    // Manipulators are rebuilt when the parameters are changed.
+
+    parameters = std::make_shared<krbn::core_configuration::details::complex_modifications_parameters>(
+        nlohmann::json::object({{"basic.to_if_alone_timeout_milliseconds", 500}}),
+        krbn::core_configuration::error_handling::strict);
+
+    expect(update() == 0);
+    expect(made_manipulators.size() == 4);
+
+    // Remove all.
+
+    jsons.clear();
+
+    expect(update() == 0);
+    expect(made_manipulators.empty());
+
+    // The manipulator of `c` is kept until `c` is released.
+    expect(manager->get_manipulators_size() == 1);
+
+    manager->invalidate_manipulators();
+  };
 }
@@ -365,6 +365,8 @@ void run_device_test() {
                 .is_keyboard = true,
             }));
         d->set_treat_as_built_in_keyboard(true);
+        // Device condition results are cached until the configuration is reloaded.
+        environment.set_core_configuration(manipulator_conditions_helper.get_core_configuration());
         krbn::manipulator::conditions::condition_context condition_context{
             .device_id = device_id_1000_2000,
             .state = krbn::event_queue::state::original,
@@ -380,6 +382,8 @@ void run_device_test() {
                 .is_keyboard = true,
             }));
         d->set_treat_as_built_in_keyboard(false);
+        // Device condition results are cached until the configuration is reloaded.
+        environment.set_core_configuration(manipulator_conditions_helper.get_core_configuration());
         krbn::manipulator::conditions::condition_context condition_context{
             .device_id = device_id_1000_2000,
             .state = krbn::event_queue::state::original,
@@ -454,5 +458,35 @@ void run_device_test() {
                                       environment) == true);
       }
     }
+
+    // Cached results are invalidated when devices are changed.
+    {
+      nlohmann::json json;
+      json["type"] = "device_exists_if";
+      json["identifiers"] = nlohmann::json::array();
+      json["identifiers"].push_back(nlohmann::json::object());
+      json["identifiers"].back()["vendor_id"] = 1234;
+      krbn::manipulator::conditions::device condition(json);
+
+      krbn::manipulator::conditions::condition_context condition_context{
+          .device_id = device_id_1000_2000,
+          .state = krbn::event_queue::state::original,
+      };
+
+      expect(condition.is_fulfilled(condition_context,
+                                    environment) == false);
+
+      auto d = manipulator_conditions_helper.prepare_device(krbn::device_properties::initialization_parameters{
+          .vendor_id = pqrs::hid::vendor_id::value_t(1234),
+      });
+
+      expect(condition.is_fulfilled(condition_context,
+                                    environment) == true);
+
+      environment.erase_device_properties(d);
+
+      expect(condition.is_fulfilled(condition_context,
+                                    environment) == false);
+    }
   };
 }
@@ -202,6 +202,75 @@ void run_manipulator_conditions_test() {
     }
   };
 
+  "conditions.expression (variables)"_test = [] {
+    krbn::manipulator::conditions::condition_context condition_context{
+        .device_id = krbn::device_id(1),
+        .state = krbn::event_queue::state::original,
+    };
+    krbn::manipulator::manipulator_environment manipulator_environment;
+
+    krbn::manipulator::conditions::expression condition(R"(
+{
+  "type": "expression_if",
+  "expression": "example_variable == 2"
+}
+
+)"_json);
+
+    expect(!condition.is_fulfilled(condition_context,
+                                   manipulator_environment));
+
+    // Set variable
+
+    manipulator_environment.set_variable("example_variable", krbn::manipulator_environment_variable_value(2));
+    expect(condition.is_fulfilled(condition_context,
+                                  manipulator_environment));
+
+    // Unchanged value does not increase version
+
+    auto version = manipulator_environment.get_variables_version();
+    manipulator_environment.set_variable("example_variable", krbn::manipulator_environment_variable_value(2));
+    expect(version == manipulator_environment.get_variables_version());
+
+    // Unset variable
+
+    manipulator_environment.unset_variable("example_variable");
+    expect(!condition.is_fulfilled(condition_context,
+                                   manipulator_environment));
+
+    // Unrelated variables
+
+    manipulator_environment.set_variable("example_variable", krbn::manipulator_environment_variable_value(2));
+    for (int i = 0; i < 100; ++i) {
+      manipulator_environment.set_variable(fmt::format("unrelated_variable{0}", i),
+                                           krbn::manipulator_environment_variable_value(i));
+    }
+    expect(condition.is_fulfilled(condition_context,
+                                  manipulator_environment));
+
+    // Changes which exceed the change log size
+
+    manipulator_environment.set_variable("example_variable", krbn::manipulator_environment_variable_value(3));
+    for (int i = 0; i < 5000; ++i) {
+      manipulator_environment.set_variable("unrelated_variable0",
+                                           krbn::manipulator_environment_variable_value(i + 1000));
+    }
+    expect(!condition.is_fulfilled(condition_context,
+                                   manipulator_environment));
+
+    // Another manipulator_environment
+
+    {
+      krbn::manipulator::manipulator_environment e;
+      e.set_variable("example_variable", krbn::manipulator_environment_variable_value(2));
+      expect(condition.is_fulfilled(condition_context,
+                                    e));
+    }
+
+    expect(!condition.is_fulfilled(condition_context,
+                                   manipulator_environment));
+  };
+
   "conditions.frontmost_application"_test = [] {
     actual_examples_helper helper("frontmost_application.json");
     expect(helper.get_error_messages() == std::vector<std::string>{
@@ -273,6 +342,74 @@ void run_manipulator_conditions_test() {
     }
   };
 
+  "regex_matcher"_test = [] {
+    std::vector<pqrs::regex> regexes{
+        pqrs::regex("^com\\.apple\\.Terminal$"),
+        pqrs::regex("^com\\.microsoft\\."),
+        pqrs::regex("\\.app$"),
+        pqrs::regex("/Terminal\\.app/"),
+        pqrs::regex("^org\\.(gnu|vim)\\.[A-Z]"),
+        pqrs::regex("[0-9]+$"),
+    };
+    krbn::regex_matcher matcher(regexes);
+
+    expect(matcher.literals_size() == 4);
+    expect(matcher.regexes_size() == 1);
+
+    for (const auto& s : std::vector<std::string>{
+             "com.apple.Terminal",
+             "com.apple.Terminal2",
+             "com/apple/Terminal",
+             "xcom.apple.Terminal",
+             "com.microsoft.VSCode",
+             "com_microsoft.VSCode",
+             "/Applications/Safari.app",
+             "/Applications/Safari.apps",
+             "/Applications/Utilities/Terminal.app/Contents/MacOS/Terminal",
+             "org.gnu.Emacs",
+             "org.vim.MacVim",
+             "org.gnu.emacs",
+             "",
+         }) {
+      bool expected = false;
+      for (const auto& r : regexes) {
+        expected = expected || regex_search(s, r.get_regex());
+      }
+      expect(matcher.search(s) == expected) << s;
+    }
+
+    expect(krbn::regex_matcher().empty());
+    expect(!krbn::regex_matcher().search("com.apple.Terminal"));
+  };
+
+  "conditions.frontmost_application.cache"_test = [] {
+    actual_examples_helper helper("frontmost_application.json");
+    krbn::manipulator::conditions::condition_context condition_context{
+        .device_id = krbn::device_id(1),
+        .state = krbn::event_queue::state::original,
+    };
+    krbn::manipulator::manipulator_environment manipulator_environment;
+
+    krbn::application application;
+    application.set_bundle_identifier("com.apple.Terminal");
+    application.set_file_path("/not_found");
+    manipulator_environment.set_frontmost_application(application);
+
+    auto generation = manipulator_environment.get_frontmost_application_generation();
+    expect(helper.get_condition_manager().is_fulfilled(condition_context,
+                                                       manipulator_environment) == true);
+
+    // The generation is not changed if the same application is set.
+    manipulator_environment.set_frontmost_application(application);
+    expect(manipulator_environment.get_frontmost_application_generation() == generation);
+
+    application.set_bundle_identifier("com.apple.Safari");
+    manipulator_environment.set_frontmost_application(application);
+    expect(manipulator_environment.get_frontmost_application_generation() != generation);
+    expect(helper.get_condition_manager().is_fulfilled(condition_context,
+                                                       manipulator_environment) == false);
+  };
+
   "conditions.input_source"_test = [] {
     actual_examples_helper helper("input_source.json");
     expect(helper.get_error_messages() == std::vector<std::string>{
@@ -25,17 +25,17 @@ void run_scoped_modifier_flags_test() {
 
       auto active_modifier_flags = modifier_flag_manager.get_active_modifier_flags();
 
-      expect(std::unordered_set<modifier_flag>({
+      expect(modifier_flag_mask({
                  modifier_flag::caps_lock,
                  modifier_flag::left_command,
              }) == modifier_flag_manager.make_modifier_flags());
 
       {
-        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, std::unordered_set<modifier_flag>{
+        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, modifier_flag_mask{
                                                                                modifier_flag::left_shift,
                                                                            });
 
-        expect(std::unordered_set<modifier_flag>({
+        expect(modifier_flag_mask({
                    modifier_flag::left_shift,
                }) == modifier_flag_manager.make_modifier_flags());
 
@@ -55,11 +55,11 @@ void run_scoped_modifier_flags_test() {
       expect(active_modifier_flags == modifier_flag_manager.get_active_modifier_flags());
 
       {
-        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, std::unordered_set<modifier_flag>{
+        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, modifier_flag_mask{
                                                                                modifier_flag::left_option,
                                                                            });
 
-        expect(std::unordered_set<modifier_flag>({
+        expect(modifier_flag_mask({
                    modifier_flag::left_option,
                }) == modifier_flag_manager.make_modifier_flags());
 
@@ -82,11 +82,11 @@ void run_scoped_modifier_flags_test() {
       expect(active_modifier_flags == modifier_flag_manager.get_active_modifier_flags());
 
       {
-        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, std::unordered_set<modifier_flag>{
+        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, modifier_flag_mask{
                                                                                modifier_flag::left_command,
                                                                            });
 
-        expect(std::unordered_set<modifier_flag>({
+        expect(modifier_flag_mask({
                    modifier_flag::left_command,
                }) == modifier_flag_manager.make_modifier_flags());
 
@@ -113,12 +113,12 @@ void run_scoped_modifier_flags_test() {
 
       auto active_modifier_flags = modifier_flag_manager.get_active_modifier_flags();
 
-      expect(std::unordered_set<modifier_flag>({}) == modifier_flag_manager.make_modifier_flags());
+      expect(modifier_flag_mask() == modifier_flag_manager.make_modifier_flags());
 
       {
-        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, std::unordered_set<modifier_flag>{});
+        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, modifier_flag_mask());
 
-        expect(std::unordered_set<modifier_flag>({}) == modifier_flag_manager.make_modifier_flags());
+        expect(modifier_flag_mask() == modifier_flag_manager.make_modifier_flags());
 
         std::cout << std::endl
                   << scoped_modifier_flags.get_scoped_active_modifier_flags()
@@ -130,9 +130,9 @@ void run_scoped_modifier_flags_test() {
       expect(active_modifier_flags == modifier_flag_manager.get_active_modifier_flags());
 
       {
-        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, std::unordered_set<modifier_flag>{modifier_flag::caps_lock});
+        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, modifier_flag_mask{modifier_flag::caps_lock});
 
-        expect(std::unordered_set<modifier_flag>({
+        expect(modifier_flag_mask({
                    modifier_flag::caps_lock,
                }) == modifier_flag_manager.make_modifier_flags());
 
@@ -157,12 +157,12 @@ void run_scoped_modifier_flags_test() {
 
       auto active_modifier_flags = modifier_flag_manager.get_active_modifier_flags();
 
-      expect(std::unordered_set<modifier_flag>({}) == modifier_flag_manager.make_modifier_flags());
+      expect(modifier_flag_mask() == modifier_flag_manager.make_modifier_flags());
 
       {
-        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, std::unordered_set<modifier_flag>{modifier_flag::caps_lock});
+        scoped_modifier_flags scoped_modifier_flags(modifier_flag_manager, modifier_flag_mask{modifier_flag::caps_lock});
 
-        expect(std::unordered_set<modifier_flag>({
+        expect(modifier_flag_mask({
                    modifier_flag::caps_lock,
                }) == modifier_flag_manager.make_modifier_flags());
 
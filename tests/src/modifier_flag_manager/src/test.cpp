@@ -363,14 +363,14 @@ int main() {
     {
       krbn::modifier_flag_manager modifier_flag_manager;
 
-      expect(std::unordered_set<krbn::modifier_flag>({}) == modifier_flag_manager.make_modifier_flags());
+      expect(krbn::modifier_flag_mask() == modifier_flag_manager.make_modifier_flags());
 
       modifier_flag_manager.push_back_active_modifier_flag(led_lock_caps_lock);
       modifier_flag_manager.push_back_active_modifier_flag(left_shift_1);
       modifier_flag_manager.push_back_active_modifier_flag(right_command_1);
       modifier_flag_manager.push_back_active_modifier_flag(fn_1);
 
-      expect(std::unordered_set<krbn::modifier_flag>({
+      expect(krbn::modifier_flag_mask({
                  krbn::modifier_flag::caps_lock,
                  krbn::modifier_flag::left_shift,
                  krbn::modifier_flag::right_command,
@@ -379,6 +379,51 @@ int main() {
     }
   };
 
+  "modifier_flag_mask"_test = [] {
+    krbn::modifier_flag_mask mask;
+    expect(mask.empty());
+    expect(mask.size() == 0);
+
+    mask.insert(krbn::modifier_flag::left_shift);
+    mask.insert(krbn::modifier_flag::fn);
+    mask.insert(krbn::modifier_flag::fn);
+    expect(!mask.empty());
+    expect(mask.size() == 2);
+    expect(mask.contains(krbn::modifier_flag::left_shift));
+    expect(mask.contains(krbn::modifier_flag::fn));
+    expect(!mask.contains(krbn::modifier_flag::right_shift));
+
+    mask.erase(krbn::modifier_flag::left_shift);
+    expect(mask == krbn::modifier_flag_mask({krbn::modifier_flag::fn}));
+  };
+
+  "modifier_flag_manager::is_pressed counters"_test = [] {
+    krbn::modifier_flag_manager modifier_flag_manager;
+
+    // led_lock is ignored while other types of flags exist.
+    modifier_flag_manager.push_back_active_modifier_flag(led_lock_caps_lock);
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::caps_lock) == true);
+    modifier_flag_manager.push_back_active_modifier_flag(lock_caps_lock);
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::caps_lock) == true);
+    modifier_flag_manager.push_back_active_modifier_flag(decrease_lock_caps_lock);
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::caps_lock) == true);
+    modifier_flag_manager.push_back_active_modifier_flag(decrease_led_lock_caps_lock);
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::caps_lock) == false);
+
+    modifier_flag_manager.push_back_active_modifier_flag(sticky_left_shift);
+    modifier_flag_manager.push_back_active_modifier_flag(left_shift_2);
+    expect(modifier_flag_manager.is_sticky_active(krbn::modifier_flag::left_shift) == true);
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::left_shift) == true);
+
+    modifier_flag_manager.erase_all_sticky_modifier_flags();
+    expect(modifier_flag_manager.is_sticky_active(krbn::modifier_flag::left_shift) == false);
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::left_shift) == true);
+
+    modifier_flag_manager.erase_all_active_modifier_flags(krbn::device_id(2));
+    expect(modifier_flag_manager.is_pressed(krbn::modifier_flag::left_shift) == false);
+    expect(krbn::modifier_flag_mask() == modifier_flag_manager.make_modifier_flags());
+  };
+
   run_scoped_modifier_flags_test();
 
   return 0;
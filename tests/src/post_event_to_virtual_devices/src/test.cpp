@@ -48,5 +48,112 @@ int main() {
     }
   };
 
+  "queue.coalesce_pointing_inputs"_test = [] {
+    namespace hid_report = pqrs::karabiner::driverkit::virtual_hid_device_driver::hid_report;
+    using krbn::manipulator::manipulators::post_event_to_virtual_devices::queue;
+
+    struct displacement final {
+      int x = 0;
+      int y = 0;
+      int vertical_wheel = 0;
+      int horizontal_wheel = 0;
+
+      bool operator==(const displacement&) const = default;
+    };
+
+    auto sum = [](const queue& q) {
+      displacement d;
+      for (const auto& e : q.get_events()) {
+        if (auto input = e.get_pointing_input()) {
+          d.x += static_cast<int8_t>(input->x);
+          d.y += static_cast<int8_t>(input->y);
+          d.vertical_wheel += static_cast<int8_t>(input->vertical_wheel);
+          d.horizontal_wheel += static_cast<int8_t>(input->horizontal_wheel);
+        }
+      }
+      return d;
+    };
+
+    auto make_report = [](int x, int y, int vertical_wheel, int horizontal_wheel, hid_report::buttons buttons = hid_report::buttons()) {
+      hid_report::pointing_input report;
+      report.buttons = buttons;
+      report.x = static_cast<uint8_t>(x);
+      report.y = static_cast<uint8_t>(y);
+      report.vertical_wheel = static_cast<uint8_t>(vertical_wheel);
+      report.horizontal_wheel = static_cast<uint8_t>(horizontal_wheel);
+      return report;
+    };
+
+    auto make_queue = [] {
+      return std::make_unique<queue>(std::make_shared<krbn::pressed_keys_manager>(),
+                                     std::make_shared<krbn::keyboard_suppression>());
+    };
+
+    // Merge all due reports.
+    {
+      auto q = make_queue();
+      for (int i = 0; i < 8; ++i) {
+        q->emplace_back_pointing_input(make_report(i % 2 == 0 ? 3 : -1, 2, 0, 0),
+                                       krbn::event_type::single,
+                                       krbn::absolute_time_point(i));
+      }
+
+      auto expected = sum(*q);
+      expect(q->coalesce_pointing_inputs(krbn::absolute_time_point(100)) == 7_ul);
+      expect(q->get_events().size() == 1_ul);
+      expect(expected == sum(*q));
+      expect(q->get_events().front().get_time_stamp() == krbn::absolute_time_point(0));
+    }
+
+    // Carry over beyond the report range.
+    {
+      auto q = make_queue();
+      for (int i = 0; i < 10; ++i) {
+        q->emplace_back_pointing_input(make_report(100, -100, 1, -1),
+                                       krbn::event_type::single,
+                                       krbn::absolute_time_point(i));
+      }
+
+      auto expected = sum(*q);
+      expect(q->coalesce_pointing_inputs(krbn::absolute_time_point(100)) == 2_ul);
+      expect(q->get_events().size() == 8_ul);
+      expect(expected == sum(*q));
+      for (const auto& e : q->get_events()) {
+        expect(std::abs(static_cast<int8_t>(e.get_pointing_input()->x)) <= 127_i);
+      }
+    }
+
+    // Runs are split at reports which are not due, have different buttons, or are not pointing_input.
+    {
+      hid_report::buttons button1;
+      button1.insert(1);
+
+      auto q = make_queue();
+      q->emplace_back_pointing_input(make_report(1, 1, 0, 0), krbn::event_type::single, krbn::absolute_time_point(0));
+      q->emplace_back_pointing_input(make_report(1, 1, 0, 0), krbn::event_type::single, krbn::absolute_time_point(0));
+      q->emplace_back_pointing_input(make_report(1, 1, 0, 0, button1), krbn::event_type::single, krbn::absolute_time_point(0));
+      q->emplace_back_pointing_input(make_report(1, 1, 0, 0, button1), krbn::event_type::single, krbn::absolute_time_point(0));
+      q->push_back_shell_command_event("open /Applications/Safari.app", krbn::absolute_time_point(0));
+      q->emplace_back_pointing_input(make_report(1, 1, 0, 0, button1), krbn::event_type::single, krbn::absolute_time_point(0));
+      q->emplace_back_pointing_input(make_report(1, 1, 0, 0, button1), krbn::event_type::single, krbn::absolute_time_point(200));
+
+      auto expected = sum(*q);
+      expect(q->coalesce_pointing_inputs(krbn::absolute_time_point(100)) == 2_ul);
+      expect(q->get_events().size() == 5_ul);
+      expect(expected == sum(*q));
+      expect(q->get_events()[2].get_shell_command() != std::nullopt);
+      expect(q->get_events()[4].get_time_stamp() == krbn::absolute_time_point(200));
+
+      // Runs after other events are merged too.
+      auto q2 = make_queue();
+      q2->push_back_shell_command_event("open /Applications/Safari.app", krbn::absolute_time_point(0));
+      q2->emplace_back_pointing_input(make_report(1, 1, 0, 0), krbn::event_type::single, krbn::absolute_time_point(0));
+      q2->emplace_back_pointing_input(make_report(1, 1, 0, 0), krbn::event_type::single, krbn::absolute_time_point(0));
+      expect(q2->coalesce_pointing_inputs(krbn::absolute_time_point(100)) == 1_ul);
+      expect(q2->get_events().size() == 2_ul);
+      expect(q2->get_events()[0].get_shell_command() != std::nullopt);
+    }
+  };
+
   return 0;
 }
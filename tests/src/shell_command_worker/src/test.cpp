@@ -0,0 +1,213 @@
+#include "dispatcher_utility.hpp"
+#include "shell_command_worker.hpp"
+#include <boost/ut.hpp>
+#include <chrono>
+#include <pqrs/thread_wait.hpp>
+#include <thread>
+
+namespace {
+std::vector<uint8_t> to_vector(const std::string& s) {
+  return std::vector<uint8_t>(std::begin(s), std::end(s));
+}
+
+std::string to_string(const std::vector<uint8_t>& v) {
+  return std::string(std::begin(v), std::end(v));
+}
+
+class test_worker final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  struct result final {
+    std::string stdout_output;
+    std::string stderr_output;
+    std::optional<int> exit_status;
+  };
+
+  test_worker() : dispatcher_client(),
+                  worker_(std::make_unique<krbn::shell_command_worker>(weak_dispatcher_)) {
+    worker_->stdout_received.connect([this](auto, auto&& buffer) {
+      result_.stdout_output += to_string(*buffer);
+    });
+
+    worker_->stderr_received.connect([this](auto, auto&& buffer) {
+      result_.stderr_output += to_string(*buffer);
+    });
+
+    worker_->command_finished.connect([this](auto, auto exit_status) {
+      result_.exit_status = exit_status;
+      if (wait_) {
+        wait_->notify();
+      }
+    });
+
+    auto wait = pqrs::make_thread_wait();
+    enqueue_to_dispatcher([this, wait] {
+      started_ = worker_->start();
+      wait->notify();
+    });
+    wait->wait_notice();
+  }
+
+  ~test_worker() override {
+    detach_from_dispatcher([this] {
+      worker_ = nullptr;
+    });
+  }
+
+  [[nodiscard]] bool get_started() const {
+    return started_;
+  }
+
+  result run(const std::string& command) {
+    auto wait = pqrs::make_thread_wait();
+
+    enqueue_to_dispatcher([this, wait, command] {
+      result_ = result();
+      wait_ = wait;
+      if (!worker_->run(++last_command_id_, command)) {
+        wait->notify();
+      }
+    });
+    wait->wait_notice();
+
+    return result_;
+  }
+
+private:
+  std::unique_ptr<krbn::shell_command_worker> worker_;
+  bool started_ = false;
+  uint64_t last_command_id_ = 0;
+  result result_;
+  std::shared_ptr<pqrs::thread_wait> wait_;
+};
+} // namespace
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+
+  "make_script"_test = [] {
+    auto script = krbn::shell_command_worker::make_script("marker", "echo 'a b'");
+    expect(script == "printf '\\n%s start\\n' 'marker'\n"
+                     "printf '\\n%s start\\n' 'marker' >&2\n"
+                     "( eval 'echo '\\''a b'\\''' ) </dev/null\n"
+                     "krbn_status=$?\n"
+                     "printf '\\n%s end %d\\n' 'marker' \"$krbn_status\"\n"
+                     "printf '\\n%s end %d\\n' 'marker' \"$krbn_status\" >&2\n");
+  };
+
+  "output_parser"_test = [] {
+    {
+      krbn::shell_command_worker::output_parser parser("marker");
+
+      auto data = to_vector("\nmarker start\nhello\n\nmarker end 3\n");
+      expect(to_string(parser.append(data.data(), data.size())) == "hello\n");
+      expect(parser.get_exit_status() == 3);
+    }
+
+    // The markers are split into several chunks.
+    {
+      krbn::shell_command_worker::output_parser parser("marker");
+
+      auto data = to_vector("\nmarker st");
+      expect(to_string(parser.append(data.data(), data.size())) == "");
+
+      data = to_vector("art\nhello\n\nmarker e");
+      expect(to_string(parser.append(data.data(), data.size())) == "hello\n");
+      expect(parser.get_exit_status() == std::nullopt);
+
+      data = to_vector("nd 0");
+      expect(to_string(parser.append(data.data(), data.size())) == "");
+      expect(parser.get_exit_status() == std::nullopt);
+
+      data = to_vector("\n");
+      expect(to_string(parser.append(data.data(), data.size())) == "");
+      expect(parser.get_exit_status() == 0);
+
+      // reset
+
+      parser.reset();
+      data = to_vector("\nmarker start\n\nmark\nworld\n\nmarker end 1\n");
+      expect(to_string(parser.append(data.data(), data.size())) == "\nmark\nworld\n");
+      expect(parser.get_exit_status() == 1);
+    }
+
+    // The output of background processes before the start marker and after the end marker is dropped.
+    {
+      krbn::shell_command_worker::output_parser parser("marker");
+
+      auto data = to_vector("\nmarker start\nhello\n\nmarker end 0\nlate1\n");
+      expect(to_string(parser.append(data.data(), data.size())) == "hello\n");
+      expect(parser.get_exit_status() == 0);
+
+      data = to_vector("late2\n");
+      expect(to_string(parser.append(data.data(), data.size())) == "");
+
+      parser.reset();
+      data = to_vector("late3\n\nmarker start\nworld\n\nmarker end 0\n");
+      expect(to_string(parser.append(data.data(), data.size())) == "world\n");
+      expect(parser.get_exit_status() == 0);
+    }
+  };
+
+  "shell_command_worker"_test = [] {
+    test_worker worker;
+    expect(worker.get_started());
+
+    {
+      auto r = worker.run("echo hello; echo world >&2");
+      expect(r.stdout_output == "hello\n");
+      expect(r.stderr_output == "world\n");
+      expect(r.exit_status == 0);
+    }
+
+    {
+      auto r = worker.run("printf \"it's\"; exit 3");
+      expect(r.stdout_output == "it's");
+      expect(r.exit_status == 3);
+    }
+
+    // `cd` and variables in a command do not affect the next command.
+    {
+      worker.run("cd /; krbn_test_variable=1");
+      auto r = worker.run("echo \"${krbn_test_variable:-unset}\"");
+      expect(r.stdout_output == "unset\n");
+    }
+
+    // Output which background processes write after the command finished is not attributed to the next command.
+    {
+      auto r = worker.run("( sleep 0.1; echo late ) &");
+      expect(r.stdout_output == "");
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+      r = worker.run("echo next");
+      expect(r.stdout_output == "next\n");
+    }
+
+    // The worker survives syntax errors.
+    {
+      auto r = worker.run("echo 'unterminated");
+      expect(r.exit_status != 0);
+
+      r = worker.run("echo ok");
+      expect(r.stdout_output == "ok\n");
+    }
+  };
+
+  "shell_command_worker.terminate"_test = [] {
+    // The worker is terminated without waiting for background processes which keep the pipes open.
+    auto worker = std::make_unique<test_worker>();
+    expect(worker->get_started());
+
+    auto r = worker->run("sleep 3 &");
+    expect(r.exit_status == 0);
+
+    auto begin = std::chrono::steady_clock::now();
+    worker = nullptr;
+    expect(std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(400));
+  };
+
+  return 0;
+}
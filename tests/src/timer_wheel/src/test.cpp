@@ -0,0 +1,145 @@
+#include "debounced_task.hpp"
+#include "dispatcher_utility.hpp"
+#include <boost/ut.hpp>
+#include <pqrs/thread_wait.hpp>
+
+namespace {
+class test_client final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  test_client() : dispatcher_client(),
+                  task1(*this),
+                  task2(*this),
+                  task3(*this) {
+  }
+
+  ~test_client() override {
+    detach_from_dispatcher();
+  }
+
+  std::function<void()> make_function(const std::string& name) {
+    return [this, name] {
+      calls.push_back(name);
+    };
+  }
+
+  krbn::debounced_task task1;
+  krbn::debounced_task task2;
+  krbn::debounced_task task3;
+
+  // `calls` is updated in the dispatcher thread.
+  std::vector<std::string> calls;
+};
+
+class time_controller final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  time_controller() : dispatcher_client(),
+                      pseudo_time_source_(std::make_shared<pqrs::dispatcher::pseudo_time_source>()) {
+    if (auto d = weak_dispatcher_.lock()) {
+      d->set_weak_time_source(pqrs::make_weak(pseudo_time_source_));
+    }
+  }
+
+  ~time_controller() override {
+    detach_from_dispatcher();
+  }
+
+  // Advance the pseudo time and wait until expired functions are called.
+  void advance(std::chrono::milliseconds ms) {
+    pseudo_time_source_->set_now(pqrs::dispatcher::time_point(ms));
+
+    // Wait the functions which are scheduled until `ms`.
+    {
+      auto wait = pqrs::make_thread_wait();
+      enqueue_to_dispatcher(
+          [wait] {
+            wait->notify();
+          },
+          pqrs::dispatcher::time_point(ms));
+      wait->wait_notice();
+    }
+
+    // Wait immediate functions which are enqueued by the above functions.
+    for (int i = 0; i < 4; ++i) {
+      auto wait = pqrs::make_thread_wait();
+      enqueue_to_dispatcher([wait] {
+        wait->notify();
+      });
+      wait->wait_notice();
+    }
+  }
+
+private:
+  pqrs::not_null_shared_ptr_t<pqrs::dispatcher::pseudo_time_source> pseudo_time_source_;
+};
+
+pqrs::dispatcher::time_point make_time_point(int ms) {
+  return pqrs::dispatcher::time_point(std::chrono::milliseconds(ms));
+}
+} // namespace
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  auto scoped_dispatcher_manager = krbn::dispatcher_utility::initialize_dispatchers();
+
+  "debounced_task"_test = [] {
+    auto controller = std::make_unique<time_controller>();
+    controller->advance(std::chrono::milliseconds(0));
+
+    auto client = std::make_unique<test_client>();
+
+    client->task1.debounce_at(client->make_function("task1"), make_time_point(100));
+    client->task2.debounce_at(client->make_function("task2"), make_time_point(50));
+    client->task3.debounce_at(client->make_function("task3"), make_time_point(200));
+
+    // Cancel and re-arm
+    client->task3.cancel();
+    client->task1.debounce_at(client->make_function("task1 re-armed"), make_time_point(150));
+
+    controller->advance(std::chrono::milliseconds(120));
+    expect(std::vector<std::string>({"task2"}) == client->calls);
+
+    controller->advance(std::chrono::milliseconds(2000));
+    expect(std::vector<std::string>({"task2", "task1 re-armed"}) == client->calls);
+
+    // A timer beyond the wheel size
+    client->task1.debounce_at(client->make_function("task1 later"), make_time_point(5000));
+
+    controller->advance(std::chrono::milliseconds(4999));
+    expect(std::vector<std::string>({"task2", "task1 re-armed"}) == client->calls);
+
+    controller->advance(std::chrono::milliseconds(5000));
+    expect(std::vector<std::string>({"task2", "task1 re-armed", "task1 later"}) == client->calls);
+
+    // The same time stamps are called in the order of schedules.
+    client->task3.debounce_at(client->make_function("task3"), make_time_point(6000));
+    client->task2.debounce_at(client->make_function("task2"), make_time_point(6000));
+
+    controller->advance(std::chrono::milliseconds(6000));
+    expect(std::vector<std::string>({"task2", "task1 re-armed", "task1 later", "task3", "task2"}) == client->calls);
+
+    // Past time stamps are called immediately.
+    client->task1.debounce_at(client->make_function("task1 past"), make_time_point(10));
+
+    controller->advance(std::chrono::milliseconds(6000));
+    expect(std::vector<std::string>({"task2", "task1 re-armed", "task1 later", "task3", "task2", "task1 past"}) == client->calls);
+
+    if (auto w = krbn::get_shared_timer_wheel().lock()) {
+      expect(w->size() == 0_ul);
+    }
+
+    // Pending timers are canceled when the client is destroyed.
+    client->task1.debounce_at(client->make_function("task1"), make_time_point(7000));
+    client = nullptr;
+
+    if (auto w = krbn::get_shared_timer_wheel().lock()) {
+      expect(w->size() == 0_ul);
+    }
+
+    controller->advance(std::chrono::milliseconds(8000));
+    controller = nullptr;
+  };
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include "types.hpp"
+#include <boost/ut.hpp>
+
+void run_multitouch_extension_variables_test() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  "multitouch_extension_variables"_test = [] {
+    krbn::multitouch_extension_variables::values_t values{};
+    values[0] = 1;
+    values[8] = 3;
+    values[13] = -1;
+    krbn::multitouch_extension_variables v1(values);
+    krbn::multitouch_extension_variables v2;
+
+    expect(v1.make_changed_mask(v1) == 0);
+    expect(v1.make_changed_mask(v2) == ((1 << 0) | (1 << 8) | (1 << 13)));
+
+    //
+    // Only the changed values are sent.
+    //
+
+    {
+      auto message = v1.make_message(v1.make_changed_mask(v2));
+      expect(message.size() == 4 + 4 * 3);
+      expect(krbn::multitouch_extension_variables::is_message(message));
+
+      auto changed_mask = v2.apply_message(message);
+      expect(changed_mask == krbn::multitouch_extension_variables::changed_mask_t((1 << 0) | (1 << 8) | (1 << 13)));
+      expect(v1 == v2);
+    }
+
+    //
+    // All values
+    //
+
+    {
+      auto message = v1.make_message(krbn::multitouch_extension_variables::all_mask);
+      expect(message.size() == 4 + 4 * 14);
+
+      krbn::multitouch_extension_variables v3;
+      expect(v3.apply_message(message) == krbn::multitouch_extension_variables::all_mask);
+      expect(v1 == v3);
+    }
+
+    //
+    // Malformed messages
+    //
+
+    {
+      auto message = v1.make_message(krbn::multitouch_extension_variables::all_mask);
+      message.pop_back();
+
+      krbn::multitouch_extension_variables v3;
+      expect(v3.apply_message(message) == std::nullopt);
+      expect(v3 == krbn::multitouch_extension_variables());
+    }
+    {
+      std::vector<uint8_t> message{krbn::multitouch_extension_variables::message_marker, 0xff, 0, 0};
+      expect(v2.apply_message(message) == std::nullopt);
+    }
+
+    //
+    // msgpack messages are not multitouch_extension_variables messages.
+    //
+
+    expect(!krbn::multitouch_extension_variables::is_message(nlohmann::json::to_msgpack(nlohmann::json{
+        {"operation_type", krbn::operation_type::set_variables},
+    })));
+
+    //
+    // to_json
+    //
+
+    {
+      auto json = nlohmann::json(v1);
+      expect(json.size() == 14);
+      expect(json["multitouch_extension_finger_count_upper_quarter_area"] == 1);
+      expect(json["multitouch_extension_finger_count_total"] == 3);
+      expect(json["multitouch_extension_palm_count_total"] == -1);
+      expect(json["multitouch_extension_palm_count_upper_half_area"] == 0);
+    }
+  };
+}
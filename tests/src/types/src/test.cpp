@@ -6,6 +6,7 @@
 #include "modifier_flag_test.hpp"
 #include "momentary_switch_event_test.hpp"
 #include "mouse_key_test.hpp"
+#include "multitouch_extension_variables_test.hpp"
 #include "notification_message_test.hpp"
 #include "operation_type_test.hpp"
 #include "pointing_motion_test.hpp"
@@ -21,6 +22,7 @@ int main() {
   run_modifier_flag_test();
   run_momentary_switch_event_test();
   run_mouse_key_test();
+  run_multitouch_extension_variables_test();
   run_notification_message_test();
   run_operation_type_test();
   run_pointing_motion_test();
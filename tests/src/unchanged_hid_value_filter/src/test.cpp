@@ -0,0 +1,288 @@
+#include "unchanged_hid_value_filter.hpp"
+#include <boost/ut.hpp>
+
+namespace {
+pqrs::osx::iokit_hid_value make_button(krbn::absolute_time_point time_stamp,
+                                       CFIndex integer_value) {
+  return pqrs::osx::iokit_hid_value(time_stamp,
+                                    integer_value,
+                                    pqrs::hid::usage_page::button,
+                                    pqrs::hid::usage::button::button_1,
+                                    1, // logical_max
+                                    0  // logical_min
+  );
+}
+
+pqrs::osx::iokit_hid_value make_stick_x(krbn::absolute_time_point time_stamp,
+                                        CFIndex integer_value) {
+  return pqrs::osx::iokit_hid_value(time_stamp,
+                                    integer_value,
+                                    pqrs::hid::usage_page::generic_desktop,
+                                    pqrs::hid::usage::generic_desktop::x,
+                                    255, // logical_max
+                                    0    // logical_min
+  );
+}
+
+pqrs::osx::iokit_hid_value make_hat_switch(krbn::absolute_time_point time_stamp,
+                                           CFIndex integer_value) {
+  return pqrs::osx::iokit_hid_value(time_stamp,
+                                    integer_value,
+                                    pqrs::hid::usage_page::generic_desktop,
+                                    pqrs::hid::usage::generic_desktop::hat_switch,
+                                    7, // logical_max
+                                    0  // logical_min
+  );
+}
+
+pqrs::osx::iokit_hid_value make_pointing_x(krbn::absolute_time_point time_stamp,
+                                           CFIndex integer_value) {
+  return pqrs::osx::iokit_hid_value(time_stamp,
+                                    integer_value,
+                                    pqrs::hid::usage_page::generic_desktop,
+                                    pqrs::hid::usage::generic_desktop::x,
+                                    127, // logical_max
+                                    -127 // logical_min
+  );
+}
+} // namespace
+
+int main() {
+  using namespace boost::ut;
+  using namespace boost::ut::literals;
+
+  "disabled"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_button(now, 1),
+        make_button(now, 1),
+    };
+
+    expect(!filter.active());
+    expect(!filter.filter(hid_values));
+    expect(hid_values.size() == 2_ul);
+    expect(filter.get_passed_count() == 2_ul);
+    expect(filter.get_dropped_count() == 0_ul);
+  };
+
+  "drop_unchanged_values"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    filter.set_parameters({.enabled = true});
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_button(now, 1),
+        make_stick_x(now, 128),
+        make_button(now, 1),
+        make_stick_x(now, 128),
+        make_button(now, 0),
+        make_stick_x(now, 129),
+    };
+
+    filter.filter(hid_values);
+
+    expect(hid_values == std::vector<pqrs::osx::iokit_hid_value>{
+                             make_button(now, 1),
+                             make_stick_x(now, 128),
+                             make_button(now, 0),
+                             make_stick_x(now, 129),
+                         });
+    expect(filter.get_passed_count() == 4_ul);
+    expect(filter.get_dropped_count() == 2_ul);
+
+    // The last values are kept across calls.
+
+    hid_values = {
+        make_button(now, 0),
+        make_stick_x(now, 129),
+    };
+    filter.filter(hid_values);
+    expect(hid_values.empty());
+    expect(filter.get_dropped_count() == 4_ul);
+
+    // reset
+
+    filter.reset();
+    hid_values = {
+        make_button(now, 0),
+        make_stick_x(now, 129),
+    };
+    filter.filter(hid_values);
+    expect(hid_values.size() == 2_ul);
+  };
+
+  "dead_band"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    filter.set_parameters({
+        .enabled = true,
+        .dead_band = 2,
+    });
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_stick_x(now, 128),
+        make_stick_x(now, 130),
+        make_stick_x(now, 126),
+        make_stick_x(now, 131),
+        make_stick_x(now, 129),
+        // The dead band is not applied to buttons.
+        make_button(now, 0),
+        make_button(now, 1),
+    };
+
+    filter.filter(hid_values);
+
+    expect(hid_values == std::vector<pqrs::osx::iokit_hid_value>{
+                             make_stick_x(now, 128),
+                             make_stick_x(now, 131),
+                             make_button(now, 0),
+                             make_button(now, 1),
+                         });
+  };
+
+  "dead_band is not applied to hat switches"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    filter.set_parameters({
+        .enabled = true,
+        .dead_band = 2,
+    });
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_hat_switch(now, 0), // north
+        make_hat_switch(now, 1), // north-east
+        make_hat_switch(now, 1),
+        make_hat_switch(now, 2), // east
+        make_hat_switch(now, 0),
+    };
+
+    filter.filter(hid_values);
+
+    expect(hid_values == std::vector<pqrs::osx::iokit_hid_value>{
+                             make_hat_switch(now, 0),
+                             make_hat_switch(now, 1),
+                             make_hat_switch(now, 2),
+                             make_hat_switch(now, 0),
+                         });
+  };
+
+  "relative_values"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    filter.set_parameters({.enabled = true});
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_pointing_x(now, 1),
+        make_pointing_x(now, 1),
+        make_pointing_x(now, 1),
+        // Values without the logical range are also passed.
+        pqrs::osx::iokit_hid_value(now,
+                                   1,
+                                   pqrs::hid::usage_page::button,
+                                   pqrs::hid::usage::button::button_1,
+                                   std::nullopt, // logical_max
+                                   std::nullopt  // logical_min
+                                   ),
+        pqrs::osx::iokit_hid_value(now,
+                                   1,
+                                   pqrs::hid::usage_page::button,
+                                   pqrs::hid::usage::button::button_1,
+                                   std::nullopt, // logical_max
+                                   std::nullopt  // logical_min
+                                   ),
+    };
+
+    filter.filter(hid_values);
+
+    expect(hid_values.size() == 5_ul);
+    expect(filter.get_dropped_count() == 0_ul);
+  };
+
+  "periodic_report"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    filter.set_parameters({.enabled = true});
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_button(now, 1),
+        make_button(now, 1),
+        make_button(now, 1),
+    };
+    filter.filter(hid_values);
+    expect(filter.take_periodic_report() == std::nullopt);
+
+    // The report is made after the interval.
+
+    now += pqrs::osx::chrono::make_absolute_time_duration(std::chrono::seconds(61));
+    hid_values = {
+        make_button(now, 0),
+    };
+    filter.filter(hid_values);
+    expect(filter.take_periodic_report() == krbn::unchanged_hid_value_filter::counts{
+                                                .passed = 2,
+                                                .dropped = 2,
+                                            });
+    expect(filter.take_periodic_report() == std::nullopt);
+
+    // No report is made if no value is dropped in the interval.
+
+    now += pqrs::osx::chrono::make_absolute_time_duration(std::chrono::seconds(61));
+    hid_values = {
+        make_button(now, 1),
+    };
+    filter.filter(hid_values);
+    expect(filter.take_periodic_report() == std::nullopt);
+
+    // The total counts are kept.
+
+    expect(filter.get_passed_count() == 3_ul);
+    expect(filter.get_dropped_count() == 2_ul);
+  };
+
+  "auto_enable"_test = [] {
+    krbn::unchanged_hid_value_filter filter;
+    filter.set_parameters({.auto_enable_values_per_second = 4});
+    auto now = krbn::absolute_time_point(100);
+
+    std::vector<pqrs::osx::iokit_hid_value> hid_values{
+        make_button(now, 1),
+        make_button(now, 1),
+        make_button(now, 1),
+    };
+    expect(!filter.filter(hid_values));
+    expect(!filter.active());
+    expect(hid_values.size() == 3_ul);
+
+    // The counter is reset in the next window.
+
+    now += pqrs::osx::chrono::make_absolute_time_duration(std::chrono::seconds(2));
+    hid_values = {
+        make_button(now, 1),
+        make_button(now, 1),
+        make_button(now, 1),
+    };
+    expect(!filter.filter(hid_values));
+    expect(!filter.active());
+
+    // Exceed the limit in the same window.
+
+    now += pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(100));
+    hid_values = {
+        make_button(now, 1),
+        make_button(now, 1),
+    };
+    expect(filter.filter(hid_values));
+    expect(filter.active());
+    expect(filter.get_auto_enabled());
+    expect(hid_values.size() == 1_ul);
+
+    // Changing parameters disables the auto enabled filter.
+
+    filter.set_parameters({.auto_enable_values_per_second = 0});
+    expect(!filter.active());
+  };
+
+  return 0;
+}